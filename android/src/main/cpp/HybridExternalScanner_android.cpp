@@ -1,14 +1,27 @@
 #include "HybridExternalScanner_android.hpp"
+#include "ScannerLog.hpp"
 #include <android/log.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 
 #define LOG_TAG "ExternalScanner"
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_DEBUG
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#else
+#define LOGD(...) do {} while (0)
+#endif
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_ERROR
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#else
+#define LOGE(...) do {} while (0)
+#endif
 
 namespace margelo::nitro::externalscanner {
 
 std::shared_ptr<HybridExternalScannerAndroid> HybridExternalScannerAndroid::_instance = nullptr;
 std::mutex HybridExternalScannerAndroid::_instanceMutex;
+std::atomic<HybridExternalScannerAndroid*> HybridExternalScannerAndroid::_instancePtr{nullptr};
 
 JavaVM* HybridExternalScannerAndroid::_jvm = nullptr;
 jclass HybridExternalScannerAndroid::_scannerUtilClass = nullptr;
@@ -16,6 +29,7 @@ jmethodID HybridExternalScannerAndroid::_hasExternalScannerMethod = nullptr;
 jmethodID HybridExternalScannerAndroid::_getConnectedDevicesMethod = nullptr;
 jmethodID HybridExternalScannerAndroid::_startInterceptingMethod = nullptr;
 jmethodID HybridExternalScannerAndroid::_stopInterceptingMethod = nullptr;
+jmethodID HybridExternalScannerAndroid::_reclassifyDevicesMethod = nullptr;
 
 HybridExternalScannerAndroid::HybridExternalScannerAndroid()
     : HybridObject(TAG), HybridExternalScanner() {
@@ -31,10 +45,16 @@ std::shared_ptr<HybridExternalScannerAndroid> HybridExternalScannerAndroid::getI
     std::lock_guard<std::mutex> lock(_instanceMutex);
     if (!_instance) {
         _instance = std::make_shared<HybridExternalScannerAndroid>();
+        _instancePtr.store(_instance.get(), std::memory_order_release);
     }
     return _instance;
 }
 
+HybridExternalScannerAndroid* HybridExternalScannerAndroid::peekInstance() {
+    // The singleton is never released, so the raw pointer stays valid
+    return _instancePtr.load(std::memory_order_acquire);
+}
+
 void HybridExternalScannerAndroid::initJNI(JNIEnv* env) {
     if (_scannerUtilClass != nullptr) {
         return; // Already initialized
@@ -53,6 +73,7 @@ void HybridExternalScannerAndroid::initJNI(JNIEnv* env) {
     _getConnectedDevicesMethod = env->GetStaticMethodID(_scannerUtilClass, "getConnectedDevicesJson", "()Ljava/lang/String;");
     _startInterceptingMethod = env->GetStaticMethodID(_scannerUtilClass, "startIntercepting", "()V");
     _stopInterceptingMethod = env->GetStaticMethodID(_scannerUtilClass, "stopIntercepting", "()V");
+    _reclassifyDevicesMethod = env->GetStaticMethodID(_scannerUtilClass, "reclassifyDevices", "()V");
 
     if (!_hasExternalScannerMethod || !_getConnectedDevicesMethod) {
         LOGE("Failed to find JNI methods");
@@ -87,6 +108,12 @@ JNIEnv* HybridExternalScannerAndroid::getJNIEnv() {
 }
 
 bool HybridExternalScannerAndroid::hasExternalScanner() {
+    // ExternalScannerUtil keeps the registry in sync from its device
+    // listener, so once it published a list the cached flag is current
+    if (_devices.generation() != 0) {
+        return HybridExternalScanner::hasExternalScanner();
+    }
+
     JNIEnv* env = getJNIEnv();
     if (env == nullptr || _scannerUtilClass == nullptr || _hasExternalScannerMethod == nullptr) {
         // Fallback to base class
@@ -98,7 +125,7 @@ bool HybridExternalScannerAndroid::hasExternalScanner() {
 }
 
 std::vector<DeviceInfo> HybridExternalScannerAndroid::getConnectedDevices() {
-    // Return cached devices (updated via JNI callbacks)
+    // Return the registry snapshot (updated via JNI callbacks)
     return HybridExternalScanner::getConnectedDevices();
 }
 
@@ -133,15 +160,106 @@ void HybridExternalScannerAndroid::stopScanning() {
     LOGD("Stopped scanning");
 }
 
+bool HybridExternalScannerAndroid::setDeviceRules(const std::vector<DeviceRule>& rules) {
+    if (!HybridExternalScanner::setDeviceRules(rules)) {
+        return false;
+    }
+    // Scanning keeps running: Kotlin swaps its verdict cache and re-publishes the device list
+    JNIEnv* env = getJNIEnv();
+    if (env != nullptr && _scannerUtilClass != nullptr && _reclassifyDevicesMethod != nullptr) {
+        env->CallStaticVoidMethod(_scannerUtilClass, _reclassifyDevicesMethod);
+    } else {
+        LOGE("Failed to call reclassifyDevices");
+    }
+    return true;
+}
+
+// Encode one code point as UTF-8 (up to 4 bytes); returns the byte count,
+// 0 for no character, a surrogate half or an out-of-range value
+static size_t encodeCodePoint(jint c, char* out) {
+    if (c <= 0 || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        return 0;
+    }
+    return Keymap::encodeUtf8(static_cast<char32_t>(c), out);
+}
+
+// Encode UTF-16 units as UTF-8, combining surrogate pairs and dropping
+// unpaired halves; stops before a character that does not fit capacity
+static size_t encodeUtf16(const jchar* units, jsize count, char* out, size_t capacity) {
+    size_t length = 0;
+    for (jsize i = 0; i < count; i++) {
+        jint c = units[i];
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < count && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (units[++i] - 0xDC00);
+        }
+        char encoded[4];
+        const size_t size = encodeCodePoint(c, encoded);
+        if (length + size > capacity) {
+            break;
+        }
+        std::memcpy(out + length, encoded, size);
+        length += size;
+    }
+    return length;
+}
+
 // Static JNI callback methods
 void HybridExternalScannerAndroid::onKeyEventFromJava(JNIEnv* env, int keyCode, int action, jstring characters, int deviceId) {
-    auto instance = getInstance();
+    auto instance = peekInstance();
     if (instance && instance->isScanning()) {
-        const char* chars = env->GetStringUTFChars(characters, nullptr);
-        std::string charStr(chars);
-        env->ReleaseStringUTFChars(characters, chars);
+        // Copy the UTF-16 units onto the stack rather than through
+        // GetStringUTFChars, which allocates a UTF-8 copy per key
+        jchar units[KeyEvent::kMaxChars];
+        char chars[KeyEvent::kMaxChars];
+        size_t length = 0;
+        if (characters != nullptr) {
+            const jsize count = std::min<jsize>(env->GetStringLength(characters), KeyEvent::kMaxChars);
+            env->GetStringRegion(characters, 0, count, units);
+            length = encodeUtf16(units, count, chars, sizeof(chars));
+        }
+        instance->onKeyEvent(keyCode, action, std::string_view(chars, length), deviceId);
+    }
+}
 
-        instance->onKeyEvent(keyCode, action, charStr, deviceId);
+void HybridExternalScannerAndroid::onKeyEventsFromJava(JNIEnv* env, jintArray keyCodes, jintArray actions, jintArray codePoints,
+                                                       jlongArray eventTimes, int deviceId, int count) {
+    auto instance = peekInstance();
+    if (instance == nullptr || !instance->isScanning() || count <= 0) {
+        return;
+    }
+
+    // Copy the batch out in fixed-size chunks on the stack: no per-key
+    // allocation and no JNI calls while the scanner consumes the events
+    constexpr jsize kChunk = 64;
+    jint keyCodeChunk[kChunk];
+    jint actionChunk[kChunk];
+    jint codePointChunk[kChunk];
+    jlong timeChunk[kChunk];
+    KeyEvent events[kChunk];
+
+    for (jsize offset = 0; offset < count; offset += kChunk) {
+        jsize n = std::min<jsize>(kChunk, count - offset);
+        env->GetIntArrayRegion(keyCodes, offset, n, keyCodeChunk);
+        env->GetIntArrayRegion(actions, offset, n, actionChunk);
+        env->GetIntArrayRegion(codePoints, offset, n, codePointChunk);
+        env->GetLongArrayRegion(eventTimes, offset, n, timeChunk);
+        if (env->ExceptionCheck()) {
+            LOGE("onKeyEventsFromJava: batch arrays shorter than count=%d", count);
+            env->ExceptionClear();
+            return;
+        }
+
+        for (jsize i = 0; i < n; i++) {
+            KeyEvent& event = events[i];
+            // KeyEvent.getEventTime() is SystemClock.uptimeMillis(), i.e. CLOCK_MONOTONIC
+            event.time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::milliseconds(timeChunk[i])).count();
+            event.keyCode = keyCodeChunk[i];
+            event.deviceId = deviceId;
+            event.action = static_cast<uint8_t>(actionChunk[i]);
+            event.charCount = static_cast<uint8_t>(encodeCodePoint(codePointChunk[i], event.chars));
+        }
+        instance->onKeyEvents(events, static_cast<size_t>(n));
     }
 }
 
@@ -168,14 +286,12 @@ void HybridExternalScannerAndroid::setDevicesFromJava(JNIEnv* env, jobjectArray
     auto instance = getInstance();
     if (!instance) return;
 
-    // Clear existing devices
-    {
-        std::lock_guard<std::mutex> lock(instance->_devicesMutex);
-        instance->_connectedDevices.clear();
-    }
+    // The list is built up here and published as one snapshot
+    std::vector<DeviceInfo> connected;
 
     if (devices == nullptr) {
         LOGD("setDevicesFromJava: devices array is null");
+        instance->_devices.replace(std::move(connected));
         return;
     }
 
@@ -184,6 +300,7 @@ void HybridExternalScannerAndroid::setDevicesFromJava(JNIEnv* env, jobjectArray
     LOGD("setDevicesFromJava: processing %d devices", length);
 
     if (length == 0) {
+        instance->_devices.replace(std::move(connected));
         return;
     }
 
@@ -260,16 +377,41 @@ void HybridExternalScannerAndroid::setDevicesFromJava(JNIEnv* env, jobjectArray
         DeviceInfo device(static_cast<double>(id), nameStr, static_cast<double>(vendorId), static_cast<double>(productId), isExternal);
         LOGD("setDevicesFromJava: added device id=%d name=%s", id, nameStr.c_str());
 
-        {
-            std::lock_guard<std::mutex> lock(instance->_devicesMutex);
-            instance->_connectedDevices.push_back(device);
-        }
+        connected.push_back(device);
 
         env->DeleteLocalRef(deviceObj);
     }
 
     env->DeleteLocalRef(deviceClass);
-    LOGD("setDevicesFromJava: done, total devices=%zu", instance->_connectedDevices.size());
+    LOGD("setDevicesFromJava: done, total devices=%zu", connected.size());
+    instance->_devices.replace(std::move(connected));
+}
+
+bool HybridExternalScannerAndroid::classifyDeviceFromJava(JNIEnv* env, int id, jstring name, int vendorId, int productId,
+                                                          bool isVirtual, bool hasKeyboard) {
+    auto instance = getInstance();
+    if (!instance) return false;
+
+    // Once per device add/change, so the UTF-8 copy is fine here
+    const char* nameChars = name != nullptr ? env->GetStringUTFChars(name, nullptr) : nullptr;
+    InputDeviceDescriptor device;
+    device.name = nameChars != nullptr ? std::string_view(nameChars) : std::string_view();
+    device.vendorId = vendorId;
+    device.productId = productId;
+    device.isVirtual = isVirtual;
+    device.hasKeyboard = hasKeyboard;
+    const bool isScanner = instance->classifyDevice(id, device);
+    if (nameChars != nullptr) {
+        env->ReleaseStringUTFChars(name, nameChars);
+    }
+    return isScanner;
+}
+
+void HybridExternalScannerAndroid::forgetDeviceFromJava(JNIEnv* env, int id) {
+    auto instance = getInstance();
+    if (instance) {
+        instance->forgetDeviceClassification(id);
+    }
 }
 
 } // namespace margelo::nitro::externalscanner
@@ -283,6 +425,13 @@ JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI
         env, keyCode, action, characters, deviceId);
 }
 
+JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeOnKeyEvents(
+    JNIEnv* env, jclass clazz, jintArray keyCodes, jintArray actions, jintArray codePoints,
+    jlongArray eventTimes, jint deviceId, jint count) {
+    margelo::nitro::externalscanner::HybridExternalScannerAndroid::onKeyEventsFromJava(
+        env, keyCodes, actions, codePoints, eventTimes, deviceId, count);
+}
+
 JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeOnDeviceConnected(
     JNIEnv* env, jclass clazz, jint id, jstring name, jint vendorId, jint productId, jboolean isExternal) {
     margelo::nitro::externalscanner::HybridExternalScannerAndroid::onDeviceConnectedFromJava(
@@ -299,4 +448,16 @@ JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI
     margelo::nitro::externalscanner::HybridExternalScannerAndroid::setDevicesFromJava(env, devices);
 }
 
+JNIEXPORT jboolean JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeClassifyDevice(
+    JNIEnv* env, jclass clazz, jint id, jstring name, jint vendorId, jint productId, jboolean isVirtual,
+    jboolean hasKeyboard) {
+    return margelo::nitro::externalscanner::HybridExternalScannerAndroid::classifyDeviceFromJava(
+        env, id, name, vendorId, productId, isVirtual, hasKeyboard) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeForgetDevice(
+    JNIEnv* env, jclass clazz, jint id) {
+    margelo::nitro::externalscanner::HybridExternalScannerAndroid::forgetDeviceFromJava(env, id);
+}
+
 }
@@ -18,15 +18,24 @@ public:
         const std::optional<std::function<void(const std::string&, double)>>& onChar
     ) override;
     void stopScanning() override;
+    // Re-classifies the connected devices on the Kotlin side as well
+    bool setDeviceRules(const std::vector<DeviceRule>& rules) override;
 
     // JNI methods called from Java/Kotlin
     static void onKeyEventFromJava(JNIEnv* env, int keyCode, int action, jstring characters, int deviceId);
+    static void onKeyEventsFromJava(JNIEnv* env, jintArray keyCodes, jintArray actions, jintArray codePoints,
+                                    jlongArray eventTimes, int deviceId, int count);
     static void onDeviceConnectedFromJava(JNIEnv* env, int id, jstring name, int vendorId, int productId, bool isExternal);
     static void onDeviceDisconnectedFromJava(JNIEnv* env, int deviceId);
     static void setDevicesFromJava(JNIEnv* env, jobjectArray devices);
+    static bool classifyDeviceFromJava(JNIEnv* env, int id, jstring name, int vendorId, int productId,
+                                       bool isVirtual, bool hasKeyboard);
+    static void forgetDeviceFromJava(JNIEnv* env, int id);
 
     // Get the singleton instance
     static std::shared_ptr<HybridExternalScannerAndroid> getInstance();
+    // Lock-free access for the key path; null until getInstance() ran once
+    static HybridExternalScannerAndroid* peekInstance();
 
     // JVM reference - needs to be public for cpp-adapter to set it
     static JavaVM* _jvm;
@@ -34,6 +43,7 @@ public:
 private:
     static std::shared_ptr<HybridExternalScannerAndroid> _instance;
     static std::mutex _instanceMutex;
+    static std::atomic<HybridExternalScannerAndroid*> _instancePtr;
 
     // Cache JNI references
     static jclass _scannerUtilClass;
@@ -41,6 +51,7 @@ private:
     static jmethodID _getConnectedDevicesMethod;
     static jmethodID _startInterceptingMethod;
     static jmethodID _stopInterceptingMethod;
+    static jmethodID _reclassifyDevicesMethod;
 
     void initJNI(JNIEnv* env);
     JNIEnv* getJNIEnv();
@@ -53,6 +64,10 @@ extern "C" {
     JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeOnKeyEvent(
         JNIEnv* env, jclass clazz, jint keyCode, jint action, jstring characters, jint deviceId);
 
+    JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeOnKeyEvents(
+        JNIEnv* env, jclass clazz, jintArray keyCodes, jintArray actions, jintArray codePoints,
+        jlongArray eventTimes, jint deviceId, jint count);
+
     JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeOnDeviceConnected(
         JNIEnv* env, jclass clazz, jint id, jstring name, jint vendorId, jint productId, jboolean isExternal);
 
@@ -61,4 +76,11 @@ extern "C" {
 
     JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeSetDevices(
         JNIEnv* env, jclass clazz, jobjectArray devices);
+
+    JNIEXPORT jboolean JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeClassifyDevice(
+        JNIEnv* env, jclass clazz, jint id, jstring name, jint vendorId, jint productId, jboolean isVirtual,
+        jboolean hasKeyboard);
+
+    JNIEXPORT void JNICALL Java_com_margelo_nitro_externalscanner_ExternalScannerJNI_nativeForgetDevice(
+        JNIEnv* env, jclass clazz, jint id);
 }
@@ -14,6 +14,16 @@ object ExternalScannerJNI {
     @JvmStatic
     external fun nativeOnKeyEvent(keyCode: Int, action: Int, characters: String, deviceId: Int)
 
+    @JvmStatic
+    external fun nativeOnKeyEvents(
+        keyCodes: IntArray,
+        actions: IntArray,
+        codePoints: IntArray,
+        eventTimes: LongArray,
+        deviceId: Int,
+        count: Int
+    )
+
     @JvmStatic
     external fun nativeOnDeviceConnected(id: Int, name: String, vendorId: Int, productId: Int, isExternal: Boolean)
 
@@ -23,6 +33,19 @@ object ExternalScannerJNI {
     @JvmStatic
     external fun nativeSetDevices(devices: Array<DeviceInfoJava>)
 
+    @JvmStatic
+    external fun nativeClassifyDevice(
+        id: Int,
+        name: String,
+        vendorId: Int,
+        productId: Int,
+        isVirtual: Boolean,
+        hasKeyboard: Boolean
+    ): Boolean
+
+    @JvmStatic
+    external fun nativeForgetDevice(id: Int)
+
     // Helper to send key events to native
     fun sendKeyEvent(keyCode: Int, action: Int, characters: String, deviceId: Int) {
         nativeOnKeyEvent(keyCode, action, characters, deviceId)
@@ -42,6 +65,16 @@ object ExternalScannerJNI {
     fun syncDevices(devices: List<DeviceInfoJava>) {
         nativeSetDevices(devices.toTypedArray())
     }
+
+    // Helper to run the native scanner classifier (caches the verdict natively)
+    fun classifyDevice(id: Int, name: String, vendorId: Int, productId: Int, isVirtual: Boolean, hasKeyboard: Boolean): Boolean {
+        return nativeClassifyDevice(id, name, vendorId, productId, isVirtual, hasKeyboard)
+    }
+
+    // Helper to drop a removed device's classification
+    fun forgetDevice(id: Int) {
+        nativeForgetDevice(id)
+    }
 }
 
 /**
@@ -3,6 +3,7 @@ package com.margelo.nitro.externalscanner
 import android.content.Context
 import android.hardware.input.InputManager
 import android.util.Log
+import android.util.SparseBooleanArray
 import android.view.InputDevice
 import android.view.KeyCharacterMap
 import android.view.KeyEvent
@@ -14,10 +15,17 @@ object ExternalScannerUtil {
     private const val TAG = "ExternalScanner"
 
     private var inputManager: InputManager? = null
+    // Set from the JS thread, read on the UI thread
+    @Volatile
     private var isIntercepting = false
     private var deviceListener: InputManager.InputDeviceListener? = null
     private var isInitialized = false
 
+    // Scanner verdicts by device id, replaced copy-on-write so the key path
+    // reads it without locking
+    @Volatile
+    private var scannerDevices = SparseBooleanArray()
+
     /**
      * Initialize the utility with application context
      */
@@ -142,6 +150,7 @@ object ExternalScannerUtil {
     fun stopIntercepting() {
         Log.d(TAG, "stopIntercepting() called")
         isIntercepting = false
+        KeyEventBatch.clear()
     }
 
     /**
@@ -163,32 +172,36 @@ object ExternalScannerUtil {
         // Check if this is from an external scanner device
         if (!isExternalScanner(deviceId)) return false
 
-        // Log for debugging
-        Log.d(TAG, "processKeyEvent: keyCode=${event.keyCode}, action=${event.action}, " +
-                "deviceId=$deviceId, isIntercepting=$isIntercepting")
+        // Per-key logging is debug-only; logcat I/O costs more than the scan itself
+        if (BuildConfig.DEBUG) {
+            Log.d(TAG, "processKeyEvent: keyCode=${event.keyCode}, action=${event.action}, " +
+                    "deviceId=$deviceId, isIntercepting=$isIntercepting")
+        }
 
         // If not intercepting, still check but don't consume
         // This allows the event to pass through when scanning is not active
         if (!isIntercepting) {
-            Log.d(TAG, "Not intercepting - call startScanning() first")
+            if (BuildConfig.DEBUG) Log.d(TAG, "Not intercepting - call startScanning() first")
             return false
         }
 
-        // Get the character for this key event
+        // Android's character is kept unless a layout was set (see
+        // setKeyboardLayout); then the native keymap translates the keycode,
+        // tracking the modifiers from key-down/up, and the character is only
+        // used for keys it has no entry for.
+        // It is passed as a code point (0 = none, as for dead keys), so
+        // characters outside the BMP are not cut to one surrogate half.
         val unicodeChar = event.unicodeChar
-        val characters = if (unicodeChar != 0 && unicodeChar != KeyCharacterMap.COMBINING_ACCENT) {
-            unicodeChar.toChar().toString()
-        } else {
-            ""
-        }
+        val codePoint = if ((unicodeChar and KeyCharacterMap.COMBINING_ACCENT) == 0) unicodeChar else 0
 
-        Log.d(TAG, "Sending to native: char='$characters', keyCode=${event.keyCode}")
+        if (BuildConfig.DEBUG) Log.d(TAG, "Buffering for native: codePoint=$codePoint, keyCode=${event.keyCode}")
 
-        // Send to native
-        ExternalScannerJNI.sendKeyEvent(
+        // Buffer and send to native once per burst
+        KeyEventBatch.add(
             keyCode = event.keyCode,
             action = event.action,
-            characters = characters,
+            codePoint = codePoint,
+            eventTime = event.eventTime,
             deviceId = deviceId
         )
 
@@ -198,83 +211,71 @@ object ExternalScannerUtil {
 
     /**
      * Check if a device ID corresponds to an external scanner
+     * Called per key, so it only looks up the cached verdict; devices are
+     * classified natively when they are added or change
      */
     @JvmStatic
     fun isExternalScanner(deviceId: Int): Boolean {
+        val cached = scannerDevices
+        val index = cached.indexOfKey(deviceId)
+        if (index >= 0) return cached.valueAt(index)
+        // Not seen by the device listener yet (e.g. present before init)
         val device = InputDevice.getDevice(deviceId) ?: return false
-        return isExternalScannerDevice(device)
+        return classifyDevice(device)
     }
 
     /**
-     * Check if an InputDevice is an external scanner
-     * Note: Most barcode scanners appear as USB HID keyboards
+     * Classify a device with the native name-pattern matcher and cache the verdict
      */
-    private fun isExternalScannerDevice(device: InputDevice): Boolean {
-        // Virtual devices are not external scanners
-        if (device.isVirtual) return false
-
-        val nameLower = device.name.lowercase()
-
-        // Exclude known internal/system devices
-        val isInternalDevice = nameLower.contains("mtk-") ||      // MediaTek internal
-                nameLower.contains("pmic") ||                      // Power management
-                nameLower.contains("_ts") ||                       // Touchscreen
-                nameLower.contains("touchscreen") ||
-                nameLower.contains("touch screen") ||
-                nameLower.contains("headset") ||                   // Audio jack
-                nameLower.contains("headphone") ||
-                nameLower.contains("gpio") ||                      // GPIO keys
-                nameLower.contains("power") ||                     // Power button
-                nameLower.contains("volume") ||                    // Volume buttons
-                nameLower.contains("fingerprint") ||               // Fingerprint sensor
-                nameLower.contains("accelerometer") ||             // Sensors
-                nameLower.contains("gyroscope") ||
-                nameLower.contains("compass") ||
-                nameLower.contains("proximity") ||
-                nameLower.contains("light sensor") ||
-                nameLower.startsWith("gpio-") ||
-                nameLower.startsWith("kpd") ||                     // Keypad (internal)
-                nameLower.endsWith("-kpd") ||
-                nameLower.contains(",pen")                         // Stylus pen
-
-        if (isInternalDevice) {
-            return false
+    private fun classifyDevice(device: InputDevice): Boolean {
+        val hasKeyboard = (device.sources and InputDevice.SOURCE_KEYBOARD) == InputDevice.SOURCE_KEYBOARD
+        val isScanner = ExternalScannerJNI.classifyDevice(
+            device.id, device.name, device.vendorId, device.productId, device.isVirtual, hasKeyboard
+        )
+        synchronized(this) {
+            val updated = scannerDevices.clone()
+            updated.put(device.id, isScanner)
+            scannerDevices = updated
         }
+        return isScanner
+    }
 
-        // Must have keyboard source for scanner input
-        val sources = device.sources
-        val hasKeyboard = (sources and InputDevice.SOURCE_KEYBOARD) == InputDevice.SOURCE_KEYBOARD
-
-        if (!hasKeyboard) return false
-
-        // Check device name for common scanner/RFID identifiers
-        val isLikelyScanner = nameLower.contains("scanner") ||
-                nameLower.contains("barcode") ||
-                nameLower.contains("reader") ||
-                nameLower.contains("rfid") ||
-                nameLower.contains("symbol") ||
-                nameLower.contains("honeywell") ||
-                nameLower.contains("zebra") ||
-                nameLower.contains("datalogic") ||
-                nameLower.contains("newland") ||
-                nameLower.contains("opticon") ||
-                nameLower.contains("motorola") ||
-                nameLower.contains("intermec") ||
-                nameLower.contains("denso") ||
-                nameLower.contains("keyence")
-
-        // If it looks like a scanner, accept it
-        if (isLikelyScanner) {
-            return true
+    private fun forgetDevice(deviceId: Int) {
+        ExternalScannerJNI.forgetDevice(deviceId)
+        synchronized(this) {
+            val updated = scannerDevices.clone()
+            updated.delete(deviceId)
+            scannerDevices = updated
         }
+    }
 
-        // For other keyboard devices, require USB vendor/product IDs
-        // This filters out built-in keyboards that don't have USB IDs
-        val hasUsbIds = device.vendorId > 0 && device.productId > 0
-
-        return hasUsbIds
+    /**
+     * Re-classify every connected device after the native rule table changed
+     * The verdict cache is swapped in one step, so interception keeps running
+     */
+    @JvmStatic
+    fun reclassifyDevices() {
+        val deviceIds = inputManager?.inputDeviceIds ?: InputDevice.getDeviceIds()
+        val updated = SparseBooleanArray(deviceIds.size)
+        for (deviceId in deviceIds) {
+            val device = InputDevice.getDevice(deviceId) ?: continue
+            val hasKeyboard = (device.sources and InputDevice.SOURCE_KEYBOARD) == InputDevice.SOURCE_KEYBOARD
+            updated.put(deviceId, ExternalScannerJNI.classifyDevice(
+                device.id, device.name, device.vendorId, device.productId, device.isVirtual, hasKeyboard
+            ))
+        }
+        synchronized(this) {
+            scannerDevices = updated
+        }
+        Log.d(TAG, "reclassifyDevices: ${deviceIds.size} devices")
+        syncDevices()
     }
 
+    /**
+     * Check if an InputDevice is an external scanner (uses the cached verdict)
+     */
+    private fun isExternalScannerDevice(device: InputDevice): Boolean = isExternalScanner(device.id)
+
     /**
      * Setup device connection listener
      */
@@ -284,7 +285,7 @@ object ExternalScannerUtil {
         deviceListener = object : InputManager.InputDeviceListener {
             override fun onInputDeviceAdded(deviceId: Int) {
                 val device = InputDevice.getDevice(deviceId) ?: return
-                if (isExternalScannerDevice(device)) {
+                if (classifyDevice(device)) {
                     ExternalScannerJNI.notifyDeviceConnected(
                         DeviceInfoJava(
                             id = device.id,
@@ -298,11 +299,13 @@ object ExternalScannerUtil {
             }
 
             override fun onInputDeviceRemoved(deviceId: Int) {
+                forgetDevice(deviceId)
                 ExternalScannerJNI.notifyDeviceDisconnected(deviceId)
             }
 
             override fun onInputDeviceChanged(deviceId: Int) {
-                // Re-sync on changes
+                // Re-classify and re-sync on changes
+                InputDevice.getDevice(deviceId)?.let { classifyDevice(it) }
                 syncDevices()
             }
         }
@@ -0,0 +1,90 @@
+package com.margelo.nitro.externalscanner
+
+import android.os.Handler
+import android.os.Looper
+import android.view.KeyEvent
+
+/**
+ * Reusable primitive-array buffer for scanner key events.
+ * Filled on the UI thread from dispatchKeyEvent() and handed to native
+ * once per burst, instead of one JNI call (and one String) per key.
+ * All state belongs to the UI thread; clear() may be called from any thread.
+ */
+internal object KeyEventBatch {
+    private const val CAPACITY = 256
+
+    // Upper bound for holding a partial burst. Events carry their own
+    // eventTime, so native timeout handling is not affected by the delay.
+    private const val FLUSH_DELAY_MS = 16L
+
+    private val keyCodes = IntArray(CAPACITY)
+    private val actions = IntArray(CAPACITY)
+    // Full code points, so characters outside the BMP survive the batch
+    private val codePoints = IntArray(CAPACITY)
+    private val eventTimes = LongArray(CAPACITY)
+    private var deviceId = -1
+    private var count = 0
+
+    private val handler = Handler(Looper.getMainLooper())
+    private val flushRunnable = Runnable { flush() }
+    private val clearRunnable = Runnable { clear() }
+    private var flushScheduled = false
+
+    /**
+     * Buffer one key event. Flushes immediately on a terminator key, when the
+     * buffer is full or when the source device changes.
+     */
+    fun add(keyCode: Int, action: Int, codePoint: Int, eventTime: Long, deviceId: Int) {
+        if (count > 0 && deviceId != this.deviceId) {
+            flush()
+        }
+
+        this.deviceId = deviceId
+        keyCodes[count] = keyCode
+        actions[count] = action
+        codePoints[count] = codePoint
+        eventTimes[count] = eventTime
+        count++
+
+        val isTerminator = action == KeyEvent.ACTION_DOWN &&
+                (keyCode == KeyEvent.KEYCODE_ENTER || keyCode == KeyEvent.KEYCODE_NUMPAD_ENTER)
+
+        if (isTerminator || count == CAPACITY) {
+            flush()
+        } else if (!flushScheduled) {
+            handler.postDelayed(flushRunnable, FLUSH_DELAY_MS)
+            flushScheduled = true
+        }
+    }
+
+    /**
+     * Send all buffered events to native in a single JNI call
+     */
+    fun flush() {
+        if (flushScheduled) {
+            handler.removeCallbacks(flushRunnable)
+            flushScheduled = false
+        }
+        if (count == 0) return
+
+        ExternalScannerJNI.nativeOnKeyEvents(keyCodes, actions, codePoints, eventTimes, deviceId, count)
+        count = 0
+    }
+
+    /**
+     * Drop buffered events without sending them. Off the UI thread (e.g.
+     * stopScanning() on the JS thread) the clear is posted to it, so it
+     * never races add() or flush().
+     */
+    fun clear() {
+        if (Looper.myLooper() != Looper.getMainLooper()) {
+            handler.post(clearRunnable)
+            return
+        }
+        if (flushScheduled) {
+            handler.removeCallbacks(flushRunnable)
+            flushScheduled = false
+        }
+        count = 0
+    }
+}
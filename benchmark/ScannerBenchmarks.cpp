@@ -0,0 +1,214 @@
+#include "HybridExternalScanner.hpp"
+#include "ScanJournal.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+constexpr int kEnterKey = 66; // Android KEYCODE_ENTER
+constexpr const char* kCode = "4006381333931";
+constexpr size_t kDistinctCodes = 4096;
+
+DeviceInfo makeDevice(int id) {
+    return DeviceInfo(static_cast<double>(id), "Scanner " + std::to_string(id), 0x05e0, 0x1200, true);
+}
+
+// EAN-13 codes with valid check digits, distinct enough to pass dedup
+std::vector<std::string> makeCodes() {
+    std::vector<std::string> codes;
+    codes.reserve(kDistinctCodes);
+    for (size_t i = 0; i < kDistinctCodes; i++) {
+        std::string code = "400638" + std::to_string(100000 + i);
+        int sum = 0;
+        for (size_t digit = 0; digit < code.size(); digit++) {
+            sum += (code[digit] - '0') * (digit % 2 == 0 ? 1 : 3);
+        }
+        codes.push_back(code + static_cast<char>('0' + (10 - sum % 10) % 10));
+    }
+    return codes;
+}
+
+// Feeds one scan followed by Enter; returns the number of keys
+size_t feedScan(HybridExternalScanner& scanner, int deviceId, const std::string& code = kCode) {
+    for (char c : code) {
+        scanner.onKeyEvent(0, 0, std::string(1, c), deviceId);
+    }
+    scanner.onKeyEvent(kEnterKey, 0, "", deviceId);
+    return code.size() + 1;
+}
+
+// Waits until the input loop delivered at least target scans
+void waitForScans(const std::atomic<uint64_t>& completed, uint64_t target) {
+    while (completed.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+// Keys/sec through onKeyEvent. Arg 0 assembles on the calling thread, arg 1
+// hands keys to the input loop (and keeps at most ~32 scans in flight
+// so the key ring never overflows).
+static void BM_OnKeyEvent(benchmark::State& state) {
+    const bool threaded = state.range(0) != 0;
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(threaded);
+    std::atomic<uint64_t> completed{0};
+    scanner->startScanning([&](const ScanResult&) { completed.fetch_add(1, std::memory_order_release); },
+                           std::nullopt);
+
+    uint64_t sent = 0;
+    size_t keys = 0;
+    for (auto _ : state) {
+        keys += feedScan(*scanner, 1);
+        sent++;
+        if (threaded && sent % 32 == 0) {
+            waitForScans(completed, sent - 32);
+        }
+    }
+    waitForScans(completed, sent);
+    state.SetItemsProcessed(static_cast<int64_t>(keys));
+    state.counters["dropped"] = static_cast<double>(scanner->getStats().keysDropped);
+    scanner->stopScanning();
+}
+BENCHMARK(BM_OnKeyEvent)->Arg(0)->Arg(1)->ArgName("threaded")->UseRealTime();
+
+// Completed scans/sec on the calling thread. Arg 0 is the bare pipeline,
+// arg 1 enables GS1 parsing, check digit annotation, dedup and routing.
+static void BM_ScanCompletion(benchmark::State& state) {
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(false);
+    if (state.range(0) != 0) {
+        scanner->setGs1Parsing(true);
+        scanner->setValidationPolicy(ValidationPolicy::ANNOTATE);
+        scanner->setDuplicateFilter(1.0, DedupScope::DEVICE);
+        scanner->setScanRoutes({ScanRoute("ean", std::nullopt, std::string("\\d{13}"), std::nullopt, std::nullopt),
+                                ScanRoute("location", std::string("LOC-"), std::nullopt, std::nullopt, std::nullopt)},
+                               false);
+    }
+    uint64_t completed = 0;
+    scanner->startScanning([&](const ScanResult& result) { benchmark::DoNotOptimize(result.code.data()); completed++; },
+                           std::nullopt);
+
+    // Cycle through enough codes that the 1 ms dedup window never suppresses one
+    const std::vector<std::string> codes = makeCodes();
+    size_t next = 0;
+    for (auto _ : state) {
+        feedScan(*scanner, 1, codes[next++ % kDistinctCodes]);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(completed));
+    scanner->stopScanning();
+}
+BENCHMARK(BM_ScanCompletion)->Arg(0)->Arg(1)->ArgName("features");
+
+// getConnectedDevices() from several threads while one of them keeps
+// connecting and disconnecting a device
+static std::shared_ptr<HybridExternalScanner> gDeviceScanner;
+
+static void BM_GetConnectedDevices(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        gDeviceScanner = std::make_shared<HybridExternalScanner>();
+        for (int id = 1; id <= 4; id++) {
+            gDeviceScanner->onDeviceConnected(makeDevice(id));
+        }
+    }
+    // Threads start the loop together, after thread 0 set up the scanner
+    size_t devices = 0;
+    uint64_t iteration = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0 && state.threads() > 1 && (++iteration & 63) == 0) {
+            gDeviceScanner->onDeviceConnected(makeDevice(5));
+            gDeviceScanner->onDeviceDisconnected(5);
+        }
+        devices += gDeviceScanner->getConnectedDevices().size();
+    }
+    benchmark::DoNotOptimize(devices);
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        gDeviceScanner.reset();
+    }
+}
+BENCHMARK(BM_GetConnectedDevices)->ThreadRange(1, 8)->UseRealTime();
+
+// Keys from the benchmark thread while background threads connect and
+// disconnect devices and restart scanning. Reports the keys that made it
+// through alongside the throughput.
+static void BM_ConcurrentStress(benchmark::State& state) {
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(state.range(0) != 0);
+    std::atomic<uint64_t> completed{0};
+    auto onScan = [&](const ScanResult&) { completed.fetch_add(1, std::memory_order_relaxed); };
+    scanner->startScanning(onScan, std::nullopt);
+
+    std::atomic<bool> running{true};
+    std::thread devices([&]() {
+        int id = 100;
+        while (running.load(std::memory_order_relaxed)) {
+            scanner->onDeviceConnected(makeDevice(id));
+            scanner->getConnectedDevices();
+            scanner->onDeviceDisconnected(id);
+            id = id == 163 ? 100 : id + 1;
+            std::this_thread::yield();
+        }
+    });
+    std::thread control([&]() {
+        // start/stop are driven from one thread, as the JS thread would
+        while (running.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            scanner->stopScanning();
+            scanner->startScanning(onScan, std::nullopt);
+        }
+    });
+
+    size_t keys = 0;
+    int deviceId = 0;
+    for (auto _ : state) {
+        keys += feedScan(*scanner, 1 + (deviceId++ & 3));
+        // Let the other threads in, even on a single core
+        std::this_thread::yield();
+    }
+    running = false;
+    devices.join();
+    control.join();
+    scanner->stopScanning();
+
+    state.SetItemsProcessed(static_cast<int64_t>(keys));
+    const ScannerStats stats = scanner->getStats();
+    state.counters["scans"] = static_cast<double>(completed.load());
+    state.counters["ignored"] = stats.keysIgnored;
+    state.counters["dropped"] = stats.keysDropped;
+}
+BENCHMARK(BM_ConcurrentStress)->Arg(0)->Arg(1)->ArgName("threaded")->UseRealTime();
+
+// Cost a journal append adds to the scan path (no fsync)
+static void BM_JournalAppend(benchmark::State& state) {
+    char directory[] = "/tmp/es-journal-XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        state.SkipWithError("mkdtemp failed");
+        return;
+    }
+    {
+        std::unique_ptr<ScanJournal> journal = ScanJournal::open(directory);
+        if (!journal) {
+            state.SkipWithError("Cannot open journal");
+            return;
+        }
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(journal->append(kCode, 1.0, 1));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    std::filesystem::remove_all(directory);
+}
+BENCHMARK(BM_JournalAppend);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#include "CheckDigit.hpp"
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+const SymbologyRule& ruleFor(Symbology symbology) {
+    for (const SymbologyRule& rule : kSymbologyRules) {
+        if (rule.symbology == symbology) {
+            return rule;
+        }
+    }
+    return kSymbologyRules.front();
+}
+
+// Bookland EAN-13
+void markIsbn13(std::string_view code, CheckDigitResult& result) {
+    if (result.valid && result.symbology == Symbology::Ean13 &&
+        (code.substr(0, 3) == "978" || code.substr(0, 3) == "979")) {
+        result.symbology = Symbology::Isbn13;
+        result.name = "ISBN-13";
+    }
+}
+
+} // namespace
+
+CheckDigitResult validateCheckDigit(std::string_view code) {
+    CheckDigitResult result;
+    // Only numeric codes have a shape; ISBN-10 and ISSN may end in 'X'
+    if (code.empty()) {
+        return result;
+    }
+    for (size_t i = 0; i + 1 < code.size(); i++) {
+        if (checkdigit::digitValue(code[i]) < 0) {
+            return result;
+        }
+    }
+    const bool checkX = code.back() == 'X' || code.back() == 'x';
+    if (!checkX && checkdigit::digitValue(code.back()) < 0) {
+        return result;
+    }
+    for (const SymbologyRule& rule : kSymbologyRules) {
+        if (rule.length != code.size()) {
+            continue;
+        }
+        if (checkX && rule.symbology != Symbology::Issn && rule.symbology != Symbology::Isbn10) {
+            continue;
+        }
+        const bool valid = rule.validate(code);
+        if (result.name == nullptr || valid) {
+            result = {rule.symbology, rule.name, valid};
+        }
+        if (valid) {
+            break;
+        }
+    }
+
+    markIsbn13(code, result);
+    return result;
+}
+
+bool validateCheckDigit(std::string_view code, Symbology symbology) {
+    if (symbology == Symbology::Isbn13) {
+        symbology = Symbology::Ean13;
+    }
+    for (const SymbologyRule& rule : kSymbologyRules) {
+        if (rule.symbology == symbology) {
+            return rule.length == code.size() && rule.validate(code);
+        }
+    }
+    return false;
+}
+
+CheckDigitResult validateAimCheckDigit(std::string_view code, std::string_view symbology) {
+    Symbology candidate = Symbology::Unknown;
+    if (symbology == "EAN-8") {
+        candidate = Symbology::Ean8;
+    } else if (symbology == "EAN-13") {
+        // ]E0 also carries UPC-A and UPC-E, and 2 or 5 digit add-ons after
+        // the 13 digits (which have no check digit of their own)
+        if (code.size() == 15 || code.size() == 18) {
+            code = code.substr(0, 13);
+        }
+        candidate = code.size() == 12 ? Symbology::UpcA : (code.size() == 8 ? Symbology::UpcE : Symbology::Ean13);
+    } else {
+        return {};
+    }
+    const SymbologyRule& rule = ruleFor(candidate);
+    CheckDigitResult result{rule.symbology, rule.name, validateCheckDigit(code, candidate)};
+    markIsbn13(code, result);
+    return result;
+}
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace margelo::nitro::externalscanner {
+
+// Check-digit kernels. Each one is specialized on the code length at compile
+// time, so the weights are constants and the loops fully unroll.
+namespace checkdigit {
+
+constexpr int digitValue(char c) {
+    return (c >= '0' && c <= '9') ? c - '0' : -1;
+}
+
+// GS1 weights for a code of N digits: 3,1,3,... from the digit left of the check
+template <size_t N>
+constexpr std::array<uint8_t, N - 1> gs1Weights() {
+    std::array<uint8_t, N - 1> weights{};
+    for (size_t i = 0; i < N - 1; i++) {
+        weights[i] = ((N - 1 - i) % 2 == 1) ? 3 : 1;
+    }
+    return weights;
+}
+
+// GS1 mod 10 (EAN-8/13, UPC-A, GTIN-14, ITF-14, SSCC)
+template <size_t N>
+constexpr bool gs1Mod10(const char* code) {
+    constexpr auto weights = gs1Weights<N>();
+    int sum = 0;
+    bool digits = true;
+    for (size_t i = 0; i < N; i++) {
+        const int d = digitValue(code[i]);
+        digits &= d >= 0;
+        sum += (i < N - 1) ? d * weights[i] : 0;
+    }
+    return digits && (10 - sum % 10) % 10 == digitValue(code[N - 1]);
+}
+
+// Validates count codes of N digits stored back to back. Written column by
+// column over a plain sums array so the compiler can vectorize across codes.
+template <size_t N>
+void gs1Mod10Batch(const char* codes, size_t count, uint8_t* valid) {
+    constexpr auto weights = gs1Weights<N>();
+    for (size_t c = 0; c < count; c++) {
+        valid[c] = 1;
+    }
+    constexpr size_t kChunk = 64;
+    uint32_t sums[kChunk];
+    for (size_t base = 0; base < count; base += kChunk) {
+        const size_t n = (count - base < kChunk) ? count - base : kChunk;
+        const char* chunk = codes + base * N;
+        for (size_t c = 0; c < n; c++) {
+            sums[c] = 0;
+        }
+        for (size_t i = 0; i < N - 1; i++) {
+            for (size_t c = 0; c < n; c++) {
+                const uint32_t d = static_cast<uint32_t>(static_cast<unsigned char>(chunk[c * N + i]) - '0');
+                valid[base + c] &= d <= 9;
+                sums[c] += d * weights[i];
+            }
+        }
+        for (size_t c = 0; c < n; c++) {
+            const uint32_t check = static_cast<uint32_t>(static_cast<unsigned char>(chunk[c * N + N - 1]) - '0');
+            valid[base + c] &= (check <= 9) & ((10 - sums[c] % 10) % 10 == check);
+        }
+    }
+}
+
+// Mod 11 with descending weights N..1 and 'X' = 10 as check (ISBN-10, ISSN)
+template <size_t N>
+constexpr bool mod11(const char* code) {
+    int sum = 0;
+    for (size_t i = 0; i < N; i++) {
+        int d = digitValue(code[i]);
+        if (d < 0) {
+            if (i != N - 1 || (code[i] != 'X' && code[i] != 'x')) {
+                return false;
+            }
+            d = 10;
+        }
+        sum += d * static_cast<int>(N - i);
+    }
+    return sum % 11 == 0;
+}
+
+// UPC-E: expand the six middle digits to UPC-A and check that
+constexpr bool upcE(const char* code) {
+    if (code[0] != '0' && code[0] != '1') {
+        return false;
+    }
+    for (size_t i = 1; i < 8; i++) {
+        if (digitValue(code[i]) < 0) {
+            return false;
+        }
+    }
+    const char* d = code + 1;
+    char a[12] = {code[0], d[0], d[1], '0', '0', '0', '0', '0', '0', '0', '0', code[7]};
+    switch (d[5]) {
+        case '0': case '1': case '2':
+            a[3] = d[5]; a[8] = d[2]; a[9] = d[3]; a[10] = d[4];
+            break;
+        case '3':
+            a[3] = d[2]; a[9] = d[3]; a[10] = d[4];
+            break;
+        case '4':
+            a[3] = d[2]; a[4] = d[3]; a[10] = d[4];
+            break;
+        default:
+            a[3] = d[2]; a[4] = d[3]; a[5] = d[4]; a[10] = d[5];
+            break;
+    }
+    return gs1Mod10<12>(a);
+}
+
+static_assert(gs1Mod10<13>("4006381333931"));
+static_assert(!gs1Mod10<13>("4006381333932"));
+static_assert(upcE("04252614"));
+static_assert(mod11<10>("0306406152"));
+static_assert(mod11<8>("03178471"));
+
+} // namespace checkdigit
+
+enum class Symbology : uint8_t {
+    Unknown,
+    Ean8,
+    UpcE,
+    Issn,
+    Isbn10,
+    UpcA,
+    Ean13,
+    Isbn13,
+    Gtin14,
+    Sscc
+};
+
+struct SymbologyRule {
+    Symbology symbology;
+    const char* name;
+    uint8_t length;
+    bool (*validate)(std::string_view code);
+};
+
+// Candidate symbologies by length, in the order they are tried. Codes that
+// pass none of the candidates are reported as the first one (and invalid).
+inline constexpr std::array<SymbologyRule, 8> kSymbologyRules = {{
+    {Symbology::Ean8, "EAN-8", 8, [](std::string_view c) { return checkdigit::gs1Mod10<8>(c.data()); }},
+    {Symbology::UpcE, "UPC-E", 8, [](std::string_view c) { return checkdigit::upcE(c.data()); }},
+    {Symbology::Issn, "ISSN", 8, [](std::string_view c) { return checkdigit::mod11<8>(c.data()); }},
+    {Symbology::Isbn10, "ISBN-10", 10, [](std::string_view c) { return checkdigit::mod11<10>(c.data()); }},
+    {Symbology::UpcA, "UPC-A", 12, [](std::string_view c) { return checkdigit::gs1Mod10<12>(c.data()); }},
+    {Symbology::Ean13, "EAN-13", 13, [](std::string_view c) { return checkdigit::gs1Mod10<13>(c.data()); }},
+    {Symbology::Gtin14, "GTIN-14", 14, [](std::string_view c) { return checkdigit::gs1Mod10<14>(c.data()); }},
+    {Symbology::Sscc, "SSCC", 18, [](std::string_view c) { return checkdigit::gs1Mod10<18>(c.data()); }},
+}};
+
+struct CheckDigitResult {
+    Symbology symbology = Symbology::Unknown;
+    const char* name = nullptr; // nullptr when no rule applies
+    bool valid = false;
+};
+
+// Guesses the symbology of a numeric code from its shape and validates its
+// check digit; other codes get no rule (name == nullptr). A guess can be
+// wrong: numeric Code 39 or ITF codes of a matching length look like EAN/UPC.
+CheckDigitResult validateCheckDigit(std::string_view code);
+bool validateCheckDigit(std::string_view code, Symbology symbology);
+
+// Validates a code whose symbology the scanner reported (a name from
+// aimSymbology()). Only EAN/UPC carry a check digit in the data; codes of
+// any other symbology get no rule (name == nullptr).
+CheckDigitResult validateAimCheckDigit(std::string_view code, std::string_view symbology);
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,186 @@
+#include "DeadlineScheduler.hpp"
+#include <algorithm>
+
+namespace margelo::nitro::externalscanner {
+
+DeadlineScheduler::~DeadlineScheduler() {
+    stop();
+}
+
+int DeadlineScheduler::addTimer(Callback callback) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int id = 0; id < kMaxTimers; id++) {
+        Timer& timer = _timers[id];
+        if (!timer.used.load(std::memory_order_relaxed)) {
+            timer.callback = std::move(callback);
+            timer.deadline.store(kDisarmed, std::memory_order_relaxed);
+            timer.used.store(true, std::memory_order_release);
+            if (!_running.exchange(true)) {
+                _thread = std::thread([this]() { run(); });
+            }
+            return id;
+        }
+    }
+    return -1;
+}
+
+void DeadlineScheduler::removeTimer(int id) {
+    if (id < 0 || id >= kMaxTimers) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    Timer& timer = _timers[id];
+    timer.used.store(false, std::memory_order_release);
+    timer.deadline.store(kDisarmed, std::memory_order_relaxed);
+    timer.callback = nullptr;
+}
+
+void DeadlineScheduler::arm(int id, Clock::time_point deadline) {
+    if (id < 0 || id >= kMaxTimers) {
+        return;
+    }
+    // Never store kDisarmed by accident
+    int64_t ticks = std::max<int64_t>(deadline.time_since_epoch().count(), 1);
+    _timers[id].deadline.store(ticks);
+
+    // Only wake the thread if it would otherwise sleep past this deadline
+    if (ticks < _nextWake.load()) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _wakeup.notify_one();
+    }
+}
+
+void DeadlineScheduler::cancel(int id) {
+    if (id < 0 || id >= kMaxTimers) {
+        return;
+    }
+    // The thread may still wake up for it once and find nothing to do
+    _timers[id].deadline.store(kDisarmed, std::memory_order_relaxed);
+}
+
+void DeadlineScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running.exchange(false)) {
+            return;
+        }
+        _wakeup.notify_one();
+    }
+    if (_thread.get_id() == std::this_thread::get_id()) {
+        _thread.detach();
+    } else if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void DeadlineScheduler::setManual(bool manual) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _manual.store(manual);
+    _wakeup.notify_one();
+}
+
+std::optional<DeadlineScheduler::Clock::time_point> DeadlineScheduler::nextDeadline() const {
+    int64_t next = kIdle;
+    for (const Timer& timer : _timers) {
+        const int64_t deadline = timer.deadline.load();
+        if (timer.used.load(std::memory_order_acquire) && deadline != kDisarmed) {
+            next = std::min(next, deadline);
+        }
+    }
+    if (next == kIdle) {
+        return std::nullopt;
+    }
+    return Clock::time_point(Clock::duration(next));
+}
+
+void DeadlineScheduler::fireDue(Clock::time_point now) {
+    const int64_t ticks = now.time_since_epoch().count();
+    // One at a time, as a callback may arm or cancel other timers
+    while (true) {
+        Callback callback;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Timer* earliest = nullptr;
+            int64_t deadline = kIdle;
+            for (Timer& timer : _timers) {
+                const int64_t candidate = timer.deadline.load();
+                if (timer.used.load(std::memory_order_acquire) && candidate != kDisarmed &&
+                    candidate <= ticks && candidate < deadline) {
+                    earliest = &timer;
+                    deadline = candidate;
+                }
+            }
+            if (earliest == nullptr) {
+                return;
+            }
+            if (!earliest->deadline.compare_exchange_strong(deadline, kDisarmed)) {
+                continue;
+            }
+            callback = earliest->callback;
+        }
+        if (callback) {
+            callback();
+        }
+    }
+}
+
+void DeadlineScheduler::run() {
+    std::array<Callback, kMaxTimers> due;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running.load(std::memory_order_relaxed)) {
+        if (_manual.load()) {
+            _nextWake.store(kManual);
+            _wakeup.wait(lock);
+            continue;
+        }
+
+        // While scanning, any arm() takes the mutex and notifies, so a
+        // deadline stored after we looked at its timer cannot be missed
+        _nextWake.store(kIdle);
+
+        const int64_t now = Clock::now().time_since_epoch().count();
+        int64_t next = kIdle;
+        size_t dueCount = 0;
+
+        for (Timer& timer : _timers) {
+            if (!timer.used.load(std::memory_order_acquire)) {
+                continue;
+            }
+            int64_t deadline = timer.deadline.load();
+            if (deadline == kDisarmed) {
+                continue;
+            }
+            if (deadline <= now) {
+                // Fails if the timer was re-armed or cancelled meanwhile
+                if (timer.deadline.compare_exchange_strong(deadline, kDisarmed)) {
+                    due[dueCount++] = timer.callback;
+                }
+            } else if (deadline < next) {
+                next = deadline;
+            }
+        }
+
+        if (dueCount > 0) {
+            // Callbacks run unlocked so they may arm timers themselves
+            lock.unlock();
+            for (size_t i = 0; i < dueCount; i++) {
+                if (due[i]) {
+                    due[i]();
+                }
+                due[i] = nullptr;
+            }
+            lock.lock();
+            continue;
+        }
+
+        _nextWake.store(next);
+        if (next == kIdle) {
+            _wakeup.wait(lock);
+        } else {
+            _wakeup.wait_until(lock, Clock::time_point(Clock::duration(next)));
+        }
+    }
+}
+
+} // namespace margelo::nitro::externalscanner
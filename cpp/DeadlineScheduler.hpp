@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace margelo::nitro::externalscanner {
+
+// A small set of deadline timers serviced by one background thread.
+//
+// Re-arming is the hot operation (it happens on every key), so arm() is a
+// single atomic store as long as the new deadline is not earlier than the
+// one the thread is already sleeping towards. The thread re-checks timers
+// lazily when it wakes up; timers whose deadline moved later simply go back
+// to sleep.
+//
+// In manual mode (virtual time) the thread never fires anything; the owner
+// of the clock calls fireDue() as it moves time forward.
+class DeadlineScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    static constexpr int kMaxTimers = 64;
+
+    DeadlineScheduler() = default;
+    ~DeadlineScheduler();
+
+    DeadlineScheduler(const DeadlineScheduler&) = delete;
+    DeadlineScheduler& operator=(const DeadlineScheduler&) = delete;
+
+    // Register a timer; returns its id or -1 if all slots are taken.
+    // The callback runs on the scheduler thread.
+    int addTimer(Callback callback);
+    void removeTimer(int id);
+
+    // Arm (or re-arm) a timer to fire once at the given deadline
+    void arm(int id, Clock::time_point deadline);
+    void cancel(int id);
+
+    // Stop the scheduler thread; pending timers never fire afterwards
+    void stop();
+
+    void setManual(bool manual);
+    // Earliest armed deadline
+    std::optional<Clock::time_point> nextDeadline() const;
+    // Runs every timer due at now on the calling thread, earliest first
+    void fireDue(Clock::time_point now);
+
+private:
+    static constexpr int64_t kDisarmed = 0;
+    static constexpr int64_t kIdle = INT64_MAX;
+    static constexpr int64_t kManual = INT64_MIN; // arm() never wakes the thread
+
+    struct Timer {
+        std::atomic<int64_t> deadline{kDisarmed};
+        std::atomic<bool> used{false};
+        Callback callback;
+    };
+
+    std::array<Timer, kMaxTimers> _timers;
+    std::atomic<int64_t> _nextWake{kIdle};
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _manual{false};
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::thread _thread;
+
+    void run();
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace margelo::nitro::externalscanner {
+
+// Recently seen scans with per-entry expiry, used to suppress duplicates.
+//
+// Fixed open-addressing table: a key only ever lives within kMaxProbe slots
+// of its home slot, so lookups are O(1) and nothing allocates. When that
+// window is full the entry closest to expiry is overwritten, which at worst
+// lets a duplicate through - never suppresses a new code.
+class DedupCache {
+public:
+    static constexpr size_t kCapacity = 512; // power of two
+    static constexpr size_t kMaxProbe = 8;
+
+    static uint64_t hashCode(std::string_view code, int deviceId) {
+        uint64_t hash = 14695981039346656037ull; // FNV-1a
+        for (char c : code) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        hash ^= static_cast<uint64_t>(static_cast<uint32_t>(deviceId)) * 0x9E3779B97F4A7C15ull;
+        return hash != kEmpty ? hash : 1;
+    }
+
+    // True if key was seen less than window ago. Either way the key is
+    // (re-)recorded, so a code held in front of a presentation scanner stays
+    // suppressed for as long as it keeps being read.
+    bool checkAndInsert(uint64_t key, int64_t now, int64_t window) {
+        const size_t home = static_cast<size_t>(key) & (kCapacity - 1);
+        Entry* victim = nullptr;
+        for (size_t i = 0; i < kMaxProbe; i++) {
+            Entry& entry = _entries[(home + i) & (kCapacity - 1)];
+            if (entry.key == key) {
+                const bool duplicate = now < entry.expiry;
+                entry.expiry = now + window;
+                return duplicate;
+            }
+            if (victim == nullptr || entry.expiry < victim->expiry) {
+                victim = &entry;
+            }
+        }
+        victim->key = key;
+        victim->expiry = now + window;
+        return false;
+    }
+
+    void clear() {
+        _entries.fill(Entry{});
+    }
+
+private:
+    static constexpr uint64_t kEmpty = 0;
+
+    struct Entry {
+        uint64_t key = kEmpty;
+        int64_t expiry = 0; // steady_clock ticks
+    };
+
+    std::array<Entry, kCapacity> _entries{};
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,167 @@
+#include "DeviceClassifier.hpp"
+#include "ScannerLog.hpp"
+
+#define ES_LOG_TAG "ExternalScanner DeviceClassifier"
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+// Internal/system devices that expose a keyboard source
+constexpr std::string_view kExcludedNames[] = {
+    "mtk-",          // MediaTek internal
+    "pmic",          // Power management
+    "_ts",           // Touchscreen
+    "touchscreen",
+    "touch screen",
+    "headset",       // Audio jack
+    "headphone",
+    "gpio",          // GPIO keys
+    "power",         // Power button
+    "volume",        // Volume buttons
+    "fingerprint",   // Fingerprint sensor
+    "accelerometer", // Sensors
+    "gyroscope",
+    "compass",
+    "proximity",
+    "light sensor",
+    "^kpd",          // Keypad (internal)
+    "-kpd$",
+    ",pen",          // Stylus pen
+};
+
+// Common scanner/RFID identifiers
+constexpr std::string_view kScannerNames[] = {
+    "scanner", "barcode", "reader", "rfid", "symbol", "honeywell", "zebra",
+    "datalogic", "newland", "opticon", "motorola", "intermec", "denso", "keyence",
+};
+
+} // namespace
+
+DeviceClassifier::DeviceClassifier() {
+    std::vector<Keyword> keywords;
+    for (std::string_view name : kExcludedNames) {
+        keywords.push_back(Keyword{std::string(name), kExcludeTag});
+    }
+    for (std::string_view name : kScannerNames) {
+        keywords.push_back(Keyword{std::string(name), kScannerTag});
+    }
+    _names = KeywordMatcher::compile(keywords);
+}
+
+bool DeviceClassifier::classify(const InputDeviceDescriptor& device) const {
+    std::shared_ptr<const DeviceRuleTable> rules = std::atomic_load_explicit(&_rules, std::memory_order_acquire);
+    return classify(device, rules.get());
+}
+
+bool DeviceClassifier::classify(const InputDeviceDescriptor& device, const DeviceRuleTable* rules) const {
+    if (device.isVirtual || !device.hasKeyboard) {
+        return false;
+    }
+    if (rules != nullptr) {
+        std::optional<bool> verdict = rules->evaluate(device.name, device.vendorId, device.productId);
+        if (verdict.has_value()) {
+            return *verdict;
+        }
+    }
+    const uint32_t tags = _names->match(device.name);
+    if ((tags & kExcludeTag) != 0) {
+        return false;
+    }
+    if ((tags & kScannerTag) != 0) {
+        return true;
+    }
+    // Other keyboards need USB ids, which built-in keyboards do not have
+    return device.vendorId > 0 && device.productId > 0;
+}
+
+std::optional<bool> DeviceClassifier::evaluateRules(const InputDeviceDescriptor& device) const {
+    std::shared_ptr<const DeviceRuleTable> rules = std::atomic_load_explicit(&_rules, std::memory_order_acquire);
+    if (!rules) {
+        return std::nullopt;
+    }
+    return rules->evaluate(device.name, device.vendorId, device.productId);
+}
+
+bool DeviceClassifier::update(int deviceId, const InputDeviceDescriptor& device) {
+    // Classify under the lock, so a concurrent setRules() cannot leave a stale verdict
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    const bool isScanner = classify(device);
+    ES_LOGD("update: deviceId=" << deviceId << " '" << device.name << "' -> " << (isScanner ? "scanner" : "not a scanner"));
+    _known[deviceId] = KnownDevice{std::string(device.name), device.vendorId, device.productId, device.isVirtual,
+                                   device.hasKeyboard};
+    storeVerdict(deviceId, isScanner);
+    return isScanner;
+}
+
+void DeviceClassifier::setRules(std::shared_ptr<const DeviceRuleTable> rules) {
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    std::atomic_store_explicit(&_rules, rules, std::memory_order_release);
+    for (const auto& [deviceId, known] : _known) {
+        const InputDeviceDescriptor device{known.name, known.vendorId, known.productId, known.isVirtual,
+                                           known.hasKeyboard};
+        const bool isScanner = classify(device, rules.get());
+        ES_LOGD("setRules: deviceId=" << deviceId << " '" << known.name << "' -> "
+                                      << (isScanner ? "scanner" : "not a scanner"));
+        storeVerdict(deviceId, isScanner);
+    }
+}
+
+void DeviceClassifier::storeVerdict(int deviceId, bool isScanner) {
+    const uint64_t entry = (static_cast<uint64_t>(static_cast<uint32_t>(deviceId)) << 32) | kValid |
+                           (isScanner ? kScanner : 0);
+    const size_t home = homeSlot(deviceId);
+    std::atomic<uint64_t>* freeSlot = nullptr;
+    for (size_t i = 0; i < kCacheCapacity; i++) {
+        std::atomic<uint64_t>& slot = _cache[(home + i) & (kCacheCapacity - 1)];
+        const uint64_t current = slot.load(std::memory_order_relaxed);
+        if (current != kEmpty && current != kRemoved && entryId(current) == static_cast<uint32_t>(deviceId)) {
+            slot.store(entry, std::memory_order_release);
+            return;
+        }
+        if (freeSlot == nullptr && (current == kEmpty || current == kRemoved)) {
+            freeSlot = &slot;
+        }
+        if (current == kEmpty) {
+            break;
+        }
+    }
+    if (freeSlot != nullptr) {
+        freeSlot->store(entry, std::memory_order_release);
+    } else {
+        ES_LOGW("storeVerdict: Classification cache full, not caching deviceId=" << deviceId);
+    }
+}
+
+void DeviceClassifier::forget(int deviceId) {
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    _known.erase(deviceId);
+    const size_t home = homeSlot(deviceId);
+    for (size_t i = 0; i < kCacheCapacity; i++) {
+        std::atomic<uint64_t>& slot = _cache[(home + i) & (kCacheCapacity - 1)];
+        const uint64_t current = slot.load(std::memory_order_relaxed);
+        if (current == kEmpty) {
+            return;
+        }
+        if (current != kRemoved && entryId(current) == static_cast<uint32_t>(deviceId)) {
+            slot.store(kRemoved, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+std::optional<bool> DeviceClassifier::cached(int deviceId) const {
+    const size_t home = homeSlot(deviceId);
+    for (size_t i = 0; i < kCacheCapacity; i++) {
+        const uint64_t current = _cache[(home + i) & (kCacheCapacity - 1)].load(std::memory_order_acquire);
+        if (current == kEmpty) {
+            return std::nullopt;
+        }
+        if (current != kRemoved && entryId(current) == static_cast<uint32_t>(deviceId)) {
+            return (current & kScanner) != 0;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace margelo::nitro::externalscanner
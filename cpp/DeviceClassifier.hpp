@@ -0,0 +1,91 @@
+#pragma once
+
+#include "DeviceRuleTable.hpp"
+#include "KeywordMatcher.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace margelo::nitro::externalscanner {
+
+// What the platform reports about an input device
+struct InputDeviceDescriptor {
+    std::string_view name;
+    int vendorId = 0;
+    int productId = 0;
+    bool isVirtual = false;
+    bool hasKeyboard = false;
+};
+
+// Decides whether an input device is an external scanner, and remembers the
+// verdict per device id so the key path only does a lookup.
+//
+// Names are checked against the built-in include/exclude lists in a single
+// pass (see KeywordMatcher). Non-virtual keyboards are scanners unless their
+// name marks them as internal hardware; a scanner-like name accepts them,
+// otherwise they need USB vendor and product ids. User rules (see
+// DeviceRuleTable) take precedence over these heuristics.
+class DeviceClassifier {
+public:
+    static constexpr size_t kCacheCapacity = 64; // power of two
+
+    DeviceClassifier();
+
+    bool classify(const InputDeviceDescriptor& device) const;
+
+    // Classifies the device and caches the verdict (called on add/change)
+    bool update(int deviceId, const InputDeviceDescriptor& device);
+    void forget(int deviceId);
+    // Cached verdict, nullopt if the device was never classified. Lock-free.
+    std::optional<bool> cached(int deviceId) const;
+
+    // Swaps the rule table (nullptr = none) and re-classifies every known
+    // device, so verdicts change without interrupting the key path
+    void setRules(std::shared_ptr<const DeviceRuleTable> rules);
+    // Verdict of the user rules alone, nullopt if none matches
+    std::optional<bool> evaluateRules(const InputDeviceDescriptor& device) const;
+
+private:
+    static constexpr uint32_t kExcludeTag = 1;
+    static constexpr uint32_t kScannerTag = 2;
+
+    // Entry: device id in the upper 32 bits, then a state byte
+    static constexpr uint64_t kEmpty = 0;
+    static constexpr uint64_t kRemoved = 1;
+    static constexpr uint64_t kValid = 2;
+    static constexpr uint64_t kScanner = 4;
+
+    struct KnownDevice {
+        std::string name;
+        int vendorId = 0;
+        int productId = 0;
+        bool isVirtual = false;
+        bool hasKeyboard = false;
+    };
+
+    static uint64_t entryId(uint64_t entry) { return entry >> 32; }
+    static size_t homeSlot(int deviceId) { return static_cast<uint32_t>(deviceId) & (kCacheCapacity - 1); }
+
+    bool classify(const InputDeviceDescriptor& device, const DeviceRuleTable* rules) const;
+    // Requires _writeMutex
+    void storeVerdict(int deviceId, bool isScanner);
+
+    std::shared_ptr<const KeywordMatcher> _names;
+    // Only accessed through std::atomic_load/atomic_store
+    std::shared_ptr<const DeviceRuleTable> _rules;
+
+    // Open addressing with tombstones; Android hands out small sequential
+    // ids, so almost every device sits in its home slot
+    std::mutex _writeMutex;
+    std::array<std::atomic<uint64_t>, kCacheCapacity> _cache{};
+    std::unordered_map<int, KnownDevice> _known; // for re-classification, guarded by _writeMutex
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "DeviceInfo.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+// Immutable view of the connected devices. generation increases with every
+// change, so callers can tell whether a list they hold is still current.
+struct DeviceSnapshot {
+    uint64_t generation = 0;
+    std::vector<DeviceInfo> devices;
+};
+
+// Connected devices, published copy-on-write: writers build a new snapshot
+// and swap it in, readers load the current one (a reference count bump, no
+// registry lock) and keep it alive for as long as they use it. Presence and
+// generation are mirrored into plain atomics, so those queries are a single load.
+class DeviceRegistry {
+public:
+    DeviceRegistry() { store(std::make_shared<const DeviceSnapshot>()); }
+
+    std::shared_ptr<const DeviceSnapshot> snapshot() const {
+        return std::atomic_load_explicit(&_snapshot, std::memory_order_acquire);
+    }
+
+    bool hasDevices() const { return _hasDevices.load(std::memory_order_acquire); }
+    // 0 until the first device list was published
+    uint64_t generation() const { return _generation.load(std::memory_order_acquire); }
+
+    // Writers are serialized; each returns false if nothing changed
+    bool add(const DeviceInfo& device) {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        const std::shared_ptr<const DeviceSnapshot> current = snapshot();
+        for (const DeviceInfo& existing : current->devices) {
+            if (existing.id == device.id) {
+                return false;
+            }
+        }
+        std::vector<DeviceInfo> devices = current->devices;
+        devices.push_back(device);
+        publish(current->generation, std::move(devices));
+        return true;
+    }
+
+    bool remove(double deviceId) {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        const std::shared_ptr<const DeviceSnapshot> current = snapshot();
+        std::vector<DeviceInfo> devices;
+        devices.reserve(current->devices.size());
+        for (const DeviceInfo& device : current->devices) {
+            if (device.id != deviceId) {
+                devices.push_back(device);
+            }
+        }
+        if (devices.size() == current->devices.size()) {
+            return false;
+        }
+        publish(current->generation, std::move(devices));
+        return true;
+    }
+
+    // Full resync from the platform; an identical list keeps the generation
+    bool replace(std::vector<DeviceInfo> devices) {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        const std::shared_ptr<const DeviceSnapshot> current = snapshot();
+        if (current->generation != 0 && sameDevices(current->devices, devices)) {
+            return false;
+        }
+        publish(current->generation, std::move(devices));
+        return true;
+    }
+
+private:
+    static bool sameDevices(const std::vector<DeviceInfo>& a, const std::vector<DeviceInfo>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].id != b[i].id || a[i].name != b[i].name || a[i].vendorId != b[i].vendorId ||
+                a[i].productId != b[i].productId || a[i].isExternal != b[i].isExternal) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void publish(uint64_t previousGeneration, std::vector<DeviceInfo> devices) {
+        auto next = std::make_shared<DeviceSnapshot>();
+        next->generation = previousGeneration + 1;
+        next->devices = std::move(devices);
+        const bool hasDevices = !next->devices.empty();
+        const uint64_t generation = next->generation;
+        // Snapshot first: whoever sees the new generation also gets its list
+        store(std::move(next));
+        _hasDevices.store(hasDevices, std::memory_order_release);
+        _generation.store(generation, std::memory_order_release);
+    }
+
+    void store(std::shared_ptr<const DeviceSnapshot> next) {
+        std::atomic_store_explicit(&_snapshot, std::move(next), std::memory_order_release);
+    }
+
+    std::mutex _writeMutex;
+    // Only accessed through std::atomic_load/atomic_store (std::atomic<shared_ptr>
+    // is not available in every standard library we build against)
+    std::shared_ptr<const DeviceSnapshot> _snapshot;
+    std::atomic<bool> _hasDevices{false};
+    std::atomic<uint64_t> _generation{0};
+};
+
+} // namespace margelo::nitro::externalscanner
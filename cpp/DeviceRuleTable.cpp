@@ -0,0 +1,164 @@
+#include "DeviceRuleTable.hpp"
+#include <algorithm>
+#include <map>
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+constexpr int kMaxUsbId = 0xFFFF;
+
+uint32_t idKey(int vendorId, int productId) {
+    return (static_cast<uint32_t>(vendorId) << 16) | static_cast<uint32_t>(productId);
+}
+
+} // namespace
+
+std::shared_ptr<const DeviceRuleTable> DeviceRuleTable::compile(const std::vector<DeviceMatchRule>& rules,
+                                                                std::string& error) {
+    if (rules.size() > kMaxRules) {
+        error = "too many rules (" + std::to_string(rules.size()) + ", at most " + std::to_string(kMaxRules) + ")";
+        return nullptr;
+    }
+
+    std::shared_ptr<DeviceRuleTable> table(new DeviceRuleTable());
+    std::map<std::string, int> nameBits;
+    std::vector<Keyword> keywords;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges(rules.size());
+    for (size_t i = 0; i < rules.size(); i++) {
+        const DeviceMatchRule& rule = rules[i];
+        const std::string where = "rule " + std::to_string(i) + ": ";
+        Rule compiled;
+        compiled.accept = rule.accept;
+        compiled.priority = rule.priority;
+
+        if (rule.vendorId.has_value()) {
+            if (*rule.vendorId <= 0 || *rule.vendorId > kMaxUsbId) {
+                error = where + "vendorId out of range";
+                return nullptr;
+            }
+            if (rule.productIdMin < 0 || rule.productIdMax > kMaxUsbId || rule.productIdMin > rule.productIdMax) {
+                error = where + "invalid productId range";
+                return nullptr;
+            }
+            ranges[i] = {idKey(*rule.vendorId, rule.productIdMin), idKey(*rule.vendorId, rule.productIdMax)};
+        } else if (rule.productIdMin != 0 || rule.productIdMax != kMaxUsbId) {
+            error = where + "productId range without vendorId";
+            return nullptr;
+        }
+
+        if (!rule.namePattern.empty()) {
+            auto [it, inserted] = nameBits.emplace(rule.namePattern, static_cast<int>(nameBits.size()));
+            if (inserted) {
+                if (nameBits.size() > kMaxNamePatterns) {
+                    error = where + "too many distinct name patterns (at most " + std::to_string(kMaxNamePatterns) + ")";
+                    return nullptr;
+                }
+                keywords.push_back(Keyword{rule.namePattern, 1u << it->second});
+            }
+            compiled.nameBit = it->second;
+        }
+        table->_rules.push_back(compiled);
+    }
+
+    if (!keywords.empty()) {
+        table->_names = KeywordMatcher::compile(keywords);
+        if (!table->_names) {
+            error = "invalid or too complex name patterns";
+            return nullptr;
+        }
+    }
+
+    auto byQuality = [&table](uint16_t a, uint16_t b) { return table->better(a, b); };
+
+    // Split the id ranges at every boundary into disjoint segments
+    std::vector<uint64_t> bounds;
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (rules[i].vendorId.has_value()) {
+            bounds.push_back(ranges[i].first);
+            bounds.push_back(static_cast<uint64_t>(ranges[i].second) + 1);
+        } else {
+            table->_anyDevice.push_back(static_cast<uint16_t>(i));
+        }
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    std::stable_sort(table->_anyDevice.begin(), table->_anyDevice.end(), byQuality);
+
+    std::vector<uint16_t> covering;
+    for (size_t b = 0; b + 1 < bounds.size(); b++) {
+        const uint32_t first = static_cast<uint32_t>(bounds[b]);
+        const uint32_t last = static_cast<uint32_t>(bounds[b + 1] - 1);
+        covering.clear();
+        for (size_t i = 0; i < rules.size(); i++) {
+            if (rules[i].vendorId.has_value() && ranges[i].first <= first && last <= ranges[i].second) {
+                covering.push_back(static_cast<uint16_t>(i));
+            }
+        }
+        if (covering.empty()) {
+            continue;
+        }
+        std::stable_sort(covering.begin(), covering.end(), byQuality);
+        Segment segment;
+        segment.first = first;
+        segment.last = last;
+        segment.candidatesBegin = static_cast<uint32_t>(table->_candidates.size());
+        table->_candidates.insert(table->_candidates.end(), covering.begin(), covering.end());
+        segment.candidatesEnd = static_cast<uint32_t>(table->_candidates.size());
+        table->_segments.push_back(segment);
+    }
+    return table;
+}
+
+bool DeviceRuleTable::better(uint16_t a, uint16_t b) const {
+    const Rule& ruleA = _rules[a];
+    const Rule& ruleB = _rules[b];
+    if (ruleA.priority != ruleB.priority) {
+        return ruleA.priority > ruleB.priority;
+    }
+    if (ruleA.accept != ruleB.accept) {
+        return !ruleA.accept;
+    }
+    return a < b;
+}
+
+bool DeviceRuleTable::nameMatches(uint16_t rule, uint32_t nameTags) const {
+    const int bit = _rules[rule].nameBit;
+    return bit < 0 || (nameTags & (1u << bit)) != 0;
+}
+
+std::optional<bool> DeviceRuleTable::evaluate(std::string_view name, int vendorId, int productId) const {
+    const uint32_t nameTags = _names ? _names->match(name) : 0;
+
+    int best = -1;
+    for (uint16_t rule : _anyDevice) {
+        if (nameMatches(rule, nameTags)) {
+            best = rule;
+            break;
+        }
+    }
+
+    if (vendorId > 0 && vendorId <= kMaxUsbId && productId >= 0 && productId <= kMaxUsbId && !_segments.empty()) {
+        const uint32_t key = idKey(vendorId, productId);
+        auto it = std::upper_bound(_segments.begin(), _segments.end(), key,
+                                   [](uint32_t value, const Segment& segment) { return value < segment.first; });
+        if (it != _segments.begin() && key <= (--it)->last) {
+            for (uint32_t i = it->candidatesBegin; i < it->candidatesEnd; i++) {
+                const uint16_t rule = _candidates[i];
+                if (nameMatches(rule, nameTags)) {
+                    if (best < 0 || better(rule, static_cast<uint16_t>(best))) {
+                        best = rule;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (best < 0) {
+        return std::nullopt;
+    }
+    return _rules[static_cast<size_t>(best)].accept;
+}
+
+} // namespace margelo::nitro::externalscanner
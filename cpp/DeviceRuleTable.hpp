@@ -0,0 +1,73 @@
+#pragma once
+
+#include "KeywordMatcher.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+struct DeviceMatchRule {
+    std::optional<int> vendorId; // USB vendor id; required for a product id range
+    int productIdMin = 0;
+    int productIdMax = 0xFFFF;
+    std::string namePattern; // KeywordMatcher syntax; empty = any name
+    bool accept = true;
+    int priority = 0;
+};
+
+// User rules that override the built-in scanner detection. Id ranges are
+// compiled into sorted, disjoint (vendor << 16 | product) segments, each
+// listing the rules that cover it, so a lookup is a binary search; name
+// patterns share one KeywordMatcher pass. A rule matches when all of its
+// conditions do (a rule without conditions matches every device). The
+// highest priority wins, a reject beats an accept of equal priority, and
+// after that the earlier rule wins.
+class DeviceRuleTable {
+public:
+    static constexpr size_t kMaxRules = 1024;
+    static constexpr size_t kMaxNamePatterns = 32; // one KeywordMatcher tag bit each
+
+    // Returns nullptr and describes the problem in error if a rule is invalid
+    static std::shared_ptr<const DeviceRuleTable> compile(const std::vector<DeviceMatchRule>& rules,
+                                                          std::string& error);
+
+    // Verdict of the winning rule (true = accept), nullopt if no rule matches.
+    // vendorId <= 0 means the device has no USB ids.
+    std::optional<bool> evaluate(std::string_view name, int vendorId, int productId) const;
+
+    size_t ruleCount() const { return _rules.size(); }
+    size_t segmentCount() const { return _segments.size(); }
+
+private:
+    struct Rule {
+        bool accept = true;
+        int priority = 0;
+        int nameBit = -1; // -1 = no name condition
+    };
+
+    struct Segment {
+        uint32_t first = 0;
+        uint32_t last = 0;
+        uint32_t candidatesBegin = 0;
+        uint32_t candidatesEnd = 0;
+    };
+
+    DeviceRuleTable() = default;
+
+    // Orders rule indices best first
+    bool better(uint16_t a, uint16_t b) const;
+    bool nameMatches(uint16_t rule, uint32_t nameTags) const;
+
+    std::vector<Rule> _rules;
+    std::vector<Segment> _segments;    // sorted by first, disjoint
+    std::vector<uint16_t> _candidates; // rule indices per segment, best first
+    std::vector<uint16_t> _anyDevice;  // rules without an id condition, best first
+    std::shared_ptr<const KeywordMatcher> _names;
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,362 @@
+#include "EvdevInput.hpp"
+#include "ScannerLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#endif
+
+#define ES_LOG_TAG "ExternalScanner Evdev"
+
+namespace margelo::nitro::externalscanner {
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr std::string_view kNodePrefix = "event";
+
+bool hasKey(const uint8_t* bits, int code) {
+    return (bits[code / 8] & (1u << (code % 8))) != 0;
+}
+
+int64_t eventTime(const input_event& event) {
+#if defined(input_event_sec)
+    const int64_t seconds = event.input_event_sec;
+    const int64_t micros = event.input_event_usec;
+#else
+    const int64_t seconds = event.time.tv_sec;
+    const int64_t micros = event.time.tv_usec;
+#endif
+    if (seconds == 0 && micros == 0) {
+        // Synthetic events without a timestamp
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+    // steady_clock is CLOCK_MONOTONIC, the clock requested with EVIOCSCLOCKID
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(seconds) +
+                                                                           std::chrono::microseconds(micros))
+        .count();
+}
+
+} // namespace
+
+static_assert(sizeof(input_event) <= 32, "EvdevSource::_partial holds one input_event");
+
+EvdevSource::EvdevSource(std::string path, KeyCodeSet keyCodeSet, Filter filter, bool grab)
+    : _keyCodeSet(keyCodeSet), _filter(std::move(filter)), _grab(grab) {
+    const size_t slash = path.rfind('/');
+    _info.deviceId = kDeviceIdBase + std::atoi(path.c_str() + slash + 1 + kNodePrefix.size());
+    _info.name = path;
+    _info.path = std::move(path);
+}
+
+EvdevSource::EvdevSource(int fd, int deviceId, KeyCodeSet keyCodeSet) : _fd(fd), _keyCodeSet(keyCodeSet) {
+    _info.deviceId = deviceId;
+    _info.name = "fd " + std::to_string(fd);
+    _info.hasKeyboard = true;
+}
+
+EvdevSource::~EvdevSource() {
+    stop();
+}
+
+bool EvdevSource::start() {
+    if (_info.path.empty()) {
+        const int flags = fcntl(_fd, F_GETFL);
+        if (flags < 0 || fcntl(_fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+            ES_LOGE("start: Cannot make fd " << _fd << " non-blocking: " << std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    _fd = open(_info.path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (_fd < 0) {
+        ES_LOGD("start: Cannot open '" << _info.path << "': " << std::strerror(errno));
+        return false;
+    }
+    char name[256] = {};
+    if (ioctl(_fd, EVIOCGNAME(sizeof(name) - 1), name) >= 0) {
+        _info.name = name;
+    }
+    input_id id{};
+    if (ioctl(_fd, EVIOCGID, &id) >= 0) {
+        _info.vendorId = id.vendor;
+        _info.productId = id.product;
+        _info.isVirtual = id.bustype == BUS_VIRTUAL;
+    }
+    uint8_t keys[KEY_MAX / 8 + 1] = {};
+    if (ioctl(_fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) >= 0) {
+        _info.hasKeyboard = hasKey(keys, KEY_A) && hasKey(keys, KEY_1) && hasKey(keys, KEY_ENTER);
+    }
+
+    if (_filter && !_filter(_info)) {
+        ES_LOGD("start: Skipping " << _info.path << " '" << _info.name << "'");
+        stop();
+        return false;
+    }
+    if (_grab && ioctl(_fd, EVIOCGRAB, 1) != 0) {
+        // Still readable, but the keys also reach other readers
+        ES_LOGW("start: Cannot grab " << _info.path << ": " << std::strerror(errno));
+    }
+#if defined(EVIOCSCLOCKID)
+    int clock = CLOCK_MONOTONIC;
+    if (ioctl(_fd, EVIOCSCLOCKID, &clock) != 0) {
+        ES_LOGW("start: Cannot select CLOCK_MONOTONIC for " << _info.path << ": " << std::strerror(errno));
+    }
+#endif
+    ES_LOGI("start: " << _info.deviceId << " '" << _info.name << "' vendorId=" << _info.vendorId
+                      << " productId=" << _info.productId);
+    return true;
+}
+
+void EvdevSource::stop() {
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+std::optional<SourceDevice> EvdevSource::device() const {
+    return SourceDevice{_info.deviceId, _info.name, _info.vendorId, _info.productId};
+}
+
+bool EvdevSource::drain(InputSink& sink) {
+    input_event events[kReadBatch];
+    std::memcpy(events, _partial.data(), _partialSize);
+    const ssize_t bytes =
+        read(_fd, reinterpret_cast<char*>(events) + _partialSize, sizeof(events) - _partialSize);
+    if (bytes <= 0) {
+        if (bytes < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return true;
+        }
+        if (bytes == 0 || errno == ENODEV) {
+            ES_LOGI("drain: " << _info.deviceId << " '" << _info.name << "' disconnected");
+        } else {
+            ES_LOGE("drain: Cannot read " << _info.deviceId << ": " << std::strerror(errno));
+        }
+        return false;
+    }
+
+    const size_t total = _partialSize + static_cast<size_t>(bytes);
+    const size_t count = total / sizeof(input_event);
+    _partialSize = total % sizeof(input_event);
+    std::memcpy(_partial.data(), reinterpret_cast<const char*>(events) + count * sizeof(input_event), _partialSize);
+
+    KeyEvent keys[kReadBatch];
+    size_t keyCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        const input_event& event = events[i];
+        // value: 1 = press, 0 = release, 2 = autorepeat (ignored)
+        if (event.type != EV_KEY || event.value > 1) {
+            continue;
+        }
+        const int keyCode = Keymap::keyCode(_keyCodeSet, Keymap::usage(KeyCodeSet::Linux, event.code));
+        if (keyCode == 0) {
+            continue;
+        }
+        keys[keyCount++] = KeyEvent::make(keyCode, event.value == 1 ? 0 : 1, {}, _info.deviceId, eventTime(event));
+    }
+    if (keyCount > 0) {
+        sink.onSourceKeys(keys, keyCount);
+    }
+    return true;
+}
+
+EvdevInput::EvdevInput(InputLoop& loop, std::string directory, KeyCodeSet keyCodeSet, EvdevSource::Filter filter,
+                       bool grab)
+    : _loop(loop), _directory(std::move(directory)), _keyCodeSet(keyCodeSet), _filter(std::move(filter)),
+      _grab(grab) {}
+
+EvdevInput::~EvdevInput() {
+    if (_watchFd >= 0) {
+        close(_watchFd);
+    }
+}
+
+bool EvdevInput::start() {
+    _watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_watchFd < 0) {
+        ES_LOGE("start: Cannot create inotify instance: " << std::strerror(errno));
+        return false;
+    }
+    // IN_ATTRIB: nodes usually become readable after they appear
+    if (inotify_add_watch(_watchFd, _directory.c_str(), IN_CREATE | IN_ATTRIB | IN_DELETE) < 0) {
+        ES_LOGE("start: Cannot watch '" << _directory << "': " << std::strerror(errno));
+        close(_watchFd);
+        _watchFd = -1;
+        return false;
+    }
+    return true;
+}
+
+void EvdevInput::stop() {
+    std::vector<std::pair<std::string, int>> opened;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        opened.swap(_opened);
+    }
+    for (const auto& [path, id] : opened) {
+        if (id >= 0) {
+            _loop.remove(id);
+        }
+    }
+    if (_watchFd >= 0) {
+        close(_watchFd);
+        _watchFd = -1;
+    }
+}
+
+size_t EvdevInput::openDevices() {
+    DIR* dir = opendir(_directory.c_str());
+    if (dir == nullptr) {
+        ES_LOGE("openDevices: Cannot read '" << _directory << "': " << std::strerror(errno));
+        return 0;
+    }
+    std::vector<std::string> paths;
+    while (dirent* entry = readdir(dir)) {
+        if (std::string_view(entry->d_name).substr(0, kNodePrefix.size()) == kNodePrefix) {
+            paths.push_back(_directory + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(paths.begin(), paths.end());
+
+    size_t opened = 0;
+    for (const std::string& path : paths) {
+        if (openNode(path)) {
+            opened++;
+        }
+    }
+    ES_LOGD("openDevices: Opened " << opened << " of " << paths.size() << " devices in " << _directory);
+    return opened;
+}
+
+bool EvdevInput::openNode(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const bool open = std::any_of(_opened.begin(), _opened.end(),
+                                      [&path](const auto& opened) { return opened.first == path; });
+        if (open || _opened.size() >= kMaxDevices) {
+            return false;
+        }
+        // Claimed while unlocked below, so the watch and openDevices() cannot both open it
+        _opened.emplace_back(path, -1);
+    }
+    const int id = _loop.add(std::make_shared<EvdevSource>(path, _keyCodeSet, _filter, _grab));
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it =
+            std::find_if(_opened.begin(), _opened.end(), [&path](const auto& opened) { return opened.first == path; });
+        if (it != _opened.end()) {
+            if (id < 0) {
+                _opened.erase(it);
+                return false;
+            }
+            it->second = id;
+            return true;
+        }
+    }
+    // stop() ran meanwhile
+    if (id >= 0) {
+        _loop.remove(id);
+    }
+    return false;
+}
+
+bool EvdevInput::drain(InputSink&) {
+    alignas(inotify_event) char buffer[4096];
+    const ssize_t bytes = read(_watchFd, buffer, sizeof(buffer));
+    if (bytes <= 0) {
+        return bytes < 0 && (errno == EAGAIN || errno == EINTR);
+    }
+    for (ssize_t offset = 0; offset < bytes;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        if (event->len == 0 || std::string_view(event->name).substr(0, kNodePrefix.size()) != kNodePrefix) {
+            continue;
+        }
+        const std::string path = _directory + "/" + event->name;
+        if ((event->mask & IN_DELETE) != 0) {
+            // The device's own source ends with ENODEV; just let the node be opened again
+            std::lock_guard<std::mutex> lock(_mutex);
+            _opened.erase(std::remove_if(_opened.begin(), _opened.end(),
+                                         [&path](const auto& opened) { return opened.first == path && opened.second >= 0; }),
+                          _opened.end());
+        } else {
+            openNode(path);
+        }
+    }
+    return true;
+}
+
+#else
+
+EvdevSource::EvdevSource(std::string path, KeyCodeSet keyCodeSet, Filter filter, bool grab)
+    : _keyCodeSet(keyCodeSet), _filter(std::move(filter)), _grab(grab) {
+    _info.path = std::move(path);
+}
+
+EvdevSource::EvdevSource(int fd, int deviceId, KeyCodeSet keyCodeSet) : _fd(fd), _keyCodeSet(keyCodeSet) {
+    _info.deviceId = deviceId;
+}
+
+EvdevSource::~EvdevSource() {
+    stop();
+}
+
+bool EvdevSource::start() {
+    ES_LOGE("start: evdev input is only available on Linux");
+    return false;
+}
+
+void EvdevSource::stop() {
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+std::optional<SourceDevice> EvdevSource::device() const {
+    return std::nullopt;
+}
+
+bool EvdevSource::drain(InputSink&) {
+    return false;
+}
+
+EvdevInput::EvdevInput(InputLoop& loop, std::string directory, KeyCodeSet keyCodeSet, EvdevSource::Filter filter,
+                       bool grab)
+    : _loop(loop), _directory(std::move(directory)), _keyCodeSet(keyCodeSet), _filter(std::move(filter)),
+      _grab(grab) {}
+
+EvdevInput::~EvdevInput() = default;
+
+bool EvdevInput::start() {
+    ES_LOGE("start: evdev input is only available on Linux");
+    return false;
+}
+
+void EvdevInput::stop() {}
+
+size_t EvdevInput::openDevices() {
+    return 0;
+}
+
+bool EvdevInput::drain(InputSink&) {
+    return false;
+}
+
+#endif
+
+} // namespace margelo::nitro::externalscanner
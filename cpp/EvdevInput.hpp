@@ -0,0 +1,104 @@
+#pragma once
+
+#include "InputLoop.hpp"
+#include "Keymap.hpp"
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+struct EvdevDevice {
+    int deviceId = 0;
+    std::string path;
+    std::string name;
+    int vendorId = 0;
+    int productId = 0;
+    bool isVirtual = false;   // BUS_VIRTUAL, e.g. uinput
+    bool hasKeyboard = false; // reports letter, digit and Enter keys
+};
+
+// Reads keys straight from one Linux evdev node (/dev/input/eventN), without
+// going through the platform's input dispatch, or from any fd carrying
+// input_event structs, such as a pipe fed with synthetic events.
+//
+// Each drain() reads up to kReadBatch input_events. EV_KEY presses and
+// releases are converted to the configured key code set (through HID usages,
+// see Keymap) and passed to the sink as one batch, stamped with the kernel's
+// CLOCK_MONOTONIC event time. The source ends when the device goes away.
+// On other platforms than Linux start() fails.
+class EvdevSource : public InputSource {
+public:
+    // Device ids are kDeviceIdBase + the node number, clear of platform ids
+    static constexpr int kDeviceIdBase = 0x10000;
+    static constexpr size_t kReadBatch = 64;
+
+    using Filter = std::function<bool(const EvdevDevice& device)>;
+
+    // Opens path on start(), which fails if the filter rejects the device;
+    // grabs it (EVIOCGRAB) if requested
+    EvdevSource(std::string path, KeyCodeSet keyCodeSet, Filter filter, bool grab);
+    // Reads fd, which it takes ownership of
+    EvdevSource(int fd, int deviceId, KeyCodeSet keyCodeSet);
+    ~EvdevSource() override;
+
+    const EvdevDevice& info() const { return _info; }
+
+    bool start() override;
+    void stop() override;
+    int readinessFd() const override { return _fd; }
+    bool drain(InputSink& sink) override;
+    std::optional<SourceDevice> device() const override;
+
+private:
+    int _fd = -1;
+    EvdevDevice _info;
+    const KeyCodeSet _keyCodeSet;
+    const Filter _filter;
+    const bool _grab = false;
+    // Bytes of an input_event split across reads (only pipes do that)
+    std::array<char, 32> _partial{};
+    size_t _partialSize = 0;
+};
+
+// Opens the event* nodes in a directory that pass the filter as EvdevSources
+// on the loop, and watches the directory with inotify, so matching devices
+// plugged in later are added too. It is the inotify source itself; removing
+// it from the loop removes its devices as well.
+class EvdevInput : public InputSource {
+public:
+    static constexpr size_t kMaxDevices = 32;
+
+    EvdevInput(InputLoop& loop, std::string directory, KeyCodeSet keyCodeSet, EvdevSource::Filter filter, bool grab);
+    ~EvdevInput() override;
+
+    // Opens the nodes present now; returns the number of devices added.
+    // Call it after adding this source to the loop.
+    size_t openDevices();
+
+    bool start() override;
+    void stop() override;
+    int readinessFd() const override { return _watchFd; }
+    bool drain(InputSink& sink) override;
+
+private:
+    bool openNode(const std::string& path);
+
+    InputLoop& _loop;
+    const std::string _directory;
+    const KeyCodeSet _keyCodeSet;
+    const EvdevSource::Filter _filter;
+    const bool _grab = false;
+    int _watchFd = -1;
+
+    // Nodes opened so far and their source ids (-1 while being added);
+    // openDevices() and drain() run on different threads
+    std::mutex _mutex;
+    std::vector<std::pair<std::string, int>> _opened;
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,341 @@
+#include "Gs1Parser.hpp"
+#include "CheckDigit.hpp"
+#include <cstdio>
+#include <ctime>
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+using F = Gs1Format;
+
+// GS1 General Specifications, section 3. Entries whose AI is longer than
+// the prefix take the remaining digit(s) as a parameter (e.g. 310n).
+constexpr std::array<Gs1AiDefinition, 85> kAiTable = {{
+    {"00", 2, 18, true, F::Numeric},    // SSCC
+    {"01", 2, 14, true, F::Numeric},    // GTIN
+    {"02", 2, 14, true, F::Numeric},    // CONTENT
+    {"10", 2, 20, false, F::Alphanumeric}, // BATCH/LOT
+    {"11", 2, 6, true, F::Date},        // PROD DATE
+    {"12", 2, 6, true, F::Date},        // DUE DATE
+    {"13", 2, 6, true, F::Date},        // PACK DATE
+    {"15", 2, 6, true, F::Date},        // BEST BEFORE
+    {"16", 2, 6, true, F::Date},        // SELL BY
+    {"17", 2, 6, true, F::Date},        // USE BY / EXPIRY
+    {"20", 2, 2, true, F::Numeric},     // VARIANT
+    {"21", 2, 20, false, F::Alphanumeric}, // SERIAL
+    {"22", 2, 20, false, F::Alphanumeric}, // CPV
+    {"235", 3, 28, false, F::Alphanumeric},
+    {"240", 3, 30, false, F::Alphanumeric},
+    {"241", 3, 30, false, F::Alphanumeric},
+    {"242", 3, 6, false, F::Numeric},
+    {"243", 3, 20, false, F::Alphanumeric},
+    {"250", 3, 30, false, F::Alphanumeric},
+    {"251", 3, 30, false, F::Alphanumeric},
+    {"253", 3, 30, false, F::Alphanumeric},
+    {"254", 3, 20, false, F::Alphanumeric},
+    {"255", 3, 25, false, F::Numeric},
+    {"30", 2, 8, false, F::Count},      // VAR. COUNT
+    {"31", 4, 6, true, F::Decimal},     // trade measures (net weight, length...)
+    {"32", 4, 6, true, F::Decimal},
+    {"33", 4, 6, true, F::Decimal},     // logistic measures
+    {"34", 4, 6, true, F::Decimal},
+    {"35", 4, 6, true, F::Decimal},
+    {"36", 4, 6, true, F::Decimal},
+    {"37", 2, 8, false, F::Count},      // COUNT
+    {"390", 4, 15, false, F::Decimal},  // AMOUNT
+    {"391", 4, 18, false, F::CurrencyDecimal},
+    {"392", 4, 15, false, F::Decimal},  // PRICE
+    {"393", 4, 18, false, F::CurrencyDecimal},
+    {"394", 4, 4, true, F::Decimal},
+    {"395", 4, 6, true, F::Decimal},
+    {"400", 3, 30, false, F::Alphanumeric}, // ORDER NUMBER
+    {"401", 3, 30, false, F::Alphanumeric},
+    {"402", 3, 17, true, F::Numeric},
+    {"403", 3, 30, false, F::Alphanumeric},
+    {"41", 3, 13, true, F::Numeric},    // GLNs (410-417)
+    {"420", 3, 20, false, F::Alphanumeric}, // SHIP TO POST
+    {"421", 3, 12, false, F::Alphanumeric},
+    {"422", 3, 3, true, F::Numeric},
+    {"423", 3, 15, false, F::Numeric},
+    {"424", 3, 3, true, F::Numeric},
+    {"425", 3, 15, false, F::Numeric},
+    {"426", 3, 3, true, F::Numeric},
+    {"427", 3, 3, false, F::Alphanumeric},
+    {"7001", 4, 13, true, F::Numeric},
+    {"7002", 4, 30, false, F::Alphanumeric},
+    {"7003", 4, 10, true, F::Numeric},  // EXPIRY TIME (YYMMDDhhmm)
+    {"7004", 4, 4, false, F::Numeric},
+    {"7005", 4, 12, false, F::Alphanumeric},
+    {"7006", 4, 6, true, F::Date},      // FIRST FREEZE DATE
+    {"7007", 4, 12, false, F::Numeric},
+    {"7008", 4, 3, false, F::Alphanumeric},
+    {"7009", 4, 10, false, F::Alphanumeric},
+    {"7010", 4, 2, false, F::Alphanumeric},
+    {"702", 4, 30, false, F::Alphanumeric},
+    {"8001", 4, 14, true, F::Numeric},
+    {"8002", 4, 20, false, F::Alphanumeric},
+    {"8003", 4, 30, false, F::Alphanumeric},
+    {"8004", 4, 30, false, F::Alphanumeric},
+    {"8005", 4, 6, true, F::Numeric},
+    {"8006", 4, 18, true, F::Numeric},
+    {"8007", 4, 34, false, F::Alphanumeric},
+    {"8008", 4, 12, false, F::Numeric},
+    {"8009", 4, 50, false, F::Alphanumeric},
+    {"8010", 4, 30, false, F::Alphanumeric},
+    {"8011", 4, 12, false, F::Numeric},
+    {"8012", 4, 20, false, F::Alphanumeric},
+    {"8013", 4, 25, false, F::Alphanumeric},
+    {"8017", 4, 18, true, F::Numeric},
+    {"8018", 4, 18, true, F::Numeric},
+    {"8019", 4, 10, false, F::Numeric},
+    {"8020", 4, 25, false, F::Alphanumeric},
+    {"8026", 4, 18, true, F::Numeric},
+    {"8110", 4, 70, false, F::Alphanumeric},
+    {"8111", 4, 4, true, F::Numeric},
+    {"8112", 4, 70, false, F::Alphanumeric},
+    {"8200", 4, 70, false, F::Alphanumeric},
+    {"90", 2, 30, false, F::Alphanumeric}, // mutually agreed
+    {"9", 2, 90, false, F::Alphanumeric},  // company internal (91-99)
+}};
+
+constexpr bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool allDigits(std::string_view s) {
+    for (char c : s) {
+        if (!isDigit(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool validTable() {
+    for (const Gs1AiDefinition& definition : kAiTable) {
+        if (definition.prefix.empty() || definition.aiLength < definition.prefix.size() ||
+            definition.aiLength > 4 || !allDigits(definition.prefix)) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(validTable(), "malformed GS1 AI table");
+
+bool validCharacters(std::string_view value, Gs1Format format) {
+    if (format == Gs1Format::Alphanumeric) {
+        for (char c : value) {
+            if (static_cast<unsigned char>(c) < 0x21 || static_cast<unsigned char>(c) > 0x7E) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return allDigits(value);
+}
+
+// AIM symbology identifiers that announce GS1 data
+std::optional<std::string_view> stripSymbologyId(std::string_view input) {
+    if (input.empty() || input[0] != ']') {
+        return input;
+    }
+    if (input.size() < 3) {
+        return std::nullopt;
+    }
+    std::string_view id = input.substr(0, 3);
+    if (id == "]C1" || id == "]e0" || id == "]e1" || id == "]d2" || id == "]Q3" || id == "]J1") {
+        return input.substr(3);
+    }
+    return std::nullopt;
+}
+
+int parseDigits(std::string_view digits) {
+    int value = 0;
+    for (char c : digits) {
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+int daysInMonth(int year, int month) {
+    static constexpr int kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)) {
+        return 29;
+    }
+    return kDays[month - 1];
+}
+
+int currentUtcYear() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+#if defined(_WIN32)
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    return utc.tm_year + 1900;
+}
+
+// Whether unmarked data starts with a shape no plain code is likely to have:
+// a fixed-length SSCC or GTIN with a valid check digit
+bool isLeadingGtinOrSscc(const Gs1Field& field) {
+    if (field.ai == "00") {
+        return checkdigit::gs1Mod10<18>(field.value.data());
+    }
+    if (field.ai == "01" || field.ai == "02") {
+        return checkdigit::gs1Mod10<14>(field.value.data());
+    }
+    return false;
+}
+
+} // namespace
+
+const Gs1AiDefinition* findGs1Ai(std::string_view data) {
+    const Gs1AiDefinition* best = nullptr;
+    for (const Gs1AiDefinition& definition : kAiTable) {
+        if (data.substr(0, definition.prefix.size()) == definition.prefix &&
+            (best == nullptr || definition.prefix.size() > best->prefix.size())) {
+            best = &definition;
+        }
+    }
+    return best;
+}
+
+bool parseGs1(std::string_view input, Gs1Fields& out, bool knownGs1) {
+    out.clear();
+
+    std::optional<std::string_view> stripped = stripSymbologyId(input);
+    if (!stripped) {
+        return false;
+    }
+    std::string_view data = *stripped;
+    bool marked = knownGs1 || stripped->size() != input.size();
+    while (!data.empty() && data.front() == kGs1Separator) {
+        data.remove_prefix(1);
+        marked = true;
+    }
+    if (data.empty()) {
+        return false;
+    }
+
+    while (!data.empty()) {
+        const Gs1AiDefinition* definition = findGs1Ai(data);
+        if (definition == nullptr || data.size() <= definition->aiLength) {
+            return false;
+        }
+        std::string_view ai = data.substr(0, definition->aiLength);
+        if (!allDigits(ai)) {
+            return false;
+        }
+        data.remove_prefix(definition->aiLength);
+
+        std::string_view value;
+        if (definition->fixed) {
+            if (data.size() < definition->maxLength) {
+                return false;
+            }
+            value = data.substr(0, definition->maxLength);
+            data.remove_prefix(definition->maxLength);
+            // Only predefined-length AIs (00-41) may omit the FNC1 after them
+            if (!data.empty() && data.front() == kGs1Separator) {
+                data.remove_prefix(1);
+            }
+        } else {
+            size_t end = data.find(kGs1Separator);
+            value = data.substr(0, end);
+            if (value.empty() || value.size() > definition->maxLength) {
+                return false;
+            }
+            data.remove_prefix(end == std::string_view::npos ? data.size() : end + 1);
+        }
+
+        if (!validCharacters(value, definition->format) || !out.push({ai, value, definition})) {
+            return false;
+        }
+    }
+    return marked || isLeadingGtinOrSscc(*out.begin());
+}
+
+std::optional<double> gs1NumericValue(const Gs1Field& field) {
+    if (field.definition == nullptr) {
+        return std::nullopt;
+    }
+    std::string_view digits = field.value;
+    switch (field.definition->format) {
+        case Gs1Format::CurrencyDecimal:
+            if (digits.size() <= 3) {
+                return std::nullopt;
+            }
+            digits.remove_prefix(3);
+            [[fallthrough]];
+        case Gs1Format::Count:
+        case Gs1Format::Decimal: {
+            double value = 0.0;
+            for (char c : digits) {
+                value = value * 10.0 + (c - '0');
+            }
+            int decimals = field.definition->format == Gs1Format::Count ? 0 : field.ai.back() - '0';
+            for (int i = 0; i < decimals; i++) {
+                value /= 10.0;
+            }
+            return value;
+        }
+        default:
+            return std::nullopt;
+    }
+}
+
+std::optional<std::string> gs1Date(std::string_view yymmdd, int currentYear) {
+    if (yymmdd.size() != 6 || !allDigits(yymmdd)) {
+        return std::nullopt;
+    }
+    const int yy = parseDigits(yymmdd.substr(0, 2));
+    const int month = parseDigits(yymmdd.substr(2, 2));
+    int day = parseDigits(yymmdd.substr(4, 2));
+
+    // GS1 GenSpecs 7.12: pick the century that puts the year within
+    // 49 years in the future / 50 years in the past
+    int year = currentYear - currentYear % 100 + yy;
+    const int difference = yy - currentYear % 100;
+    if (difference >= 51) {
+        year -= 100;
+    } else if (difference <= -50) {
+        year += 100;
+    }
+
+    if (month < 1 || month > 12) {
+        return std::nullopt;
+    }
+    const int lastDay = daysInMonth(year, month);
+    if (day == 0) {
+        day = lastDay;
+    } else if (day > lastDay) {
+        return std::nullopt;
+    }
+
+    char iso[11];
+    std::snprintf(iso, sizeof(iso), "%04d-%02d-%02d", year, month, day);
+    return std::string(iso, 10);
+}
+
+std::optional<std::vector<Gs1Element>> parseGs1Elements(std::string_view input, bool knownGs1) {
+    Gs1Fields fields;
+    if (!parseGs1(input, fields, knownGs1)) {
+        return std::nullopt;
+    }
+
+    const int currentYear = currentUtcYear();
+    std::vector<Gs1Element> elements;
+    elements.reserve(fields.size());
+    for (const Gs1Field& field : fields) {
+        std::optional<std::string> date;
+        if (field.definition->format == Gs1Format::Date) {
+            date = gs1Date(field.value, currentYear);
+        }
+        elements.emplace_back(std::string(field.ai), std::string(field.value), gs1NumericValue(field), date);
+    }
+    return elements;
+}
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Gs1Element.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+// FNC1 as transmitted by keyboard-wedge scanners (ASCII Group Separator)
+constexpr char kGs1Separator = '\x1D';
+
+enum class Gs1Format : uint8_t {
+    Numeric,         // identifiers (GTIN, SSCC, GLN) - digits, no numeric value
+    Count,           // quantities (30, 37)
+    Alphanumeric,
+    Date,            // YYMMDD
+    Decimal,         // last AI digit is the number of decimal places
+    CurrencyDecimal  // ISO 4217 code followed by a Decimal amount
+};
+
+struct Gs1AiDefinition {
+    std::string_view prefix; // digits that identify the AI
+    uint8_t aiLength;        // total AI digits (longer than prefix for e.g. 310n)
+    uint8_t maxLength;       // data length; exact when fixed
+    bool fixed;
+    Gs1Format format;
+};
+
+// One element of a GS1 element string, viewing into the scanned buffer
+struct Gs1Field {
+    std::string_view ai;
+    std::string_view value;
+    const Gs1AiDefinition* definition = nullptr;
+};
+
+// Fixed-capacity list of parsed fields so parsing never allocates
+class Gs1Fields {
+public:
+    static constexpr size_t kCapacity = 24;
+
+    bool push(const Gs1Field& field) {
+        if (_size == kCapacity) {
+            return false;
+        }
+        _fields[_size++] = field;
+        return true;
+    }
+    void clear() { _size = 0; }
+
+    const Gs1Field* begin() const { return _fields.data(); }
+    const Gs1Field* end() const { return _fields.data() + _size; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+private:
+    std::array<Gs1Field, kCapacity> _fields;
+    size_t _size = 0;
+};
+
+// Definition of the AI at the start of data, or nullptr if unknown
+const Gs1AiDefinition* findGs1Ai(std::string_view data);
+
+// Parses a GS1 element string (optionally prefixed with a GS1 AIM symbology
+// identifier or FNC1). Returns false unless the whole input is valid.
+//
+// Keyboard-wedge scanners usually send neither marker, and most plain codes
+// also read as some AI string ("4006381333931" as AI 400). Unmarked input
+// therefore only counts as GS1 if it starts with AI 00, 01 or 02 and a valid
+// check digit; pass knownGs1 when the symbology is known from elsewhere.
+bool parseGs1(std::string_view input, Gs1Fields& out, bool knownGs1 = false);
+
+// Decoded number for Count/Decimal/CurrencyDecimal fields
+std::optional<double> gs1NumericValue(const Gs1Field& field);
+
+// ISO date (YYYY-MM-DD) for a YYMMDD value, using the GS1 century rule.
+// Day 00 means the last day of the month.
+std::optional<std::string> gs1Date(std::string_view yymmdd, int currentYear);
+
+// Parses input and converts it to the JS-facing elements (nullopt if not GS1)
+std::optional<std::vector<Gs1Element>> parseGs1Elements(std::string_view input, bool knownGs1 = false);
+
+} // namespace margelo::nitro::externalscanner
@@ -1,38 +1,75 @@
 #include "HybridExternalScanner.hpp"
+#include "CheckDigit.hpp"
+#include "Gs1Parser.hpp"
+#include "ScannerLog.hpp"
 #include <algorithm>
-#include <iostream>
 
-// Debug logging macro
-#define ES_CPP_LOG(msg) std::cout << "[ExternalScanner C++] " << msg << std::endl
+#define ES_LOG_TAG "ExternalScanner C++"
 
 namespace margelo::nitro::externalscanner {
 
 HybridExternalScanner::HybridExternalScanner()
     : HybridObject(TAG), HybridExternalScannerSpec() {
-    _lastKeyTime = std::chrono::steady_clock::now();
-    ES_CPP_LOG("Constructor called");
+    _pendingScans.reserve(kMaxBatchSize);
+    _spareResults.reserve(kMaxBatchSize);
+    _outbox.reserve(2 * kMaxBatchSize);
+    _inFlight.reserve(2 * kMaxBatchSize);
+    _batch.reserve(kMaxBatchSize);
+    _batchFlushTimer = _deadlines.addTimer([this]() {
+        {
+            std::lock_guard<std::mutex> lock(_bufferMutex);
+            flushPendingScans();
+        }
+        deliverCallbacks();
+    });
+    _journalSyncTimer = _deadlines.addTimer([this]() {
+        std::shared_ptr<ScanJournal> journal;
+        {
+            std::lock_guard<std::mutex> lock(_bufferMutex);
+            journal = _journal;
+        }
+        if (journal) {
+            journal->sync();
+        }
+    });
+    _platformKeys = std::make_shared<PlatformKeySource>([this](PlatformKeySource&) { drainPlatformKeys(); });
+    _inputLoop = InputLoop::start(*this);
+    if (_inputLoop && _inputLoop->add(_platformKeys) < 0) {
+        _inputLoop.reset();
+    }
+    if (!_inputLoop) {
+        ES_LOGE("Constructor: No input loop, keys are processed on the input thread");
+        _threadedProcessing = false;
+    }
+    ES_LOGD("Constructor called");
 }
 
 HybridExternalScanner::~HybridExternalScanner() {
-    ES_CPP_LOG("Destructor called");
+    ES_LOGD("Destructor called");
+    // The loop thread calls into this object
+    _inputLoop.reset();
+    _deadlines.stop();
     stopScanning();
 }
 
 bool HybridExternalScanner::hasExternalScanner() {
-    std::lock_guard<std::mutex> lock(_devicesMutex);
-    bool has = !_connectedDevices.empty();
-    ES_CPP_LOG("hasExternalScanner: " << (has ? "true" : "false"));
+    bool has = _devices.hasDevices();
+    ES_LOGT("hasExternalScanner: " << (has ? "true" : "false"));
     return has;
 }
 
 std::vector<DeviceInfo> HybridExternalScanner::getConnectedDevices() {
-    std::lock_guard<std::mutex> lock(_devicesMutex);
-    ES_CPP_LOG("getConnectedDevices: " << _connectedDevices.size() << " devices");
-    return _connectedDevices;
+    std::shared_ptr<const DeviceSnapshot> snapshot = _devices.snapshot();
+    ES_LOGT("getConnectedDevices: " << snapshot->devices.size() << " devices");
+    return snapshot->devices;
+}
+
+double HybridExternalScanner::getDeviceGeneration() {
+    return static_cast<double>(_devices.generation());
 }
 
 void HybridExternalScanner::onScannerConnectionChanged(const std::function<void(bool)>& callback) {
-    ES_CPP_LOG("onScannerConnectionChanged: callback registered");
+    ES_LOGD("onScannerConnectionChanged: callback registered");
     _connectionCallback = callback;
 }
 
@@ -40,178 +77,1231 @@ void HybridExternalScanner::startScanning(
     const std::function<void(const ScanResult&)>& onScan,
     const std::optional<std::function<void(const std::string&, double)>>& onChar
 ) {
-    ES_CPP_LOG("startScanning called");
-    _onScanCallback = onScan;
-    _onCharCallback = onChar;
+    ES_LOGD("startScanning called");
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        // Batched scans of the previous session go to its callback
+        flushPendingScans();
+        auto callbacks = std::make_shared<ScanCallbacks>();
+        callbacks->onScan = onScan;
+        if (!onScan && _callbacks) {
+            // A per-scan callback switches back from batched delivery
+            callbacks->onScans = _callbacks->onScans;
+        }
+        callbacks->onChar = onChar.value_or(nullptr);
+        _callbacks = std::move(callbacks);
+        clearBuffer();
+        // Discard keys left over from a previous session
+        KeyEvent stale;
+        while (_platformKeys->pop(stale)) {}
+    }
+    deliverCallbacks();
     _isScanning = true;
-    clearBuffer();
-    ES_CPP_LOG("startScanning: _isScanning = true, callback set: " << (onScan ? "yes" : "no"));
+    ES_TRACE(ScanningStarted, 0, 0);
+    ES_LOGD("startScanning: _isScanning = true, callback set: " << (onScan ? "yes" : "no"));
+}
+
+void HybridExternalScanner::startScanningBatched(
+    const std::function<void(const std::vector<ScanResult>&)>& onScans,
+    double maxLatencyMs
+) {
+    ES_LOGD("startScanningBatched called, maxLatencyMs=" << maxLatencyMs);
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        flushPendingScans();
+        auto callbacks = std::make_shared<ScanCallbacks>();
+        callbacks->onScans = onScans;
+        _callbacks = std::move(callbacks);
+        _batchLatency = std::max(0.0, maxLatencyMs);
+    }
+    deliverCallbacks();
+    // Virtual, so platform subclasses start intercepting keys as usual
+    startScanning(nullptr, std::nullopt);
 }
 
 void HybridExternalScanner::stopScanning() {
-    ES_CPP_LOG("stopScanning called");
+    ES_LOGD("stopScanning called");
     _isScanning = false;
-    _onScanCallback = nullptr;
-    _onCharCallback = std::nullopt;
-    clearBuffer();
+    ES_TRACE(ScanningStopped, 0, 0);
+    {
+        std::unique_lock<std::mutex> lock(_bufferMutex);
+        // Completed scans still waiting for a batch flush are delivered, not lost
+        flushPendingScans();
+        _callbacks = nullptr;
+        clearBuffer();
+        // No callback runs once stopScanning() returns, unless it was called from one
+        _deliveryDone.wait(lock, [this] { return !_delivering || _deliveryThread == std::this_thread::get_id(); });
+    }
+    deliverCallbacks();
 }
 
 bool HybridExternalScanner::isScanning() {
     bool scanning = _isScanning.load();
-    ES_CPP_LOG("isScanning: " << (scanning ? "true" : "false"));
+    ES_LOGT("isScanning: " << (scanning ? "true" : "false"));
     return scanning;
 }
 
 void HybridExternalScanner::setScanTimeout(double timeout) {
-    ES_CPP_LOG("setScanTimeout: " << timeout);
+    ES_LOGD("setScanTimeout: " << timeout);
+    std::lock_guard<std::mutex> lock(_bufferMutex);
     _scanTimeout = timeout;
+    for (ScanAssembler& assembler : _assemblers) {
+        assembler.timeout = _adaptiveTimeout ? assembler.timing.learnedTimeout(timeout) : timeout;
+    }
 }
 
 void HybridExternalScanner::setMinScanLength(double length) {
-    ES_CPP_LOG("setMinScanLength: " << length);
+    ES_LOGD("setMinScanLength: " << length);
     _minScanLength = length;
 }
 
-void HybridExternalScanner::onKeyEvent(int keyCode, int action, const std::string& characters, int deviceId) {
-    ES_CPP_LOG("onKeyEvent: keyCode=" << keyCode << ", action=" << action << ", chars='" << characters << "', deviceId=" << deviceId);
+void HybridExternalScanner::setThreadedProcessing(bool enabled) {
+    ES_LOGD("setThreadedProcessing: " << (enabled ? "true" : "false"));
+    if (enabled && !_inputLoop) {
+        ES_LOGW("setThreadedProcessing: No input loop, staying on the input thread");
+        return;
+    }
+    if (_threadedProcessing.exchange(enabled) == enabled || enabled) {
+        return;
+    }
+    // Keys already queued go before the ones now processed inline
+    drainPlatformKeys();
+}
+
+void HybridExternalScanner::setTraceEnabled(bool enabled) {
+    ES_LOGD("setTraceEnabled: " << (enabled ? "true" : "false"));
+    ScanTrace::setEnabled(enabled);
+}
+
+std::string HybridExternalScanner::dumpTrace() {
+    return ScanTrace::dump();
+}
+
+void HybridExternalScanner::setAdaptiveTimeout(bool enabled) {
+    ES_LOGD("setAdaptiveTimeout: " << (enabled ? "true" : "false"));
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _adaptiveTimeout = enabled;
+    for (ScanAssembler& assembler : _assemblers) {
+        assembler.timeout = enabled ? assembler.timing.learnedTimeout(_scanTimeout) : _scanTimeout;
+    }
+}
+
+std::vector<DeviceTiming> HybridExternalScanner::getLearnedTimeouts() {
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    std::vector<DeviceTiming> timings;
+    timings.reserve(_assemblers.size());
+    for (const ScanAssembler& assembler : _assemblers) {
+        const KeyTimingStats& timing = assembler.timing;
+        timings.emplace_back(static_cast<double>(assembler.deviceId),
+                             timing.learnedTimeout(_scanTimeout),
+                             static_cast<double>(timing.sampleCount()),
+                             timing.percentile(0.5),
+                             timing.percentile(0.99));
+    }
+    return timings;
+}
+
+void HybridExternalScanner::setGs1Parsing(bool enabled) {
+    ES_LOGD("setGs1Parsing: " << (enabled ? "true" : "false"));
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _gs1Parsing = enabled;
+}
+
+void HybridExternalScanner::setValidationPolicy(ValidationPolicy policy) {
+    ES_LOGD("setValidationPolicy: " << static_cast<int>(policy));
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _validationPolicy = policy;
+}
+
+void HybridExternalScanner::setDuplicateFilter(double windowMs, DedupScope scope) {
+    ES_LOGD("setDuplicateFilter: windowMs=" << windowMs << ", scope=" << static_cast<int>(scope));
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _dedupWindow = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(std::max(windowMs, 0.0)));
+    _dedupScope = scope;
+    _dedupCache.clear();
+}
+
+double HybridExternalScanner::getSuppressedDuplicateCount() {
+    return static_cast<double>(_stats.get(StatCounter::ScansDuplicate));
+}
+
+bool HybridExternalScanner::loadCatalog(const std::string& path) {
+    ES_LOGD("loadCatalog: " << path);
+    // Map outside the lock; the old catalog is unmapped once its last user is done
+    std::shared_ptr<const ProductCatalog> catalog = ProductCatalog::open(path);
+    if (!catalog) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _catalog = std::move(catalog);
+    return true;
+}
+
+void HybridExternalScanner::unloadCatalog() {
+    ES_LOGD("unloadCatalog");
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _catalog.reset();
+}
+
+std::optional<std::string> HybridExternalScanner::lookupCatalog(const std::string& code) {
+    std::shared_ptr<const ProductCatalog> catalog;
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        catalog = _catalog;
+    }
+    if (!catalog) {
+        return std::nullopt;
+    }
+    std::optional<std::string_view> record = catalog->lookup(code);
+    if (!record) {
+        return std::nullopt;
+    }
+    return std::string(*record);
+}
+
+bool HybridExternalScanner::setScanRoutes(const std::vector<ScanRoute>& routes, bool dropUnmatched) {
+    ES_LOGD("setScanRoutes: " << routes.size() << " routes, dropUnmatched=" << (dropUnmatched ? "true" : "false"));
+    std::shared_ptr<const ScanRouter> router;
+    if (!routes.empty()) {
+        std::vector<RouteRule> rules;
+        rules.reserve(routes.size());
+        for (const ScanRoute& route : routes) {
+            RouteRule rule;
+            rule.id = route.id;
+            rule.prefix = route.prefix.value_or("");
+            rule.pattern = route.pattern.value_or("");
+            rule.minLength = static_cast<size_t>(std::max(route.minLength.value_or(0.0), 0.0));
+            if (route.maxLength.has_value() && route.maxLength.value() >= 0.0) {
+                rule.maxLength = static_cast<size_t>(route.maxLength.value());
+            }
+            rules.push_back(std::move(rule));
+        }
+        // Compiling may take a moment for large rule sets; keep it outside the lock
+        std::string error;
+        router = ScanRouter::compile(rules, error);
+        if (!router) {
+            ES_LOGE("setScanRoutes: " << error);
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _router = std::move(router);
+    _dropUnrouted = dropUnmatched && _router != nullptr;
+    return true;
+}
+
+bool HybridExternalScanner::setScanFormat(const ScanFormat& format) {
+    ScanFormatConfig config;
+    config.prefix = format.prefix.value_or("");
+    config.suffix = format.suffix.value_or("");
+    config.aimIdentifiers = format.aimIdentifiers.value_or(false);
+    config.separators = format.separators.value_or("");
+    ES_LOGD("setScanFormat: prefix=" << config.prefix.size() << " bytes, suffix=" << config.suffix.size()
+            << " bytes, aimIdentifiers=" << (config.aimIdentifiers ? "true" : "false")
+            << ", separators=" << config.separators.size());
+    std::shared_ptr<const ScanSegmenter> segmenter;
+    if (!config.prefix.empty() || !config.suffix.empty() || config.aimIdentifiers || !config.separators.empty()) {
+        std::string error;
+        segmenter = ScanSegmenter::create(config, error);
+        if (!segmenter) {
+            ES_LOGE("setScanFormat: " << error);
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _segmenter = std::move(segmenter);
+    return true;
+}
+
+bool HybridExternalScanner::openJournal(const std::string& directory, FsyncPolicy fsyncPolicy, double syncIntervalMs) {
+    ES_LOGD("openJournal: " << directory << ", syncIntervalMs=" << syncIntervalMs);
+    // Recovery scans the last segment; keep it outside the lock
+    std::shared_ptr<ScanJournal> journal = ScanJournal::open(directory);
+    if (!journal) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _journal = std::move(journal);
+    _journalSyncPolicy = fsyncPolicy;
+    _journalSyncInterval = std::max(syncIntervalMs, 1.0);
+    return true;
+}
+
+void HybridExternalScanner::closeJournal() {
+    ES_LOGD("closeJournal");
+    std::shared_ptr<ScanJournal> journal;
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        journal = std::move(_journal);
+        _deadlines.cancel(_journalSyncTimer);
+    }
+    if (journal) {
+        journal->sync();
+    }
+}
+
+std::vector<ScanResult> HybridExternalScanner::readJournal(double afterSequence, double limit) {
+    std::shared_ptr<ScanJournal> journal;
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        journal = _journal;
+    }
+    std::vector<ScanResult> results;
+    if (!journal || limit < 1.0) {
+        return results;
+    }
+    std::vector<JournalRecord> records = journal->read(static_cast<uint64_t>(std::max(afterSequence, 0.0)),
+                                                       static_cast<size_t>(limit));
+    results.reserve(records.size());
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    for (JournalRecord& record : records) {
+        // Replayed scans are re-enriched rather than stored with their extras
+        ScanResult result;
+        result.code = std::move(record.code);
+        result.timestamp = record.timestamp;
+        result.deviceId = static_cast<double>(record.deviceId);
+        result.sequence = static_cast<double>(record.sequence);
+        enrichScan(result);
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+void HybridExternalScanner::acknowledgeScans(double sequence) {
+    std::shared_ptr<ScanJournal> journal;
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        journal = _journal;
+    }
+    if (journal && sequence >= 1.0) {
+        journal->acknowledge(static_cast<uint64_t>(sequence));
+    }
+}
+
+namespace {
+
+StageLatency toStageLatency(const LatencyHistogram& histogram) {
+    const LatencyHistogram::Summary summary = histogram.summarize();
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    return StageLatency(static_cast<double>(summary.count), summary.mean / 1000.0, us(summary.p50), us(summary.p90),
+                        us(summary.p99), us(summary.p999), us(summary.max));
+}
+
+} // namespace
+
+ScannerStats HybridExternalScanner::getStats() {
+    auto counter = [this](StatCounter counter) { return static_cast<double>(_stats.get(counter)); };
+    return ScannerStats(counter(StatCounter::KeysReceived),
+                        counter(StatCounter::KeysIgnored),
+                        counter(StatCounter::KeysDropped),
+                        counter(StatCounter::ScansEmitted),
+                        counter(StatCounter::ScansTooShort),
+                        counter(StatCounter::ScansTimedOut),
+                        counter(StatCounter::ScansInvalid),
+                        counter(StatCounter::ScansDuplicate),
+                        counter(StatCounter::ScansUnrouted),
+                        counter(StatCounter::ScansOverflowed),
+                        toStageLatency(_stats.stage(PipelineStage::KeyIngest)),
+                        toStageLatency(_stats.stage(PipelineStage::Assembly)),
+                        toStageLatency(_stats.stage(PipelineStage::Dispatch)),
+                        toStageLatency(_stats.stage(PipelineStage::Callback)));
+}
+
+void HybridExternalScanner::resetStats() {
+    ES_LOGD("resetStats");
+    _stats.reset();
+}
+
+bool HybridExternalScanner::startKeyTrace(const std::string& path) {
+    ES_LOGD("startKeyTrace: " << path);
+    std::unique_ptr<KeyTraceWriter> writer =
+        KeyTraceWriter::open(path, _clock->now().time_since_epoch().count(), _clock->wallTimeMs());
+    if (!writer) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_keyTraceMutex);
+    if (_keyTrace) {
+        _keyTrace->close();
+    }
+    _keyTrace = std::move(writer);
+    _recordingKeys = true;
+    return true;
+}
+
+void HybridExternalScanner::stopKeyTrace() {
+    ES_LOGD("stopKeyTrace");
+    std::lock_guard<std::mutex> lock(_keyTraceMutex);
+    _recordingKeys = false;
+    if (_keyTrace && !_keyTrace->close()) {
+        ES_LOGE("stopKeyTrace: Key trace could not be written completely");
+    }
+    _keyTrace.reset();
+}
+
+void HybridExternalScanner::setMaxScanLength(double length, ScanOverflowPolicy overflow) {
+    ES_LOGD("setMaxScanLength: " << length << ", overflow=" << static_cast<int>(overflow));
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _maxScanLength = static_cast<size_t>(std::clamp(length, 1.0, static_cast<double>(ScanBuffer::kCapacity)));
+    _overflowPolicy = overflow;
+}
+
+void HybridExternalScanner::setKeyboardLayout(KeyboardLayout layout) {
+    ES_LOGD("setKeyboardLayout: " << static_cast<int>(layout));
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    switch (layout) {
+        case KeyboardLayout::DE:
+            _keymapLayout = KeymapLayout::German;
+            break;
+        case KeyboardLayout::FR:
+            _keymapLayout = KeymapLayout::French;
+            break;
+        case KeyboardLayout::US:
+            _keymapLayout = KeymapLayout::Us;
+            break;
+        case KeyboardLayout::PLATFORM:
+        default:
+            _keymapLayout = KeymapLayout::Platform;
+            break;
+    }
+}
+
+double HybridExternalScanner::startEvdevInput(const EvdevInputOptions& options) {
+    ES_LOGD("startEvdevInput called");
+    stopEvdevInput();
+    if (!_inputLoop) {
+        return -1;
+    }
+
+    const int vendorId = static_cast<int>(options.vendorId.value_or(0.0));
+    const int productId = static_cast<int>(options.productId.value_or(0.0));
+    EvdevSource::Filter filter = [this, vendorId, productId](const EvdevDevice& device) {
+        if (!device.hasKeyboard) {
+            return false;
+        }
+        if (vendorId > 0) {
+            return device.vendorId == vendorId && (productId <= 0 || device.productId == productId);
+        }
+        // Without explicit ids, pick scanners the same way as on the platform
+        return _classifier.classify(
+            InputDeviceDescriptor{device.name, device.vendorId, device.productId, device.isVirtual, device.hasKeyboard});
+    };
+    auto evdev = std::make_shared<EvdevInput>(*_inputLoop, options.directory.value_or("/dev/input"), _keyCodeSet,
+                                              std::move(filter), options.grab.value_or(false));
+    _evdevSource = addInputSource(evdev);
+    if (_evdevSource < 0) {
+        return -1;
+    }
+    return static_cast<double>(evdev->openDevices());
+}
+
+void HybridExternalScanner::stopEvdevInput() {
+    if (_evdevSource < 0) {
+        return;
+    }
+    ES_LOGD("stopEvdevInput called");
+    // Closes its devices too, reporting them disconnected
+    removeInputSource(_evdevSource);
+    _evdevSource = -1;
+}
+
+double HybridExternalScanner::openSerialInput(const std::string& path, const SerialFraming& framing, double baudRate) {
+    ES_LOGD("openSerialInput: " << path);
+    FramingConfig config;
+    config.prefix = framing.prefix.value_or("");
+    config.suffix = framing.suffix.value_or("");
+    config.lengthHeaderBytes = static_cast<size_t>(std::clamp(framing.lengthHeaderBytes.value_or(0.0), 0.0, 8.0));
+    // CR/LF end frames unless another way to end them was configured
+    const bool otherwiseFramed = !config.suffix.empty() || config.lengthHeaderBytes > 0;
+    config.terminators = framing.terminators.value_or(otherwiseFramed ? "" : "\r\n");
+
+    int deviceId = 0;
+    {
+        std::lock_guard<std::mutex> lock(_serialMutex);
+        deviceId = _nextSerialDevice++;
+    }
+    const int source =
+        addInputSource(std::make_shared<SerialSource>(path, std::move(config), static_cast<int>(baudRate), deviceId));
+    if (source < 0) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(_serialMutex);
+    _serialSources.emplace_back(deviceId, source);
+    return deviceId;
+}
+
+void HybridExternalScanner::closeSerialInput(double deviceId) {
+    ES_LOGD("closeSerialInput: " << deviceId);
+    int source = -1;
+    {
+        std::lock_guard<std::mutex> lock(_serialMutex);
+        auto it = std::find_if(_serialSources.begin(), _serialSources.end(),
+                               [deviceId](const auto& stream) { return stream.first == static_cast<int>(deviceId); });
+        if (it == _serialSources.end()) {
+            return;
+        }
+        source = it->second;
+        _serialSources.erase(it);
+    }
+    removeInputSource(source);
+}
+
+int HybridExternalScanner::addInputSource(std::shared_ptr<InputSource> source) {
+    if (!_inputLoop) {
+        ES_LOGE("addInputSource: No input loop");
+        return -1;
+    }
+    return _inputLoop->add(std::move(source));
+}
+
+void HybridExternalScanner::removeInputSource(int id) {
+    if (_inputLoop) {
+        _inputLoop->remove(id);
+    }
+}
+
+void HybridExternalScanner::recordKeyEvent(const KeyEvent& event) {
+    std::lock_guard<std::mutex> lock(_keyTraceMutex);
+    if (_keyTrace) {
+        _keyTrace->append(event);
+    }
+}
+
+void HybridExternalScanner::setClock(std::shared_ptr<ScannerClock> clock) {
+    if (_isScanning) {
+        ES_LOGE("setClock: Cannot change the clock while scanning");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _clock = clock ? std::move(clock) : std::make_shared<SteadyScannerClock>();
+    _deadlines.setManual(_clock->isManual());
+}
+
+std::optional<ScannerClock::time_point> HybridExternalScanner::nextDeadline() const {
+    return _deadlines.nextDeadline();
+}
+
+void HybridExternalScanner::fireDeadlines() {
+    _deadlines.fireDue(_clock->now());
+}
+
+void HybridExternalScanner::onKeyEvent(int keyCode, int action, std::string_view characters, int deviceId) {
+    ES_LOGT("onKeyEvent: keyCode=" << keyCode << ", action=" << action << ", chars='" << characters << "', deviceId=" << deviceId);
+
+    if (_recordingKeys.load(std::memory_order_relaxed)) {
+        recordKeyEvent(KeyEvent::make(keyCode, action, characters, deviceId, _clock->now().time_since_epoch().count()));
+    }
+
+    // action: 0 = KEY_DOWN, 1 = KEY_UP (only modifier key-ups are processed)
+    if (!isForwardedKey(keyCode, action)) {
+        ES_LOGT("onKeyEvent: Not KEY_DOWN (action=" << action << "), ignoring");
+        return;
+    }
 
     if (!_isScanning) {
-        ES_CPP_LOG("onKeyEvent: Not scanning, ignoring");
+        ES_LOGT("onKeyEvent: Not scanning, ignoring");
+        if (action == 0) {
+            _stats.increment(StatCounter::KeysIgnored);
+        }
         return;
     }
+    if (action == 0) {
+        _stats.increment(StatCounter::KeysReceived);
+    }
+
+    KeyEvent event = KeyEvent::make(keyCode, action, characters, deviceId,
+                                    _clock->now().time_since_epoch().count());
+    ES_TRACE(KeyIngested, keyCode, deviceId);
 
-    // action: 0 = KEY_DOWN, 1 = KEY_UP (we only process KEY_DOWN)
-    if (action != 0) {
-        ES_CPP_LOG("onKeyEvent: Not KEY_DOWN (action=" << action << "), ignoring");
+    if (_threadedProcessing) {
+        // Hand off to the input loop; never block the input thread
+        if (!_platformKeys->push(event)) {
+            ES_TRACE(KeyDropped, keyCode, deviceId);
+            // Overload drops keys in bursts; log once per 1024 rather than per key
+            const uint64_t dropped = _stats.increment(StatCounter::KeysDropped);
+            if (dropped % 1024 == 1) {
+                ES_LOGW("onKeyEvent: Key ring full, dropping key (" << dropped << " dropped so far)");
+            }
+            return;
+        }
+        _platformKeys->signal();
         return;
     }
 
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _lastKeyTime).count();
-    ES_CPP_LOG("onKeyEvent: elapsed since last key: " << elapsed << "ms, timeout: " << _scanTimeout << "ms");
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        processKeyEvent(event);
+    }
+    deliverCallbacks();
+}
 
-    std::lock_guard<std::mutex> lock(_bufferMutex);
+void HybridExternalScanner::onKeyEvents(const KeyEvent* events, size_t count) {
+    ES_LOGT("onKeyEvents: count=" << count);
+    if (!admitKeys(events, count)) {
+        return;
+    }
+
+    if (_threadedProcessing) {
+        bool pushed = false;
+        for (size_t i = 0; i < count; i++) {
+            const KeyEvent& event = events[i];
+            if (!isForwardedKey(event.keyCode, event.action)) {
+                continue;
+            }
+            ES_TRACE(KeyIngested, event.keyCode, event.deviceId);
+            if (!_platformKeys->push(event)) {
+                ES_TRACE(KeyDropped, event.keyCode, event.deviceId);
+                const uint64_t dropped = _stats.increment(StatCounter::KeysDropped);
+                if (dropped % 1024 == 1) {
+                    ES_LOGW("onKeyEvents: Key ring full, dropping key (" << dropped << " dropped so far)");
+                }
+                continue;
+            }
+            pushed = true;
+        }
+        if (pushed) {
+            _platformKeys->signal();
+        }
+        return;
+    }
+
+    processKeys(events, count);
+}
+
+bool HybridExternalScanner::admitKeys(const KeyEvent* events, size_t count) {
+    if (_recordingKeys.load(std::memory_order_relaxed)) {
+        for (size_t i = 0; i < count; i++) {
+            recordKeyEvent(events[i]);
+        }
+    }
+
+    const auto keyDowns = static_cast<uint64_t>(std::count_if(events, events + count, [](const KeyEvent& event) {
+        return event.action == 0;
+    }));
+    if (!_isScanning) {
+        _stats.increment(StatCounter::KeysIgnored, keyDowns);
+        return false;
+    }
+    const bool anyForwarded = keyDowns != 0 || std::any_of(events, events + count, [this](const KeyEvent& event) {
+        return isForwardedKey(event.keyCode, event.action);
+    });
+    if (!anyForwarded) {
+        return false;
+    }
+    _stats.increment(StatCounter::KeysReceived, keyDowns);
+    return true;
+}
+
+void HybridExternalScanner::processKeys(const KeyEvent* events, size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        for (size_t i = 0; i < count; i++) {
+            if (isForwardedKey(events[i].keyCode, events[i].action)) {
+                ES_TRACE(KeyIngested, events[i].keyCode, events[i].deviceId);
+                processKeyEvent(events[i]);
+            }
+        }
+    }
+    deliverCallbacks();
+}
+
+void HybridExternalScanner::onSourceKeys(const KeyEvent* events, size_t count) {
+    // Already on the loop thread, so no hand-off in either mode
+    if (admitKeys(events, count)) {
+        processKeys(events, count);
+    }
+}
+
+void HybridExternalScanner::onSourceFrame(int deviceId, std::string_view frame) {
+    onScanFrame(deviceId, frame);
+}
+
+void HybridExternalScanner::onSourceDevice(const SourceDevice& device, bool connected) {
+    if (connected) {
+        onDeviceConnected(DeviceInfo(device.deviceId, device.name, device.vendorId, device.productId, true));
+    } else {
+        onDeviceDisconnected(device.deviceId);
+    }
+}
+
+void HybridExternalScanner::onScanFrame(int deviceId, std::string_view frame) {
+    ES_LOGT("onScanFrame: deviceId=" << deviceId << ", length=" << frame.size());
+    if (!_isScanning) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        ScanAssembler* assembler = assemblerFor(deviceId);
+        if (assembler == nullptr) {
+            ES_LOGW("onScanFrame: No assembler available for deviceId=" << deviceId << ", dropping scan");
+            return;
+        }
+        // Frames are complete scans: run them through the same stages as keyed ones.
+        // They carry no event time, so they are stamped on arrival; without the
+        // stamp the slot looks least recently used and is evicted first.
+        assembler->lastKeyTime = _clock->now();
+        appendToBuffer(*assembler, frame);
+        processBuffer(*assembler);
+    }
+    deliverCallbacks();
+}
+
+void HybridExternalScanner::processKeyEvent(const KeyEvent& event) {
+    auto now = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(event.time));
+    _stats.stage(PipelineStage::KeyIngest).record(_clock->now() - now);
+
+    ScanAssembler* assembler = assemblerFor(event.deviceId);
+    if (assembler == nullptr) {
+        ES_LOGW("processKeyEvent: No assembler available for deviceId=" << event.deviceId << ", dropping key");
+        ES_TRACE(KeyDropped, event.keyCode, event.deviceId);
+        _stats.increment(StatCounter::KeysDropped);
+        return;
+    }
+
+    const uint8_t usage = Keymap::usage(_keyCodeSet, event.keyCode);
+    const bool isModifier = Keymap::updateModifiers(assembler->modifiers, usage, event.action == 0);
+    if (event.action != 0) {
+        return; // modifier key-up, only changes the state
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(now - assembler->lastKeyTime).count();
+    ES_LOGT("processKeyEvent: deviceId=" << event.deviceId << ", elapsed since last key: " << elapsed << "ms, timeout: " << assembler->timeout << "ms");
 
     // If too much time passed, clear the buffer (new scan)
-    if (elapsed > _scanTimeout && !_scanBuffer.empty()) {
-        ES_CPP_LOG("onKeyEvent: Timeout exceeded, processing buffer before new input");
-        processBuffer();
+    if (elapsed > assembler->timeout && !assembler->buffer.empty()) {
+        ES_LOGT("processKeyEvent: Timeout exceeded, processing buffer before new input");
+        ES_TRACE(ScanTimeout, assembler->buffer.size(), elapsed);
+        _stats.increment(StatCounter::ScansTimedOut);
+        processBuffer(*assembler);
     }
 
-    _lastKeyTime = now;
+    if (!assembler->afterTerminator) {
+        assembler->timing.record(elapsed);
+    }
+    assembler->lastKeyTime = now;
 
     // Check for Enter key (end of scan)
-    if (isEnterKey(keyCode)) {
-        ES_CPP_LOG("onKeyEvent: Enter key detected, processing buffer");
-        processBuffer();
+    if (Keymap::isEnter(usage)) {
+        ES_LOGT("processKeyEvent: Enter key detected, processing buffer");
+        assembler->afterTerminator = true;
+        processBuffer(*assembler);
         return;
     }
+    assembler->afterTerminator = false;
+
+    // Translate through the keyboard layout; keys it does not know keep the
+    // characters the platform sent. Until a layout is set, only keys the
+    // platform sent no characters for are translated (evdev, iOS HID).
+    std::string_view characters = event.characters();
+    char translated[4];
+    if (!isModifier && (_keymapLayout != KeymapLayout::Platform || characters.empty())) {
+        const char32_t c = Keymap::translate(_keymapLayout, usage, assembler->modifiers);
+        if (c != 0) {
+            characters = std::string_view(translated, Keymap::encodeUtf8(c, translated));
+        }
+    }
 
     // Add character to buffer
     if (!characters.empty()) {
-        _scanBuffer += characters;
-        ES_CPP_LOG("onKeyEvent: Added to buffer, current buffer: '" << _scanBuffer << "' (length: " << _scanBuffer.length() << ")");
+        if (!appendToBuffer(*assembler, characters)) {
+            ES_LOGT("processKeyEvent: Scan exceeds " << _maxScanLength << " characters, dropping key");
+            return;
+        }
+        ES_TRACE(KeyProcessed, event.keyCode, assembler->buffer.size());
+        ES_LOGT("processKeyEvent: Added to buffer, current buffer: '" << assembler->buffer.view() << "' (length: " << assembler->buffer.size() << ")");
+
+        // Complete the scan if no further key arrives in time
+        _deadlines.arm(assembler->deadlineTimer, now + std::chrono::microseconds(static_cast<int64_t>(assembler->timeout * 1000.0)));
 
         // Notify character callback if set
-        if (_onCharCallback.has_value() && _onCharCallback.value()) {
-            ES_CPP_LOG("onKeyEvent: Calling onChar callback");
-            _onCharCallback.value()(characters, static_cast<double>(keyCode));
+        if (_callbacks && _callbacks->onChar) {
+            ES_LOGT("processKeyEvent: Queueing onChar callback");
+            Delivery& delivery = queueDelivery(Delivery::Kind::Char);
+            delivery.characters.assign(characters);
+            delivery.keyCode = static_cast<double>(event.keyCode);
         }
     } else {
-        ES_CPP_LOG("onKeyEvent: Empty characters, not adding to buffer");
+        ES_LOGT("processKeyEvent: Empty characters, not adding to buffer");
     }
 }
 
-void HybridExternalScanner::onDeviceConnected(const DeviceInfo& device) {
-    ES_CPP_LOG("onDeviceConnected: id=" << device.id << ", name=" << device.name);
-    {
-        std::lock_guard<std::mutex> lock(_devicesMutex);
-        // Check if device already exists
-        auto it = std::find_if(_connectedDevices.begin(), _connectedDevices.end(),
-            [&device](const DeviceInfo& d) { return d.id == device.id; });
+ScanAssembler* HybridExternalScanner::assemblerFor(int deviceId) {
+    ScanAssembler* assembler = _assemblers.find(deviceId);
+    if (assembler != nullptr) {
+        return assembler;
+    }
+
+    assembler = _assemblers.insert(deviceId);
+    if (assembler == nullptr) {
+        // More devices than slots: recycle the least recently used one
+        ScanAssembler* victim = _assemblers.evictionCandidate();
+        ES_LOGW("assemblerFor: Assembler table full, evicting deviceId=" << victim->deviceId);
+        releaseAssembler(victim->deviceId);
+        assembler = _assemblers.insert(deviceId);
+    }
+
+    assembler->timeout = _scanTimeout;
+    assembler->deadlineTimer = _deadlines.addTimer([this, deviceId]() { onScanDeadline(deviceId); });
+    ES_LOGD("assemblerFor: Created assembler for deviceId=" << deviceId << ", total: " << _assemblers.size());
+    return assembler;
+}
+
+void HybridExternalScanner::releaseAssembler(int deviceId) {
+    ScanAssembler* assembler = _assemblers.find(deviceId);
+    if (assembler == nullptr) {
+        return;
+    }
+    _deadlines.removeTimer(assembler->deadlineTimer);
+    _assemblers.erase(deviceId);
+    ES_LOGD("releaseAssembler: Released assembler for deviceId=" << deviceId);
+}
 
-        if (it == _connectedDevices.end()) {
-            _connectedDevices.push_back(device);
-            ES_CPP_LOG("onDeviceConnected: Device added, total: " << _connectedDevices.size());
-        } else {
-            ES_CPP_LOG("onDeviceConnected: Device already exists");
+void HybridExternalScanner::drainPlatformKeys() {
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        KeyEvent event;
+        while (_platformKeys->pop(event)) {
+            // Keys still queued when scanning stopped go with the rest of the session
+            if (_isScanning) {
+                processKeyEvent(event);
+            }
         }
     }
+    deliverCallbacks();
+}
+
+void HybridExternalScanner::onScanDeadline(int deviceId) {
+    completeTimedOutScan(deviceId);
+    deliverCallbacks();
+}
+
+void HybridExternalScanner::completeTimedOutScan(int deviceId) {
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    ScanAssembler* assembler = _assemblers.find(deviceId);
+    if (assembler == nullptr || assembler->buffer.empty()) {
+        return;
+    }
+
+    // Keys may still be queued for the input loop; let it catch up first
+    auto now = _clock->now();
+    if (!_platformKeys->empty()) {
+        _deadlines.arm(assembler->deadlineTimer, now + std::chrono::milliseconds(1));
+        return;
+    }
+
+    auto timeout = std::chrono::microseconds(static_cast<int64_t>(assembler->timeout * 1000.0));
+    if (now - assembler->lastKeyTime < timeout) {
+        // A key arrived after the timer fired
+        _deadlines.arm(assembler->deadlineTimer, assembler->lastKeyTime + timeout);
+        return;
+    }
+
+    ES_LOGT("completeTimedOutScan: No key from deviceId=" << deviceId << " for " << assembler->timeout << "ms, completing scan");
+    ES_TRACE(ScanTimeout, assembler->buffer.size(), assembler->timeout);
+    _stats.increment(StatCounter::ScansTimedOut);
+    processBuffer(*assembler);
+}
+
+void HybridExternalScanner::onDeviceConnected(const DeviceInfo& device) {
+    ES_LOGD("onDeviceConnected: id=" << device.id << ", name=" << device.name);
+    ES_TRACE(DeviceConnected, device.id, 0);
+    if (_devices.add(device)) {
+        ES_LOGD("onDeviceConnected: Device added, generation: " << _devices.generation());
+    } else {
+        ES_LOGD("onDeviceConnected: Device already exists");
+    }
 
     if (_connectionCallback) {
-        ES_CPP_LOG("onDeviceConnected: Calling connection callback with true");
+        ES_LOGD("onDeviceConnected: Calling connection callback with true");
         _connectionCallback(true);
     }
 }
 
 void HybridExternalScanner::onDeviceDisconnected(int deviceId) {
-    ES_CPP_LOG("onDeviceDisconnected: deviceId=" << deviceId);
+    ES_LOGD("onDeviceDisconnected: deviceId=" << deviceId);
+    ES_TRACE(DeviceDisconnected, deviceId, 0);
+    if (_devices.remove(static_cast<double>(deviceId))) {
+        ES_LOGD("onDeviceDisconnected: Device removed, generation: " << _devices.generation());
+    }
     {
-        std::lock_guard<std::mutex> lock(_devicesMutex);
-        _connectedDevices.erase(
-            std::remove_if(_connectedDevices.begin(), _connectedDevices.end(),
-                [deviceId](const DeviceInfo& d) { return d.id == static_cast<double>(deviceId); }),
-            _connectedDevices.end()
-        );
-        ES_CPP_LOG("onDeviceDisconnected: Remaining devices: " << _connectedDevices.size());
+        // Drop any partial scan from the device along with its assembler
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        releaseAssembler(deviceId);
     }
 
     if (_connectionCallback) {
-        std::lock_guard<std::mutex> lock(_devicesMutex);
-        ES_CPP_LOG("onDeviceDisconnected: Calling connection callback");
-        _connectionCallback(!_connectedDevices.empty());
+        ES_LOGD("onDeviceDisconnected: Calling connection callback");
+        _connectionCallback(_devices.hasDevices());
     }
 }
 
-void HybridExternalScanner::processBuffer() {
-    ES_CPP_LOG("processBuffer: buffer='" << _scanBuffer << "', length=" << _scanBuffer.length() << ", minLength=" << _minScanLength);
+bool HybridExternalScanner::appendToBuffer(ScanAssembler& assembler, std::string_view characters) {
+    if (assembler.buffer.append(characters, _maxScanLength)) {
+        return true;
+    }
+    if (_overflowPolicy == ScanOverflowPolicy::SPLIT && !assembler.buffer.empty()) {
+        // Deliver what fits and carry on with a new scan
+        _stats.increment(StatCounter::ScansOverflowed);
+        processBuffer(assembler);
+        return assembler.buffer.append(characters, _maxScanLength);
+    }
+    if (!assembler.buffer.overflowed()) {
+        ES_LOGW("appendToBuffer: Scan from deviceId=" << assembler.deviceId << " exceeds " << _maxScanLength << " characters");
+        assembler.buffer.markOverflowed();
+    }
+    return false;
+}
 
-    if (_scanBuffer.length() >= static_cast<size_t>(_minScanLength)) {
-        if (_onScanCallback) {
-            auto now = std::chrono::system_clock::now();
-            auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now.time_since_epoch()
-            ).count();
+bool HybridExternalScanner::setDeviceRules(const std::vector<DeviceRule>& rules) {
+    ES_LOGD("setDeviceRules: " << rules.size() << " rules");
+    std::shared_ptr<const DeviceRuleTable> table;
+    if (!rules.empty()) {
+        // Out-of-range ids stay out of range, so compile() rejects them
+        auto toId = [](double value) { return static_cast<int>(std::clamp(value, -1.0, 65536.0)); };
+        std::vector<DeviceMatchRule> matchRules;
+        matchRules.reserve(rules.size());
+        for (const DeviceRule& rule : rules) {
+            DeviceMatchRule matchRule;
+            if (rule.vendorId.has_value()) {
+                matchRule.vendorId = toId(rule.vendorId.value());
+            }
+            if (rule.productIdMin.has_value() || rule.productIdMax.has_value()) {
+                // One bound alone means that exact product id
+                const double min = rule.productIdMin.value_or(rule.productIdMax.value_or(0.0));
+                const double max = rule.productIdMax.value_or(min);
+                matchRule.productIdMin = toId(min);
+                matchRule.productIdMax = toId(max);
+            }
+            matchRule.namePattern = rule.namePattern.value_or("");
+            matchRule.accept = rule.action == RuleAction::ACCEPT;
+            matchRule.priority = static_cast<int>(std::clamp(rule.priority.value_or(0.0), -1e6, 1e6));
+            matchRules.push_back(std::move(matchRule));
+        }
+        std::string error;
+        table = DeviceRuleTable::compile(matchRules, error);
+        if (!table) {
+            ES_LOGE("setDeviceRules: " << error);
+            return false;
+        }
+    }
+    // Swapped in atomically; the key path keeps using the cached verdicts
+    _classifier.setRules(std::move(table));
+    return true;
+}
 
-            ScanResult result(_scanBuffer, static_cast<double>(timestamp));
-            ES_CPP_LOG("processBuffer: Calling onScan callback with data='" << _scanBuffer << "'");
-            _onScanCallback(result);
-        } else {
-            ES_CPP_LOG("processBuffer: ERROR - No onScan callback set!");
+bool HybridExternalScanner::classifyDevice(int deviceId, const InputDeviceDescriptor& device) {
+    return _classifier.update(deviceId, device);
+}
+
+void HybridExternalScanner::forgetDeviceClassification(int deviceId) {
+    _classifier.forget(deviceId);
+}
+
+std::optional<bool> HybridExternalScanner::isScannerDevice(int deviceId) const {
+    return _classifier.cached(deviceId);
+}
+
+void HybridExternalScanner::processBuffer(ScanAssembler& assembler) {
+    const std::string_view buffer = assembler.buffer.view();
+    ES_LOGT("processBuffer: deviceId=" << assembler.deviceId << ", buffer='" << buffer << "', length=" << buffer.length() << ", minLength=" << _minScanLength);
+
+    if (assembler.buffer.overflowed()) {
+        _stats.increment(StatCounter::ScansOverflowed);
+    }
+    if (assembler.buffer.overflowed() && _overflowPolicy == ScanOverflowPolicy::DISCARD) {
+        ES_TRACE(ScanRejected, buffer.length(), _maxScanLength);
+        ES_LOGD("processBuffer: Discarding overlong scan from deviceId=" << assembler.deviceId);
+    } else if (_segmenter) {
+        ScanSegmenter::Segments segments;
+        const size_t count = _segmenter->split(buffer, segments);
+        // Nothing but framing is still a scan, just one too short
+        if (count == 0) {
+            emitScan(assembler, ScanSegment{});
+        }
+        for (size_t i = 0; i < count; i++) {
+            emitScan(assembler, segments[i]);
         }
     } else {
-        ES_CPP_LOG("processBuffer: Buffer too short (" << _scanBuffer.length() << " < " << _minScanLength << "), not calling callback");
+        emitScan(assembler, ScanSegment{buffer, {}});
+    }
+    assembler.buffer.clear();
+    _deadlines.cancel(assembler.deadlineTimer);
+
+    if (_adaptiveTimeout) {
+        assembler.timeout = assembler.timing.learnedTimeout(_scanTimeout);
     }
-    clearBuffer();
 }
 
-void HybridExternalScanner::clearBuffer() {
-    ES_CPP_LOG("clearBuffer: Clearing buffer (was: '" << _scanBuffer << "')");
-    _scanBuffer.clear();
+void HybridExternalScanner::emitScan(const ScanAssembler& assembler, const ScanSegment& segment) {
+    const std::string_view code = segment.code;
+    if (code.length() < static_cast<size_t>(_minScanLength)) {
+        ES_TRACE(ScanRejected, code.length(), _minScanLength);
+        _stats.increment(StatCounter::ScansTooShort);
+        ES_LOGT("emitScan: Code too short (" << code.length() << " < " << _minScanLength << "), not calling callback");
+        return;
+    }
+    if (!_callbacks || (!_callbacks->onScan && !_callbacks->onScans)) {
+        ES_LOGE("emitScan: ERROR - No onScan callback set!");
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const int64_t timestamp = _clock->wallTimeMs();
+    // One clock for the duplicate window, whatever the input path and its event clock
+    const ScannerClock::time_point now = _clock->now();
+
+    // Optional fields are filled in by the stages below
+    ScanResult result = takeResult();
+    result.code.assign(code);
+    result.timestamp = static_cast<double>(timestamp);
+    result.deviceId = static_cast<double>(assembler.deviceId);
+    if (!segment.symbology.empty()) {
+        result.symbology.emplace(segment.symbology);
+    }
+    if (acceptScan(assembler, code, now, result)) {
+        enrichScan(result);
+        journalScan(result);
+        ES_TRACE(ScanEmitted, code.length(), assembler.deviceId);
+        const auto ready = std::chrono::steady_clock::now();
+        _stats.stage(PipelineStage::Assembly).record(ready - start);
+        _stats.increment(StatCounter::ScansEmitted);
+        dispatchScan(std::move(result), ready);
+    } else {
+        recycleResult(std::move(result));
+    }
+}
+
+bool HybridExternalScanner::acceptScan(const ScanAssembler& assembler, std::string_view code,
+                                       ScannerClock::time_point now, ScanResult& result) {
+    if (_validationPolicy != ValidationPolicy::OFF) {
+        // The AIM symbology, when the segmenter found one, beats a guess
+        CheckDigitResult check = result.symbology ? validateAimCheckDigit(code, *result.symbology)
+                                                  : validateCheckDigit(code);
+        if (check.name != nullptr) {
+            result.valid = check.valid;
+            result.symbologyGuess = check.name;
+            if (!check.valid && _validationPolicy == ValidationPolicy::REJECT) {
+                ES_TRACE(ScanInvalid, code.length(), assembler.deviceId);
+                _stats.increment(StatCounter::ScansInvalid);
+                ES_LOGD("acceptScan: Dropping scan with bad check digit: '" << code << "'");
+                return false;
+            }
+        }
+    }
+
+    if (_router) {
+        int rule = _router->match(code);
+        if (rule >= 0) {
+            result.route = _router->ruleId(rule);
+        } else if (_dropUnrouted) {
+            ES_TRACE(ScanUnrouted, code.length(), assembler.deviceId);
+            _stats.increment(StatCounter::ScansUnrouted);
+            ES_LOGD("acceptScan: Dropping scan matching no route: '" << code << "'");
+            return false;
+        }
+    }
+
+    if (isDuplicate(assembler, code, now)) {
+        _stats.increment(StatCounter::ScansDuplicate);
+        ES_TRACE(ScanDuplicate, code.length(), assembler.deviceId);
+        ES_LOGT("acceptScan: Suppressing duplicate scan: '" << code << "'");
+        return false;
+    }
+    return true;
+}
+
+void HybridExternalScanner::enrichScan(ScanResult& result) {
+    if (_gs1Parsing) {
+        // The segmenter strips the AIM identifier, so pass on what it said:
+        // GS1 symbologies mark the data as GS1, other known ones rule it out
+        const std::string_view symbology = result.symbology ? std::string_view(*result.symbology) : std::string_view();
+        const bool gs1 = isGs1Symbology(symbology);
+        if (gs1 || !isKnownSymbology(symbology)) {
+            result.elements = parseGs1Elements(result.code, gs1);
+        }
+    }
+    if (_catalog) {
+        if (std::optional<std::string_view> record = _catalog->lookup(result.code)) {
+            result.catalogRecord = std::string(*record);
+        }
+    }
+}
+
+void HybridExternalScanner::journalScan(ScanResult& result) {
+    if (!_journal) {
+        return;
+    }
+    bool wasClean = false;
+    const uint64_t sequence = _journal->append(result.code, result.timestamp,
+                                               static_cast<int32_t>(result.deviceId), &wasClean);
+    if (sequence == 0) {
+        ES_LOGW("journalScan: Could not journal scan '" << result.code << "'");
+        return;
+    }
+    result.sequence = static_cast<double>(sequence);
+    if (_journalSyncPolicy == FsyncPolicy::ALWAYS) {
+        _journal->sync();
+    } else if (_journalSyncPolicy == FsyncPolicy::INTERVAL && wasClean) {
+        // The first unsynced scan starts the group; later ones ride along
+        _deadlines.arm(_journalSyncTimer, _clock->now() +
+                       std::chrono::microseconds(static_cast<int64_t>(_journalSyncInterval * 1000.0)));
+    }
+}
+
+bool HybridExternalScanner::isDuplicate(const ScanAssembler& assembler, std::string_view code,
+                                        ScannerClock::time_point now) {
+    if (_dedupWindow.count() <= 0) {
+        return false;
+    }
+    const int scope = _dedupScope == DedupScope::DEVICE ? assembler.deviceId : 0;
+    return _dedupCache.checkAndInsert(DedupCache::hashCode(code, scope),
+                                      now.time_since_epoch().count(),
+                                      _dedupWindow.count());
+}
+
+void HybridExternalScanner::dispatchScan(ScanResult&& result, std::chrono::steady_clock::time_point readyTime) {
+    if (!_callbacks->onScans) {
+        ES_LOGT("dispatchScan: Queueing onScan callback with data='" << result.code << "'");
+        Delivery& delivery = queueDelivery(Delivery::Kind::Scan);
+        delivery.result = std::move(result);
+        delivery.readyTime = readyTime;
+        return;
+    }
+
+    _pendingSince[_pendingScans.size()] = readyTime;
+    _pendingScans.push_back(std::move(result));
+    if (_pendingScans.size() >= kMaxBatchSize) {
+        flushPendingScans();
+    } else if (_pendingScans.size() == 1) {
+        // First scan of a batch starts the latency budget
+        _deadlines.arm(_batchFlushTimer, _clock->now() +
+                       std::chrono::microseconds(static_cast<int64_t>(_batchLatency * 1000.0)));
+    }
+}
+
+void HybridExternalScanner::flushPendingScans() {
+    _deadlines.cancel(_batchFlushTimer);
+    if (_pendingScans.empty() || !_callbacks || !_callbacks->onScans) {
+        return;
+    }
+    ES_LOGT("flushPendingScans: Queueing " << _pendingScans.size() << " scans");
+    for (size_t i = 0; i < _pendingScans.size(); i++) {
+        Delivery& delivery = queueDelivery(Delivery::Kind::BatchedScan);
+        delivery.result = std::move(_pendingScans[i]);
+        delivery.readyTime = _pendingSince[i];
+        delivery.endsBatch = i + 1 == _pendingScans.size();
+    }
+    _pendingScans.clear();
 }
 
-bool HybridExternalScanner::isEnterKey(int keyCode) {
-    // Android: KEYCODE_ENTER = 66, KEYCODE_NUMPAD_ENTER = 160
-    // iOS GCKeyCode: ReturnOrEnter = 0x28 (40), KeypadEnter = 0x58 (88)
-    bool isEnter = keyCode == 66 || keyCode == 160 || keyCode == 40 || keyCode == 88;
-    ES_CPP_LOG("isEnterKey: keyCode=" << keyCode << " -> " << (isEnter ? "true" : "false"));
-    return isEnter;
+HybridExternalScanner::Delivery& HybridExternalScanner::queueDelivery(Delivery::Kind kind) {
+    Delivery& delivery = _outbox.emplace_back();
+    delivery.kind = kind;
+    delivery.endsBatch = false;
+    delivery.callbacks = _callbacks;
+    _hasDeliveries.store(true, std::memory_order_release);
+    return delivery;
 }
 
-std::string HybridExternalScanner::keyCodeToChar(int keyCode, bool shiftPressed) {
-    // This is a fallback - platforms should provide the character directly
-    // Android keycodes for 0-9: 7-16, A-Z: 29-54
-    if (keyCode >= 7 && keyCode <= 16) {
-        return std::string(1, '0' + (keyCode - 7));
+void HybridExternalScanner::deliverCallbacks() {
+    if (!_hasDeliveries.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(_bufferMutex);
+    if (_delivering) {
+        // The delivering thread (maybe this one, in a callback) picks them up
+        return;
     }
-    if (keyCode >= 29 && keyCode <= 54) {
-        char c = 'a' + (keyCode - 29);
-        if (shiftPressed) {
-            c = std::toupper(c);
+    _delivering = true;
+    _deliveryThread = std::this_thread::get_id();
+    while (!_outbox.empty()) {
+        _inFlight.swap(_outbox);
+        _hasDeliveries.store(false, std::memory_order_relaxed);
+        lock.unlock();
+
+        size_t batchStart = 0;
+        for (size_t i = 0; i < _inFlight.size(); i++) {
+            Delivery& delivery = _inFlight[i];
+            const ScanCallbacks& callbacks = *delivery.callbacks;
+            const auto callStart = std::chrono::steady_clock::now();
+            switch (delivery.kind) {
+                case Delivery::Kind::Char:
+                    ES_LOGT("deliverCallbacks: Calling onChar callback");
+                    callbacks.onChar(delivery.characters, delivery.keyCode);
+                    break;
+
+                case Delivery::Kind::Scan:
+                    ES_LOGT("deliverCallbacks: Calling onScan callback with data='" << delivery.result.code << "'");
+                    _stats.stage(PipelineStage::Dispatch).record(callStart - delivery.readyTime);
+                    callbacks.onScan(delivery.result);
+                    _stats.stage(PipelineStage::Callback).record(std::chrono::steady_clock::now() - callStart);
+                    break;
+
+                case Delivery::Kind::BatchedScan:
+                    if (_batch.empty()) {
+                        batchStart = i;
+                    }
+                    _stats.stage(PipelineStage::Dispatch).record(callStart - delivery.readyTime);
+                    _batch.push_back(std::move(delivery.result));
+                    if (delivery.endsBatch) {
+                        ES_LOGT("deliverCallbacks: Calling onScans callback with " << _batch.size() << " scans");
+                        callbacks.onScans(_batch);
+                        _stats.stage(PipelineStage::Callback).record(std::chrono::steady_clock::now() - callStart);
+                        // Back into their deliveries, to be recycled below
+                        for (size_t k = 0; k < _batch.size(); k++) {
+                            _inFlight[batchStart + k].result = std::move(_batch[k]);
+                        }
+                        _batch.clear();
+                    }
+                    break;
+            }
+        }
+
+        lock.lock();
+        for (Delivery& delivery : _inFlight) {
+            if (delivery.kind != Delivery::Kind::Char) {
+                recycleResult(std::move(delivery.result));
+            }
+            delivery.callbacks.reset();
         }
-        return std::string(1, c);
+        _inFlight.clear();
     }
-    return "";
+    _delivering = false;
+    _deliveryThread = std::thread::id();
+    _deliveryDone.notify_all();
+}
+
+ScanResult HybridExternalScanner::takeResult() {
+    if (_spareResults.empty()) {
+        return ScanResult();
+    }
+    ScanResult result = std::move(_spareResults.back());
+    _spareResults.pop_back();
+    result.elements.reset();
+    result.valid.reset();
+    result.symbologyGuess.reset();
+    result.symbology.reset();
+    result.catalogRecord.reset();
+    result.route.reset();
+    result.sequence.reset();
+    return result;
+}
+
+void HybridExternalScanner::recycleResult(ScanResult&& result) {
+    if (_spareResults.size() < kMaxBatchSize) {
+        _spareResults.push_back(std::move(result));
+    }
+}
+
+void HybridExternalScanner::clearBuffer() {
+    ES_LOGT("clearBuffer: Clearing all device buffers");
+    for (ScanAssembler& assembler : _assemblers) {
+        assembler.buffer.clear();
+        _deadlines.cancel(assembler.deadlineTimer);
+    }
+}
+
+bool HybridExternalScanner::isForwardedKey(int keyCode, int action) const {
+    return action == 0 || Keymap::isModifier(Keymap::usage(_keyCodeSet, keyCode));
 }
 
 } // namespace margelo::nitro::externalscanner
@@ -1,14 +1,34 @@
 #pragma once
 
 #include "HybridExternalScannerSpec.hpp"
+#include "DeadlineScheduler.hpp"
+#include "DedupCache.hpp"
+#include "DeviceClassifier.hpp"
+#include "DeviceRegistry.hpp"
+#include "EvdevInput.hpp"
+#include "InputLoop.hpp"
+#include "KeyEventRing.hpp"
+#include "KeyTrace.hpp"
+#include "Keymap.hpp"
+#include "PipelineStats.hpp"
+#include "PlatformKeySource.hpp"
+#include "ProductCatalog.hpp"
+#include "ScanJournal.hpp"
+#include "ScanRouter.hpp"
+#include "ScanSegmenter.hpp"
+#include "ScanAssembler.hpp"
+#include "SerialSource.hpp"
+#include "ScannerClock.hpp"
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
 #include <chrono>
 #include <thread>
+#include <string_view>
 
 namespace margelo::nitro::externalscanner {
 
-class HybridExternalScanner : public HybridExternalScannerSpec {
+class HybridExternalScanner : public HybridExternalScannerSpec, public InputSink {
 public:
     HybridExternalScanner();
     ~HybridExternalScanner() override;
@@ -21,41 +41,223 @@ public:
         const std::function<void(const ScanResult&)>& onScan,
         const std::optional<std::function<void(const std::string&, double)>>& onChar
     ) override;
+    void startScanningBatched(
+        const std::function<void(const std::vector<ScanResult>&)>& onScans,
+        double maxLatencyMs
+    ) override;
     void stopScanning() override;
     bool isScanning() override;
     void setScanTimeout(double timeout) override;
     void setMinScanLength(double length) override;
+    void setThreadedProcessing(bool enabled) override;
+    void setTraceEnabled(bool enabled) override;
+    std::string dumpTrace() override;
+    void setAdaptiveTimeout(bool enabled) override;
+    std::vector<DeviceTiming> getLearnedTimeouts() override;
+    void setGs1Parsing(bool enabled) override;
+    void setValidationPolicy(ValidationPolicy policy) override;
+    void setDuplicateFilter(double windowMs, DedupScope scope) override;
+    double getSuppressedDuplicateCount() override;
+    bool loadCatalog(const std::string& path) override;
+    void unloadCatalog() override;
+    std::optional<std::string> lookupCatalog(const std::string& code) override;
+    bool setScanRoutes(const std::vector<ScanRoute>& routes, bool dropUnmatched) override;
+    bool setScanFormat(const ScanFormat& format) override;
+    bool openJournal(const std::string& directory, FsyncPolicy fsyncPolicy, double syncIntervalMs) override;
+    void closeJournal() override;
+    std::vector<ScanResult> readJournal(double afterSequence, double limit) override;
+    void acknowledgeScans(double sequence) override;
+    ScannerStats getStats() override;
+    void resetStats() override;
+    bool startKeyTrace(const std::string& path) override;
+    void stopKeyTrace() override;
+    void setMaxScanLength(double length, ScanOverflowPolicy overflow) override;
+    double getDeviceGeneration() override;
+    bool setDeviceRules(const std::vector<DeviceRule>& rules) override;
+    void setKeyboardLayout(KeyboardLayout layout) override;
+    double startEvdevInput(const EvdevInputOptions& options) override;
+    void stopEvdevInput() override;
+    double openSerialInput(const std::string& path, const SerialFraming& framing, double baudRate) override;
+    void closeSerialInput(double deviceId) override;
 
     // Platform-specific methods to be called from native code
-    void onKeyEvent(int keyCode, int action, const std::string& characters, int deviceId);
+    void onKeyEvent(int keyCode, int action, std::string_view characters, int deviceId);
+    // Batched ingest: events carry their own timestamps (see KeyEvent::time)
+    void onKeyEvents(const KeyEvent* events, size_t count);
+    // Byte-stream ingest: one complete, already framed scan
+    void onScanFrame(int deviceId, std::string_view frame);
+    // Native input sources (device nodes, streams, synthetic events) read on
+    // the input loop thread; see InputLoop. add returns -1 if it did not start.
+    int addInputSource(std::shared_ptr<InputSource> source);
+    void removeInputSource(int id);
     void onDeviceConnected(const DeviceInfo& device);
     void onDeviceDisconnected(int deviceId);
+    // Scanner detection for platform input devices: classify when a device
+    // appears or changes, then the key path only looks the verdict up
+    bool classifyDevice(int deviceId, const InputDeviceDescriptor& device);
+    void forgetDeviceClassification(int deviceId);
+    std::optional<bool> isScannerDevice(int deviceId) const;
+
+    // Time source (nullptr = steady_clock); set it while not scanning.
+    // With a manual clock, deadlines only fire through fireDeadlines().
+    void setClock(std::shared_ptr<ScannerClock> clock);
+    std::optional<ScannerClock::time_point> nextDeadline() const;
+    void fireDeadlines();
+
+    // InputSink implementation, called on the input loop thread
+    void onSourceKeys(const KeyEvent* events, size_t count) override;
+    void onSourceFrame(int deviceId, std::string_view frame) override;
+    void onSourceDevice(const SourceDevice& device, bool connected) override;
 
 protected:
-    // Buffer for accumulating scan characters
-    std::string _scanBuffer;
-    std::chrono::steady_clock::time_point _lastKeyTime;
+    // Per-device buffers for accumulating scan characters
+    AssemblerTable _assemblers;
 
     // Configuration
     double _scanTimeout = 50.0; // ms between keys (scanners are fast)
     double _minScanLength = 3.0;
+    size_t _maxScanLength = ScanBuffer::kCapacity;
+    ScanOverflowPolicy _overflowPolicy = ScanOverflowPolicy::DISCARD;
+    bool _adaptiveTimeout = false; // learn per-device timeouts from key timing
+    bool _gs1Parsing = false;      // attach GS1 Application Identifier elements
+    ValidationPolicy _validationPolicy = ValidationPolicy::OFF;
+    KeymapLayout _keymapLayout = KeymapLayout::Platform;
+    // Numbering of incoming keycodes; platform subclasses set it in their constructor
+    KeyCodeSet _keyCodeSet = KeyCodeSet::Android;
+
+    // Duplicate suppression: codes seen within _dedupWindow (0 = off) of
+    // their last read are counted and dropped
+    DedupCache _dedupCache;
+    std::chrono::steady_clock::duration _dedupWindow{0};
+    DedupScope _dedupScope = DedupScope::DEVICE;
+
+    // Memory-mapped catalog; completed scans carry their record when loaded
+    std::shared_ptr<const ProductCatalog> _catalog;
+
+    // Compiled routing rules; scans are tagged with the matching rule's id
+    std::shared_ptr<const ScanRouter> _router;
+    bool _dropUnrouted = false;
+
+    // Prefix/suffix, AIM identifier and multi-code splitting of completed
+    // scans; nullptr takes each scan as one code, as it is
+    std::shared_ptr<const ScanSegmenter> _segmenter;
+
+    // Crash-safe journal; accepted scans are appended before dispatch and
+    // flushed per _journalSyncPolicy (INTERVAL groups them per _journalSyncInterval)
+    std::shared_ptr<ScanJournal> _journal;
+    FsyncPolicy _journalSyncPolicy = FsyncPolicy::INTERVAL;
+    double _journalSyncInterval = 100.0;
+    int _journalSyncTimer = -1;
+
+    std::shared_ptr<ScannerClock> _clock = std::make_shared<SteadyScannerClock>();
+
+    // Raw key events are written here while a key trace is being recorded
+    std::atomic<bool> _recordingKeys{false};
+    std::mutex _keyTraceMutex;
+    std::unique_ptr<KeyTraceWriter> _keyTrace;
+
+    // Counters and per-stage latencies, see getStats()
+    PipelineStats _stats;
 
     // State
     std::atomic<bool> _isScanning{false};
-    std::vector<DeviceInfo> _connectedDevices;
-    std::mutex _devicesMutex;
+    // Connected devices as a lock-free snapshot (see DeviceRegistry)
+    DeviceRegistry _devices;
+    DeviceClassifier _classifier;
     std::mutex _bufferMutex;
 
-    // Callbacks
-    std::function<void(const ScanResult&)> _onScanCallback;
-    std::optional<std::function<void(const std::string&, double)>> _onCharCallback;
+    // Threaded processing: the platform's input thread only pushes into
+    // _platformKeys; the input loop drains it and runs the
+    // buffer/timeout/terminator logic, next to the native sources
+    std::atomic<bool> _threadedProcessing{true};
+    std::shared_ptr<PlatformKeySource> _platformKeys;
+    std::unique_ptr<InputLoop> _inputLoop;
+
+    // Loop source id of the evdev directory watch (Linux only), see startEvdevInput()
+    int _evdevSource = -1;
+    // Serial/TCP streams: device id -> loop source id. Scan callbacks may
+    // close streams from the loop thread.
+    std::mutex _serialMutex;
+    std::vector<std::pair<int, int>> _serialSources;
+    int _nextSerialDevice = SerialSource::kDeviceIdBase;
+
+    // Fires processBuffer() once the timeout passed after a device's last key,
+    // so scanners without a terminator complete without waiting for the next scan
+    DeadlineScheduler _deadlines;
+
+    // Callbacks of the current scanning session (nullptr while stopped)
+    struct ScanCallbacks {
+        std::function<void(const ScanResult&)> onScan;
+        std::function<void(const std::vector<ScanResult>&)> onScans;
+        std::function<void(const std::string&, double)> onChar;
+    };
+    std::shared_ptr<const ScanCallbacks> _callbacks;
     std::function<void(bool)> _connectionCallback;
 
+    // User callbacks never run under _bufferMutex, so they may call back into
+    // the scanner (e.g. stopScanning() after the first scan). Scans and
+    // characters are queued in _outbox while locked; deliverCallbacks() runs
+    // them once unlocked. One thread delivers at a time, in order; entries
+    // keep their session, so stopping still delivers what was queued before.
+    struct Delivery {
+        enum class Kind : uint8_t { Scan, BatchedScan, Char };
+        Kind kind = Kind::Scan;
+        bool endsBatch = false;
+        ScanResult result;
+        std::string characters;
+        double keyCode = 0.0;
+        std::chrono::steady_clock::time_point readyTime;
+        std::shared_ptr<const ScanCallbacks> callbacks;
+    };
+    std::vector<Delivery> _outbox;
+    std::vector<Delivery> _inFlight;   // owned by the delivering thread
+    std::vector<ScanResult> _batch;    // owned by the delivering thread
+    std::atomic<bool> _hasDeliveries{false};
+    bool _delivering = false;
+    std::thread::id _deliveryThread;
+    std::condition_variable _deliveryDone;
+
+    // Batched delivery: completed scans queue up in _pendingScans and are
+    // flushed once per _batchLatency or when kMaxBatchSize is reached
+    static constexpr size_t kMaxBatchSize = 32;
+    std::vector<ScanResult> _pendingScans;
+    std::array<std::chrono::steady_clock::time_point, kMaxBatchSize> _pendingSince;
+    // Delivered results are recycled, so their strings keep their capacity
+    // and a steady stream of scans does not allocate
+    std::vector<ScanResult> _spareResults;
+    double _batchLatency = 16.0;
+    int _batchFlushTimer = -1;
+
     // Helper methods
-    void processBuffer();
+    void processKeyEvent(const KeyEvent& event);
+    void recordKeyEvent(const KeyEvent& event);
+    // Traces, counts and filters incoming keys; false if none need processing
+    bool admitKeys(const KeyEvent* events, size_t count);
+    void processKeys(const KeyEvent* events, size_t count);
+    void drainPlatformKeys();
+    void onScanDeadline(int deviceId);
+    void completeTimedOutScan(int deviceId);
+    ScanAssembler* assemblerFor(int deviceId);
+    void releaseAssembler(int deviceId);
+    bool appendToBuffer(ScanAssembler& assembler, std::string_view characters);
+    void processBuffer(ScanAssembler& assembler);
+    // Pipeline stages run by processBuffer for each code in a completed scan
+    void emitScan(const ScanAssembler& assembler, const ScanSegment& segment);
+    bool acceptScan(const ScanAssembler& assembler, std::string_view code, ScannerClock::time_point now,
+                    ScanResult& result);
+    void enrichScan(ScanResult& result);
+    void journalScan(ScanResult& result);
+    bool isDuplicate(const ScanAssembler& assembler, std::string_view code, ScannerClock::time_point now);
+    void dispatchScan(ScanResult&& result, std::chrono::steady_clock::time_point readyTime);
+    void flushPendingScans();
+    Delivery& queueDelivery(Delivery::Kind kind);
+    // Call after releasing _bufferMutex wherever scans may have completed
+    void deliverCallbacks();
+    ScanResult takeResult();
+    void recycleResult(ScanResult&& result);
     void clearBuffer();
-    bool isEnterKey(int keyCode);
-    std::string keyCodeToChar(int keyCode, bool shiftPressed);
+    // Key-downs, plus key-ups of modifiers (needed to track their state)
+    bool isForwardedKey(int keyCode, int action) const;
 };
 
 } // namespace margelo::nitro::externalscanner
@@ -1,8 +1,7 @@
 #include "HybridExternalScanner_ios.hpp"
-#include <iostream>
+#include "ScannerLog.hpp"
 
-// Debug logging macro
-#define ES_IOS_LOG(msg) std::cout << "[ExternalScanner iOS C++] " << msg << std::endl
+#define ES_LOG_TAG "ExternalScanner iOS C++"
 
 namespace margelo::nitro::externalscanner {
 
@@ -11,32 +10,34 @@ std::mutex HybridExternalScannerIOS::_instanceMutex;
 
 HybridExternalScannerIOS::HybridExternalScannerIOS()
     : HybridObject(TAG), HybridExternalScanner() {
-    ES_IOS_LOG("Constructor called");
+    ES_LOGD("Constructor called");
+    // GCKeyCode values are HID usages
+    _keyCodeSet = KeyCodeSet::Hid;
 }
 
 HybridExternalScannerIOS::~HybridExternalScannerIOS() {
-    ES_IOS_LOG("Destructor called");
+    ES_LOGD("Destructor called");
     stopScanning();
 }
 
 std::shared_ptr<HybridExternalScannerIOS> HybridExternalScannerIOS::getInstance() {
     std::lock_guard<std::mutex> lock(_instanceMutex);
     if (!_instance) {
-        ES_IOS_LOG("Creating new instance");
+        ES_LOGD("Creating new instance");
         _instance = std::make_shared<HybridExternalScannerIOS>();
     } else {
-        ES_IOS_LOG("Returning existing instance");
+        ES_LOGT("Returning existing instance");
     }
     return _instance;
 }
 
 bool HybridExternalScannerIOS::hasExternalScanner() {
-    ES_IOS_LOG("hasExternalScanner called");
+    ES_LOGT("hasExternalScanner called");
     return HybridExternalScanner::hasExternalScanner();
 }
 
 std::vector<DeviceInfo> HybridExternalScannerIOS::getConnectedDevices() {
-    ES_IOS_LOG("getConnectedDevices called");
+    ES_LOGT("getConnectedDevices called");
     return HybridExternalScanner::getConnectedDevices();
 }
 
@@ -44,41 +45,75 @@ void HybridExternalScannerIOS::startScanning(
     const std::function<void(const ScanResult&)>& onScan,
     const std::optional<std::function<void(const std::string&, double)>>& onChar
 ) {
-    ES_IOS_LOG("startScanning called");
+    ES_LOGD("startScanning called");
     HybridExternalScanner::startScanning(onScan, onChar);
     // iOS observer setup is done in Objective-C
 }
 
 void HybridExternalScannerIOS::stopScanning() {
-    ES_IOS_LOG("stopScanning called");
+    ES_LOGD("stopScanning called");
     HybridExternalScanner::stopScanning();
     // iOS observer cleanup is done in Objective-C
 }
 
 void HybridExternalScannerIOS::handleKeyInput(const std::string& characters, int keyCode, bool isKeyDown) {
-    ES_IOS_LOG("handleKeyInput: chars='" << characters << "', keyCode=" << keyCode << ", isKeyDown=" << (isKeyDown ? "true" : "false"));
+    ES_LOGT("handleKeyInput: chars='" << characters << "', keyCode=" << keyCode << ", isKeyDown=" << (isKeyDown ? "true" : "false"));
 
-    if (!isKeyDown) {
-        ES_IOS_LOG("handleKeyInput: Not key down, ignoring");
+    if (_keyboardRejected.load(std::memory_order_relaxed)) {
+        ES_LOGT("handleKeyInput: Keyboard rejected by device rules, ignoring");
         return;
     }
 
-    // isKeyDown is true, so action should be 0 (KEY_DOWN)
-    int action = 0;
-    ES_IOS_LOG("handleKeyInput: Forwarding to onKeyEvent with action=" << action);
+    // Key-ups are forwarded too, the core tracks Shift/AltGr/Caps Lock from them
+    int action = isKeyDown ? 0 : 1;
+    ES_LOGT("handleKeyInput: Forwarding to onKeyEvent with action=" << action);
     onKeyEvent(keyCode, action, characters, 0);
 }
 
 void HybridExternalScannerIOS::updateDevices(const std::vector<DeviceInfo>& devices) {
-    ES_IOS_LOG("updateDevices: " << devices.size() << " devices");
+    ES_LOGD("updateDevices: " << devices.size() << " devices");
     {
-        std::lock_guard<std::mutex> lock(_devicesMutex);
-        _connectedDevices = devices;
+        std::lock_guard<std::mutex> lock(_platformDevicesMutex);
+        _platformDevices = devices;
+    }
+    publishDevices();
+}
+
+bool HybridExternalScannerIOS::setDeviceRules(const std::vector<DeviceRule>& rules) {
+    if (!HybridExternalScanner::setDeviceRules(rules)) {
+        return false;
+    }
+    publishDevices();
+    return true;
+}
+
+void HybridExternalScannerIOS::publishDevices() {
+    std::vector<DeviceInfo> accepted;
+    bool anyReported = false;
+    {
+        std::lock_guard<std::mutex> lock(_platformDevicesMutex);
+        anyReported = !_platformDevices.empty();
+        for (const DeviceInfo& device : _platformDevices) {
+            // GameController reports no USB ids, so only name rules can match
+            InputDeviceDescriptor descriptor;
+            descriptor.name = device.name;
+            descriptor.hasKeyboard = true;
+            if (_classifier.evaluateRules(descriptor).value_or(true)) {
+                accepted.push_back(device);
+            } else {
+                ES_LOGD("publishDevices: '" << device.name << "' rejected by device rules");
+            }
+        }
+    }
+    _keyboardRejected.store(anyReported && accepted.empty(), std::memory_order_relaxed);
+    const bool hasDevices = !accepted.empty();
+    if (!_devices.replace(std::move(accepted))) {
+        return;
     }
 
     if (_connectionCallback) {
-        ES_IOS_LOG("updateDevices: Calling connection callback");
-        _connectionCallback(!devices.empty());
+        ES_LOGD("publishDevices: Calling connection callback");
+        _connectionCallback(hasDevices);
     }
 }
 
@@ -17,6 +17,8 @@ public:
         const std::optional<std::function<void(const std::string&, double)>>& onChar
     ) override;
     void stopScanning() override;
+    // Re-applies the rules to the last reported keyboards
+    bool setDeviceRules(const std::vector<DeviceRule>& rules) override;
 
     // Get the singleton instance
     static std::shared_ptr<HybridExternalScannerIOS> getInstance();
@@ -29,7 +31,16 @@ private:
     static std::shared_ptr<HybridExternalScannerIOS> _instance;
     static std::mutex _instanceMutex;
 
+    // Publishes the reported keyboards that the device rules do not reject
+    void publishDevices();
+
     void* _observer = nullptr; // Opaque pointer to Objective-C observer
+
+    std::mutex _platformDevicesMutex;
+    std::vector<DeviceInfo> _platformDevices; // as last reported by the observer
+    // Keys arrive from the coalesced keyboard; ignore them while the rules
+    // reject every connected keyboard
+    std::atomic<bool> _keyboardRejected{false};
 };
 
 } // namespace margelo::nitro::externalscanner
@@ -0,0 +1,303 @@
+#include "InputLoop.hpp"
+#include "ScannerLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <poll.h>
+#endif
+
+#define ES_LOG_TAG "ExternalScanner Input"
+
+namespace margelo::nitro::externalscanner {
+
+WakeFd::~WakeFd() {
+    if (_writeFd >= 0 && _writeFd != _readFd) {
+        close(_writeFd);
+    }
+    if (_readFd >= 0) {
+        close(_readFd);
+    }
+}
+
+bool WakeFd::open() {
+#if defined(__linux__)
+    _readFd = _writeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return _readFd >= 0;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    _readFd = fds[0];
+    _writeFd = fds[1];
+    return true;
+#endif
+}
+
+void WakeFd::signal() {
+#if defined(__linux__)
+    const uint64_t one = 1;
+#else
+    // A full pipe is still readable, so EAGAIN loses nothing
+    const char one = 1;
+#endif
+    if (write(_writeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        ES_LOGW("signal: Cannot wake: " << std::strerror(errno));
+    }
+}
+
+void WakeFd::clear() {
+#if defined(__linux__)
+    uint64_t wakes = 0;
+    (void)read(_readFd, &wakes, sizeof(wakes));
+#else
+    char wakes[64];
+    while (read(_readFd, wakes, sizeof(wakes)) > 0) {}
+#endif
+}
+
+InputLoop::InputLoop(InputSink& sink) : _sink(sink) {}
+
+std::unique_ptr<InputLoop> InputLoop::start(InputSink& sink) {
+    std::unique_ptr<InputLoop> loop(new InputLoop(sink));
+    if (!loop->_wake.open()) {
+        ES_LOGE("start: Cannot create wake fd: " << std::strerror(errno));
+        return nullptr;
+    }
+#if defined(__linux__)
+    loop->_pollFd = epoll_create1(EPOLL_CLOEXEC);
+    // data.ptr: nullptr = wake, otherwise the Entry
+    epoll_event wake{};
+    wake.events = EPOLLIN;
+    wake.data.ptr = nullptr;
+    if (loop->_pollFd < 0 || epoll_ctl(loop->_pollFd, EPOLL_CTL_ADD, loop->_wake.fd(), &wake) != 0) {
+        ES_LOGE("start: Cannot create epoll: " << std::strerror(errno));
+        return nullptr;
+    }
+#endif
+    loop->_running = true;
+    loop->_thread = std::thread(&InputLoop::run, loop.get());
+    return loop;
+}
+
+InputLoop::~InputLoop() {
+    if (_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _wake.signal();
+        _thread.join();
+        _removed.notify_all();
+    }
+    std::vector<std::unique_ptr<Entry>> entries;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        entries.swap(_entries);
+    }
+    // Unlocked: stop() may remove further sources, which are among these
+    for (const auto& entry : entries) {
+        entry->source->stop();
+    }
+    if (_pollFd >= 0) {
+        close(_pollFd);
+    }
+}
+
+int InputLoop::add(std::shared_ptr<InputSource> source) {
+    if (!source || !source->start()) {
+        return -1;
+    }
+    Entry* added = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_entries.size() < kMaxSources) {
+            auto entry = std::make_unique<Entry>();
+            entry->id = _nextId++;
+            entry->source = source;
+            added = entry.get();
+            _entries.push_back(std::move(entry));
+        }
+    }
+    if (added == nullptr) {
+        ES_LOGW("add: Too many sources");
+        source->stop();
+        return -1;
+    }
+    // Nobody knows the id yet and only the loop thread removes entries, so
+    // the device is reported before anything can remove it
+    const int id = added->id;
+    if (std::optional<SourceDevice> device = source->device()) {
+        ES_LOGI("add: " << id << " device " << device->deviceId << " '" << device->name << "'");
+        _sink.onSourceDevice(*device, true);
+    }
+    if (!watch(added)) {
+        ES_LOGE("add: Cannot watch fd " << source->readinessFd() << ": " << std::strerror(errno));
+        remove(id);
+        return -1;
+    }
+    return id;
+}
+
+void InputLoop::remove(int id) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _pendingRemoval.push_back(id);
+    const uint64_t ticket = ++_removalsRequested;
+    _removalPending = true;
+    if (!_running || isLoopThread()) {
+        return;
+    }
+    _wake.signal();
+    _removed.wait(lock, [this, ticket] { return _removalsDone >= ticket || !_running; });
+}
+
+size_t InputLoop::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+#if defined(__linux__)
+
+bool InputLoop::watch(Entry* entry) {
+    epoll_event readable{};
+    readable.events = EPOLLIN;
+    readable.data.ptr = entry;
+    return epoll_ctl(_pollFd, EPOLL_CTL_ADD, entry->source->readinessFd(), &readable) == 0;
+}
+
+void InputLoop::unwatch(Entry* entry) {
+    epoll_ctl(_pollFd, EPOLL_CTL_DEL, entry->source->readinessFd(), nullptr);
+}
+
+#else
+
+// poll() takes the fd set on each call, which the loop rebuilds once woken
+bool InputLoop::watch(Entry*) {
+    _wake.signal();
+    return true;
+}
+
+void InputLoop::unwatch(Entry*) {}
+
+#endif
+
+void InputLoop::run() {
+    _loopThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    Entry* batch[kMaxSources];
+#if defined(__linux__)
+    epoll_event ready[kMaxSources + 1];
+#else
+    pollfd fds[kMaxSources + 1];
+    Entry* polled[kMaxSources];
+#endif
+    while (_running.load(std::memory_order_relaxed)) {
+        size_t count = 0;
+#if defined(__linux__)
+        const int readyCount = epoll_wait(_pollFd, ready, static_cast<int>(kMaxSources + 1), -1);
+        if (readyCount < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ES_LOGE("run: epoll_wait failed: " << std::strerror(errno));
+            break;
+        }
+        for (int i = 0; i < readyCount; i++) {
+            if (ready[i].data.ptr == nullptr) {
+                _wake.clear();
+            } else {
+                batch[count++] = static_cast<Entry*>(ready[i].data.ptr);
+            }
+        }
+#else
+        size_t watched = 0;
+        fds[0] = pollfd{_wake.fd(), POLLIN, 0};
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const auto& entry : _entries) {
+                fds[watched + 1] = pollfd{entry->source->readinessFd(), POLLIN, 0};
+                polled[watched++] = entry.get();
+            }
+        }
+        if (poll(fds, watched + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ES_LOGE("run: poll failed: " << std::strerror(errno));
+            break;
+        }
+        if (fds[0].revents != 0) {
+            _wake.clear();
+        }
+        for (size_t i = 0; i < watched; i++) {
+            if (fds[i + 1].revents != 0) {
+                batch[count++] = polled[i];
+            }
+        }
+#endif
+        for (size_t i = 0; i < count; i++) {
+            if (!batch[i]->source->drain(_sink)) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _pendingRemoval.push_back(batch[i]->id);
+                _removalsRequested++;
+                _removalPending = true;
+            }
+        }
+        // After the batch, so no ready entry points at a removed source
+        if (_removalPending.load(std::memory_order_acquire)) {
+            removePending();
+        }
+    }
+    // Also reached when waiting failed: removals no longer happen, so stop waiting for them
+    std::lock_guard<std::mutex> lock(_mutex);
+    _running = false;
+    _removed.notify_all();
+}
+
+void InputLoop::removePending() {
+    for (;;) {
+        std::vector<int> ids;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_pendingRemoval.empty()) {
+                _removalPending = false;
+                _removalsDone = _removalsRequested;
+                break;
+            }
+            ids.swap(_pendingRemoval);
+        }
+        // Stopping a source may queue more removals, hence the outer loop
+        for (int id : ids) {
+            std::unique_ptr<Entry> entry;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = std::find_if(_entries.begin(), _entries.end(),
+                                       [id](const auto& candidate) { return candidate->id == id; });
+                if (it == _entries.end()) {
+                    continue;
+                }
+                entry = std::move(*it);
+                _entries.erase(it);
+            }
+            unwatch(entry.get());
+            entry->source->stop();
+            if (std::optional<SourceDevice> device = entry->source->device()) {
+                ES_LOGI("remove: " << id << " device " << device->deviceId << " '" << device->name << "'");
+                _sink.onSourceDevice(*device, false);
+            }
+        }
+    }
+    _removed.notify_all();
+}
+
+} // namespace margelo::nitro::externalscanner
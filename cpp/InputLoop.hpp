@@ -0,0 +1,75 @@
+#pragma once
+
+#include "InputSource.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+// The one native thread that waits on every InputSource (epoll on Linux,
+// poll() elsewhere) and drains whichever are ready into the sink, so key
+// assembly, evdev devices and serial streams all run on the same thread.
+//
+// Sources can be added and removed at any time, from any thread, without
+// pausing the others. Removal and ending happen on the loop thread between
+// batches, so a source is never stopped while it is being drained.
+class InputLoop {
+public:
+    static constexpr size_t kMaxSources = 64;
+
+    // Starts the loop thread; nullptr on failure
+    static std::unique_ptr<InputLoop> start(InputSink& sink);
+    // Stops the thread, then every source (without reporting their devices)
+    ~InputLoop();
+    InputLoop(const InputLoop&) = delete;
+    InputLoop& operator=(const InputLoop&) = delete;
+
+    // Starts the source and waits on it; returns its id (never reused), -1 if
+    // it did not start or there are too many sources. Also works from drain().
+    int add(std::shared_ptr<InputSource> source);
+    // Stops the source and reports its device. From another thread this waits
+    // until it is done; from the loop thread it happens after the current batch.
+    void remove(int id);
+
+    bool isLoopThread() const { return std::this_thread::get_id() == _loopThread.load(std::memory_order_relaxed); }
+    size_t size() const;
+
+private:
+    struct Entry {
+        int id = 0;
+        std::shared_ptr<InputSource> source;
+    };
+
+    explicit InputLoop(InputSink& sink);
+
+    void run();
+    // Loop thread only
+    void removePending();
+    bool watch(Entry* entry);
+    void unwatch(Entry* entry);
+
+    InputSink& _sink;
+    int _pollFd = -1; // epoll (Linux only)
+    WakeFd _wake;
+    std::atomic<bool> _running{false};
+    std::thread _thread;
+    std::atomic<std::thread::id> _loopThread{};
+
+    // Guards the entries and the removal requests
+    mutable std::mutex _mutex;
+    std::condition_variable _removed;
+    std::vector<std::unique_ptr<Entry>> _entries;
+    std::vector<int> _pendingRemoval;
+    std::atomic<bool> _removalPending{false};
+    uint64_t _removalsRequested = 0;
+    uint64_t _removalsDone = 0;
+    int _nextId = 1;
+};
+
+} // namespace margelo::nitro::externalscanner
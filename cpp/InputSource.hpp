@@ -0,0 +1,73 @@
+#pragma once
+
+#include "KeyEventRing.hpp"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace margelo::nitro::externalscanner {
+
+// A device an InputSource reads from, reported when the source is added and
+// again when it is removed
+struct SourceDevice {
+    int deviceId = 0;
+    std::string name;
+    int vendorId = 0;
+    int productId = 0;
+};
+
+// Receives what the sources read. Keys and frames are delivered on the loop
+// thread; device reports on the thread that added or removed the source.
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+
+    // Raw keys straight from a device (not yet traced, counted or filtered)
+    virtual void onSourceKeys(const KeyEvent* events, size_t count) = 0;
+    // One complete, already framed scan
+    virtual void onSourceFrame(int deviceId, std::string_view frame) = 0;
+    virtual void onSourceDevice(const SourceDevice& device, bool connected) = 0;
+};
+
+// Something the InputLoop waits on: a device node, a serial stream, the
+// platform's key hand-off, a pipe of synthetic events. The loop calls drain()
+// whenever readinessFd() is readable; drain() reads what is available without
+// blocking and passes it to the sink.
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    // Opens the source, on the thread adding it; false = not added
+    virtual bool start() = 0;
+    // Releases it, on the loop thread once removed or ended (or while the
+    // loop shuts down)
+    virtual void stop() = 0;
+    // Level-triggered: readable while drain() has work
+    virtual int readinessFd() const = 0;
+    // Returns false once the source has ended (EOF, device unplugged)
+    virtual bool drain(InputSink& sink) = 0;
+    // The device to report, if the source stands for one
+    virtual std::optional<SourceDevice> device() const { return std::nullopt; }
+};
+
+// Wakes a thread waiting on fd(): an eventfd on Linux, a pipe elsewhere.
+// signal() and clear() never block and can be called from any thread.
+class WakeFd {
+public:
+    WakeFd() = default;
+    ~WakeFd();
+    WakeFd(const WakeFd&) = delete;
+    WakeFd& operator=(const WakeFd&) = delete;
+
+    bool open();
+    int fd() const { return _readFd; }
+    void signal();
+    void clear();
+
+private:
+    int _readFd = -1;
+    int _writeFd = -1;
+};
+
+} // namespace margelo::nitro::externalscanner
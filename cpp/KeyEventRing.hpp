@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace margelo::nitro::externalscanner {
+
+// Compact, trivially copyable key event handed from the platform input
+// thread to the input loop (32 bytes, no heap storage).
+struct KeyEvent {
+    static constexpr size_t kMaxChars = 14;
+
+    int64_t time = 0;      // steady_clock ticks at ingest
+    int32_t keyCode = 0;
+    int32_t deviceId = 0;
+    uint8_t action = 0;
+    uint8_t charCount = 0;
+    char chars[kMaxChars] = {};
+
+    static KeyEvent make(int keyCode, int action, std::string_view characters, int deviceId, int64_t time) {
+        KeyEvent event;
+        event.time = time;
+        event.keyCode = keyCode;
+        event.deviceId = deviceId;
+        event.action = static_cast<uint8_t>(action);
+        // Cut only between UTF-8 code points: back off over continuation bytes
+        size_t count = std::min(characters.size(), kMaxChars);
+        if (count < characters.size()) {
+            while (count > 0 && (static_cast<uint8_t>(characters[count]) & 0xC0) == 0x80) {
+                count--;
+            }
+        }
+        event.charCount = static_cast<uint8_t>(count);
+        std::memcpy(event.chars, characters.data(), count);
+        return event;
+    }
+
+    std::string_view characters() const {
+        return std::string_view(chars, charCount);
+    }
+};
+
+static_assert(sizeof(KeyEvent) == 32, "KeyEvent should stay compact");
+
+// Bounded single-producer/single-consumer ring. push() must only be called
+// from one thread and pop() from one (other) thread; neither side blocks.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T& item) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _cachedTail == Capacity) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head - _cachedTail == Capacity) {
+                return false; // full
+            }
+        }
+        _slots[head & (Capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _cachedHead) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail == _cachedHead) {
+                return false; // empty
+            }
+        }
+        out = _slots[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    // Producer side
+    alignas(64) std::atomic<size_t> _head{0};
+    size_t _cachedTail = 0;
+
+    // Consumer side
+    alignas(64) std::atomic<size_t> _tail{0};
+    size_t _cachedHead = 0;
+
+    alignas(64) std::array<T, Capacity> _slots{};
+};
+
+} // namespace margelo::nitro::externalscanner
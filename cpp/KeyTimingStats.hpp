@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace margelo::nitro::externalscanner {
+
+// Streaming statistics of the gaps between keys of one device, kept as a
+// 1 ms histogram. Old samples fade out by halving all buckets whenever the
+// total gets large, so the learned timeout follows a device that changes
+// (e.g. a scanner switched from USB to Bluetooth).
+class KeyTimingStats {
+public:
+    static constexpr int kBuckets = 256;           // 0..255 ms
+    static constexpr uint32_t kDecayThreshold = 4096;
+    static constexpr uint32_t kMinSamples = 32;    // before adapting at all
+
+    // Longest a platform holds keys before they reach the core (ms): the
+    // Android key batch, KeyEventBatch.FLUSH_DELAY_MS. A scan's deadline is
+    // armed from the key's event time, so a shorter timeout could fire while
+    // the rest of the burst is still held and split one code in two.
+    static constexpr double kMaxInputHold = 16.0;
+
+    // Bounds and margin for the learned timeout (ms)
+    static constexpr double kMinTimeout = kMaxInputHold + 10.0;
+    static constexpr double kMaxTimeout = 300.0;
+    static constexpr double kMinMargin = 5.0;
+    static constexpr double kPercentile = 0.99;
+
+    // Gaps this long are pauses between scans, not keys of one scan
+    static bool isLearnable(double intervalMs) {
+        return intervalMs >= 0.0 && intervalMs < kBuckets;
+    }
+
+    void record(double intervalMs) {
+        if (!isLearnable(intervalMs)) {
+            return;
+        }
+        _buckets[static_cast<int>(intervalMs)]++;
+        if (++_total >= kDecayThreshold) {
+            decay();
+        }
+    }
+
+    uint32_t sampleCount() const { return _total; }
+
+    // Interval (ms) below which the given fraction of samples fall
+    double percentile(double fraction) const {
+        if (_total == 0) {
+            return 0.0;
+        }
+        const uint32_t target = std::max<uint32_t>(1, static_cast<uint32_t>(fraction * _total + 0.5));
+        uint32_t seen = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            seen += _buckets[i];
+            if (seen >= target) {
+                return static_cast<double>(i + 1); // upper edge of the bucket
+            }
+        }
+        return static_cast<double>(kBuckets);
+    }
+
+    // High percentile plus margin, or the fallback until enough samples exist
+    double learnedTimeout(double fallback) const {
+        if (_total < kMinSamples) {
+            return fallback;
+        }
+        const double p = percentile(kPercentile);
+        const double margin = std::max(kMinMargin, p * 0.25);
+        return std::clamp(p + margin, kMinTimeout, kMaxTimeout);
+    }
+
+    void reset() {
+        _buckets.fill(0);
+        _total = 0;
+    }
+
+private:
+    std::array<uint32_t, kBuckets> _buckets{};
+    uint32_t _total = 0;
+
+    void decay() {
+        _total = 0;
+        for (uint32_t& count : _buckets) {
+            count /= 2;
+            _total += count;
+        }
+    }
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,193 @@
+#include "KeyTrace.hpp"
+#include "ScannerLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#define ES_LOG_TAG "ExternalScanner KeyTrace"
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'S', 'K', 'T', 'R', 'C', '0', '1'};
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kMaxRecordSize = 10 + 5 + 1 + 5 + 1 + KeyEvent::kMaxChars;
+
+int64_t toNanoseconds(int64_t ticks) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::duration(ticks)).count();
+}
+
+int64_t toTicks(int64_t nanoseconds) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(nanoseconds)).count();
+}
+
+uint8_t* putVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class Cursor {
+public:
+    Cursor(const uint8_t* data, size_t size) : _data(data), _end(data + size) {}
+
+    bool atEnd() const { return _data == _end; }
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && _data < _end; shift += 7) {
+            const uint8_t byte = *_data++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool byte(uint8_t& value) {
+        if (_data == _end) {
+            return false;
+        }
+        value = *_data++;
+        return true;
+    }
+
+    bool bytes(char* out, size_t count) {
+        if (static_cast<size_t>(_end - _data) < count) {
+            return false;
+        }
+        std::memcpy(out, _data, count);
+        _data += count;
+        return true;
+    }
+
+private:
+    const uint8_t* _data;
+    const uint8_t* _end;
+};
+
+void putInt64(uint8_t* out, int64_t value) {
+    std::memcpy(out, &value, sizeof(value));
+}
+
+int64_t getInt64(const uint8_t* in) {
+    int64_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+std::optional<KeyTrace> KeyTrace::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        ES_LOGE("load: Cannot open '" << path << "': " << std::strerror(errno));
+        return std::nullopt;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+
+    if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        ES_LOGE("load: '" << path << "' is not a key trace");
+        return std::nullopt;
+    }
+
+    KeyTrace trace;
+    trace.startTime = toTicks(getInt64(data.data() + 8));
+    trace.startWallMs = getInt64(data.data() + 16);
+    int64_t time = trace.startTime;
+    Cursor cursor(data.data() + kHeaderSize, data.size() - kHeaderSize);
+    while (!cursor.atEnd()) {
+        uint64_t delta, keyCode, deviceId;
+        uint8_t action, charCount;
+        KeyEvent event;
+        if (!cursor.varint(delta) || !cursor.varint(keyCode) || !cursor.byte(action) ||
+            !cursor.varint(deviceId) || !cursor.byte(charCount) || charCount > KeyEvent::kMaxChars ||
+            !cursor.bytes(event.chars, charCount)) {
+            ES_LOGW("load: Dropping truncated record after " << trace.events.size() << " events");
+            break;
+        }
+        time += toTicks(static_cast<int64_t>(delta));
+        event.time = time;
+        event.keyCode = static_cast<int32_t>(unzigzag(keyCode));
+        event.deviceId = static_cast<int32_t>(unzigzag(deviceId));
+        event.action = action;
+        event.charCount = charCount;
+        trace.events.push_back(event);
+    }
+    return trace;
+}
+
+KeyTraceWriter::~KeyTraceWriter() {
+    close();
+}
+
+std::unique_ptr<KeyTraceWriter> KeyTraceWriter::open(const std::string& path, int64_t startTime, int64_t startWallMs) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        ES_LOGE("open: Cannot create '" << path << "': " << std::strerror(errno));
+        return nullptr;
+    }
+    uint8_t header[kHeaderSize] = {};
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    putInt64(header + 8, toNanoseconds(startTime));
+    putInt64(header + 16, startWallMs);
+    if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        ES_LOGE("open: Cannot write '" << path << "'");
+        std::fclose(file);
+        return nullptr;
+    }
+    return std::unique_ptr<KeyTraceWriter>(new KeyTraceWriter(file, startTime));
+}
+
+void KeyTraceWriter::append(const KeyEvent& event) {
+    if (_file == nullptr) {
+        return;
+    }
+    uint8_t record[kMaxRecordSize];
+    // Events from different threads may arrive slightly out of order
+    const int64_t delta = std::max<int64_t>(toNanoseconds(event.time - _lastTime), 0);
+    _lastTime = std::max(_lastTime, event.time);
+    uint8_t* out = putVarint(record, static_cast<uint64_t>(delta));
+    out = putVarint(out, zigzag(event.keyCode));
+    *out++ = event.action;
+    out = putVarint(out, zigzag(event.deviceId));
+    *out++ = event.charCount;
+    std::memcpy(out, event.chars, event.charCount);
+    out += event.charCount;
+
+    const size_t size = static_cast<size_t>(out - record);
+    if (std::fwrite(record, 1, size, _file) != size) {
+        _failed = true;
+    }
+}
+
+bool KeyTraceWriter::close() {
+    if (_file == nullptr) {
+        return !_failed;
+    }
+    _failed |= std::fclose(_file) != 0;
+    _file = nullptr;
+    return !_failed;
+}
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "KeyEventRing.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+// Raw key events as they reached the scanner, for reproducing field
+// problems (split or merged scans) offline.
+//
+// File: 32-byte header, then one record per event:
+//   header:  "ESKTRC01", int64 start (steady ns), int64 start wall time (ms), reserved
+//   record:  varint ns since previous event, zigzag varint keyCode, uint8 action,
+//            zigzag varint deviceId, uint8 charCount, chars
+// A typical key takes 6-8 bytes.
+struct KeyTrace {
+    int64_t startTime = 0;   // steady_clock ticks when recording started
+    int64_t startWallMs = 0; // wall time at startTime
+    std::vector<KeyEvent> events; // times in steady_clock ticks, as recorded
+
+    // nullopt if the file is missing or not a key trace; a truncated last
+    // record (recording cut short) is dropped
+    static std::optional<KeyTrace> load(const std::string& path);
+};
+
+class KeyTraceWriter {
+public:
+    ~KeyTraceWriter();
+    KeyTraceWriter(const KeyTraceWriter&) = delete;
+    KeyTraceWriter& operator=(const KeyTraceWriter&) = delete;
+
+    // Creates (or truncates) path; nullptr on failure
+    static std::unique_ptr<KeyTraceWriter> open(const std::string& path, int64_t startTime, int64_t startWallMs);
+
+    // Not thread-safe; the scanner serializes calls
+    void append(const KeyEvent& event);
+    // Flushes and closes; false if anything failed to write
+    bool close();
+
+private:
+    KeyTraceWriter(std::FILE* file, int64_t startTime) : _file(file), _lastTime(startTime) {}
+
+    std::FILE* _file;
+    int64_t _lastTime;
+    bool _failed = false;
+};
+
+} // namespace margelo::nitro::externalscanner
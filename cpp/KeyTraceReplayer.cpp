@@ -0,0 +1,70 @@
+#include "KeyTraceReplayer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+// Long enough for any inter-key timeout, batch latency or journal sync to expire
+constexpr std::chrono::seconds kDrainTime{10};
+
+using TimePoint = ScannerClock::time_point;
+
+void advanceTo(HybridExternalScanner& scanner, VirtualClock& clock, TimePoint time) {
+    // Step through deadlines one by one, so each fires at its own time
+    while (std::optional<TimePoint> deadline = scanner.nextDeadline()) {
+        if (*deadline > time) {
+            break;
+        }
+        clock.set(*deadline);
+        scanner.fireDeadlines();
+    }
+    clock.set(time);
+}
+
+} // namespace
+
+std::vector<ScanResult> replayKeyTrace(HybridExternalScanner& scanner, const KeyTrace& trace,
+                                       const ReplayOptions& options) {
+    std::vector<ScanResult> results;
+    if (trace.events.empty()) {
+        return results;
+    }
+
+    const TimePoint start{TimePoint::duration(trace.events.front().time)};
+    auto clock = std::make_shared<VirtualClock>(TimePoint(TimePoint::duration(trace.startTime)), trace.startWallMs);
+    clock->set(start);
+    scanner.setThreadedProcessing(false);
+    scanner.setClock(clock);
+    scanner.startScanning([&results](const ScanResult& result) { results.push_back(result); }, std::nullopt);
+
+    const double scale = options.speed == ReplaySpeed::Scaled ? std::max(options.scale, 1e-6) : 1.0;
+    const auto realStart = std::chrono::steady_clock::now();
+    const std::vector<KeyEvent>& events = trace.events;
+    for (size_t first = 0; first < events.size();) {
+        // The batch holds every key recorded before its delivery time
+        const TimePoint time = TimePoint(TimePoint::duration(events[first].time)) + options.batchHold;
+        size_t end = first + 1;
+        while (options.batchHold.count() > 0 && end < events.size() &&
+               TimePoint(TimePoint::duration(events[end].time)) < time) {
+            end++;
+        }
+        if (options.speed != ReplaySpeed::AsFastAsPossible) {
+            std::this_thread::sleep_until(realStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                          (time - start) / scale));
+        }
+        advanceTo(scanner, *clock, time);
+        scanner.onKeyEvents(&events[first], end - first);
+        first = end;
+    }
+    advanceTo(scanner, *clock, clock->now() + kDrainTime);
+
+    scanner.stopScanning();
+    scanner.setClock(nullptr);
+    return results;
+}
+
+} // namespace margelo::nitro::externalscanner
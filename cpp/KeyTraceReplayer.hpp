@@ -0,0 +1,36 @@
+#pragma once
+
+#include "HybridExternalScanner.hpp"
+#include "KeyTrace.hpp"
+#include <chrono>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+enum class ReplaySpeed {
+    AsFastAsPossible,
+    Recorded, // real-time gaps between keys, as captured
+    Scaled,   // recorded gaps divided by ReplayOptions::scale
+};
+
+struct ReplayOptions {
+    ReplaySpeed speed = ReplaySpeed::AsFastAsPossible;
+    double scale = 1.0;
+    // Deliver keys in batches, as the Android key batch does: from the first
+    // key of a batch, keys are held this long and then passed on together
+    // (0 = each key at its own time). Terminators do not flush early.
+    std::chrono::milliseconds batchHold{0};
+};
+
+// Feeds a key trace through scanner on a virtual clock that jumps to each
+// recorded key time, firing inter-key and batch deadlines in between exactly
+// when they were due. Speed only changes how long the replay takes in real
+// time; the scans are the same for every speed and every run.
+//
+// The scanner is configured by the caller (timeouts, validation, ...) and
+// must not be scanning. It is switched to synchronous processing, and its
+// clock is reset to steady_clock afterwards. Returns the scans in delivery order.
+std::vector<ScanResult> replayKeyTrace(HybridExternalScanner& scanner, const KeyTrace& trace,
+                                       const ReplayOptions& options = {});
+
+} // namespace margelo::nitro::externalscanner
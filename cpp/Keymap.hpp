@@ -0,0 +1,415 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace margelo::nitro::externalscanner {
+
+// Numbering of the keycodes a platform reports
+enum class KeyCodeSet : uint8_t {
+    Android, // KeyEvent.KEYCODE_*
+    Hid,     // USB HID keyboard usages (iOS GCKeyCode uses these directly)
+    Linux,   // evdev KEY_*
+};
+
+enum class KeymapLayout : uint8_t {
+    Platform, // characters as the platform sent them; US tables for keys without any
+    Us,
+    German, // QWERTZ
+    French, // AZERTY
+};
+
+// Modifier state of one keyboard, tracked from key-down/up
+struct KeyModifiers {
+    static constexpr uint8_t kLeftCtrl = 1 << 0;
+    static constexpr uint8_t kLeftShift = 1 << 1;
+    static constexpr uint8_t kLeftAlt = 1 << 2;
+    static constexpr uint8_t kRightCtrl = 1 << 4;
+    static constexpr uint8_t kRightShift = 1 << 5;
+    static constexpr uint8_t kRightAlt = 1 << 6;
+
+    uint8_t held = 0; // bits above
+    bool capsLock = false;
+
+    constexpr bool shift() const { return (held & (kLeftShift | kRightShift)) != 0; }
+    constexpr bool ctrl() const { return (held & (kLeftCtrl | kRightCtrl)) != 0; }
+    // Right Alt, or Ctrl+Alt as on Windows
+    constexpr bool altGr() const { return (held & kRightAlt) != 0 || ((held & kLeftAlt) != 0 && ctrl()); }
+};
+
+// Layout tables, built at compile time
+namespace keymap_detail {
+
+struct KeyLevels {
+    char16_t base = 0;
+    char16_t shifted = 0;
+    char16_t altGr = 0;
+    bool capsLock = false; // Caps Lock acts as Shift (letters)
+};
+
+constexpr size_t kTableSize = 0x68; // up to Keypad =
+using LayoutTable = std::array<KeyLevels, kTableSize>;
+
+constexpr void setKey(LayoutTable& table, uint8_t usage, char16_t base, char16_t shifted, char16_t altGr = 0) {
+    table[usage] = KeyLevels{base, shifted, altGr, false};
+}
+
+constexpr void setLetter(LayoutTable& table, uint8_t usage, char16_t lower, char16_t altGr = 0) {
+    const char16_t upper = lower >= u'a' && lower <= u'z' ? static_cast<char16_t>(lower - u'a' + u'A')
+                           : lower == u'ä'                 ? u'Ä'
+                           : lower == u'ö'                 ? u'Ö'
+                           : lower == u'ü'                 ? u'Ü'
+                                                           : lower;
+    table[usage] = KeyLevels{lower, upper, altGr, true};
+}
+
+constexpr LayoutTable makeUs() {
+    LayoutTable table{};
+    for (uint8_t i = 0; i < 26; i++) {
+        setLetter(table, static_cast<uint8_t>(0x04 + i), static_cast<char16_t>(u'a' + i));
+    }
+    constexpr char16_t shiftedDigits[] = u"!@#$%^&*()";
+    for (uint8_t i = 0; i < 9; i++) {
+        setKey(table, static_cast<uint8_t>(0x1E + i), static_cast<char16_t>(u'1' + i), shiftedDigits[i]);
+    }
+    setKey(table, 0x27, u'0', u')');
+    setKey(table, 0x2B, u'\t', u'\t');
+    setKey(table, 0x2C, u' ', u' ');
+    setKey(table, 0x2D, u'-', u'_');
+    setKey(table, 0x2E, u'=', u'+');
+    setKey(table, 0x2F, u'[', u'{');
+    setKey(table, 0x30, u']', u'}');
+    setKey(table, 0x31, u'\\', u'|');
+    setKey(table, 0x32, u'#', u'~'); // ISO key next to Enter
+    setKey(table, 0x33, u';', u':');
+    setKey(table, 0x34, u'\'', u'"');
+    setKey(table, 0x35, u'`', u'~');
+    setKey(table, 0x36, u',', u'<');
+    setKey(table, 0x37, u'.', u'>');
+    setKey(table, 0x38, u'/', u'?');
+    setKey(table, 0x64, u'\\', u'|'); // ISO key next to Left Shift
+    // Keypad (Num Lock on)
+    setKey(table, 0x54, u'/', u'/');
+    setKey(table, 0x55, u'*', u'*');
+    setKey(table, 0x56, u'-', u'-');
+    setKey(table, 0x57, u'+', u'+');
+    for (uint8_t i = 0; i < 9; i++) {
+        setKey(table, static_cast<uint8_t>(0x59 + i), static_cast<char16_t>(u'1' + i),
+               static_cast<char16_t>(u'1' + i));
+    }
+    setKey(table, 0x62, u'0', u'0');
+    setKey(table, 0x63, u'.', u'.');
+    setKey(table, 0x67, u'=', u'=');
+    return table;
+}
+
+constexpr LayoutTable makeGerman() {
+    LayoutTable table = makeUs();
+    setLetter(table, 0x1C, u'z'); // Y key
+    setLetter(table, 0x1D, u'y'); // Z key
+    setLetter(table, 0x14, u'q', u'@');
+    setLetter(table, 0x08, u'e', u'€');
+    setLetter(table, 0x10, u'm', u'µ');
+    setKey(table, 0x1E, u'1', u'!');
+    setKey(table, 0x1F, u'2', u'"', u'²');
+    setKey(table, 0x20, u'3', u'§', u'³');
+    setKey(table, 0x21, u'4', u'$');
+    setKey(table, 0x22, u'5', u'%');
+    setKey(table, 0x23, u'6', u'&');
+    setKey(table, 0x24, u'7', u'/', u'{');
+    setKey(table, 0x25, u'8', u'(', u'[');
+    setKey(table, 0x26, u'9', u')', u']');
+    setKey(table, 0x27, u'0', u'=', u'}');
+    setKey(table, 0x2D, u'ß', u'?', u'\\');
+    setKey(table, 0x2E, u'´', u'`');
+    setLetter(table, 0x2F, u'ü');
+    setKey(table, 0x30, u'+', u'*', u'~');
+    setKey(table, 0x31, u'#', u'\'');
+    setKey(table, 0x32, u'#', u'\'');
+    setLetter(table, 0x33, u'ö');
+    setLetter(table, 0x34, u'ä');
+    setKey(table, 0x35, u'^', u'°');
+    setKey(table, 0x36, u',', u';');
+    setKey(table, 0x37, u'.', u':');
+    setKey(table, 0x38, u'-', u'_');
+    setKey(table, 0x64, u'<', u'>', u'|');
+    setKey(table, 0x63, u',', u','); // Keypad decimal separator
+    return table;
+}
+
+constexpr LayoutTable makeFrench() {
+    LayoutTable table = makeUs();
+    setLetter(table, 0x04, u'q'); // A key
+    setLetter(table, 0x14, u'a'); // Q key
+    setLetter(table, 0x1A, u'z'); // W key
+    setLetter(table, 0x1D, u'w'); // Z key
+    setLetter(table, 0x33, u'm'); // ; key
+    setLetter(table, 0x08, u'e', u'€');
+    setKey(table, 0x10, u',', u'?'); // M key
+    setKey(table, 0x1E, u'&', u'1');
+    setKey(table, 0x1F, u'é', u'2', u'~');
+    setKey(table, 0x20, u'"', u'3', u'#');
+    setKey(table, 0x21, u'\'', u'4', u'{');
+    setKey(table, 0x22, u'(', u'5', u'[');
+    setKey(table, 0x23, u'-', u'6', u'|');
+    setKey(table, 0x24, u'è', u'7', u'`');
+    setKey(table, 0x25, u'_', u'8', u'\\');
+    setKey(table, 0x26, u'ç', u'9', u'^');
+    setKey(table, 0x27, u'à', u'0', u'@');
+    setKey(table, 0x2D, u')', u'°', u']');
+    setKey(table, 0x2E, u'=', u'+', u'}');
+    setKey(table, 0x2F, u'^', u'¨');
+    setKey(table, 0x30, u'$', u'£', u'¤');
+    setKey(table, 0x31, u'*', u'µ');
+    setKey(table, 0x32, u'*', u'µ');
+    setKey(table, 0x34, u'ù', u'%');
+    setKey(table, 0x35, u'²', u'²');
+    setKey(table, 0x36, u';', u'.');
+    setKey(table, 0x37, u':', u'/');
+    setKey(table, 0x38, u'!', u'§');
+    setKey(table, 0x64, u'<', u'>');
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> makeAndroidUsages() {
+    std::array<uint8_t, 256> usages{};
+    usages[7] = 0x27; // KEYCODE_0
+    for (int i = 0; i < 9; i++) {
+        usages[static_cast<size_t>(8 + i)] = static_cast<uint8_t>(0x1E + i); // KEYCODE_1..9
+    }
+    for (int i = 0; i < 26; i++) {
+        usages[static_cast<size_t>(29 + i)] = static_cast<uint8_t>(0x04 + i); // KEYCODE_A..Z
+    }
+    usages[55] = 0x36;  // COMMA
+    usages[56] = 0x37;  // PERIOD
+    usages[57] = 0xE2;  // ALT_LEFT
+    usages[58] = 0xE6;  // ALT_RIGHT
+    usages[59] = 0xE1;  // SHIFT_LEFT
+    usages[60] = 0xE5;  // SHIFT_RIGHT
+    usages[61] = 0x2B;  // TAB
+    usages[62] = 0x2C;  // SPACE
+    usages[66] = 0x28;  // ENTER
+    usages[67] = 0x2A;  // DEL (Backspace)
+    usages[68] = 0x35;  // GRAVE
+    usages[69] = 0x2D;  // MINUS
+    usages[70] = 0x2E;  // EQUALS
+    usages[71] = 0x2F;  // LEFT_BRACKET
+    usages[72] = 0x30;  // RIGHT_BRACKET
+    usages[73] = 0x31;  // BACKSLASH (also the ISO key, Android does not tell them apart)
+    usages[74] = 0x33;  // SEMICOLON
+    usages[75] = 0x34;  // APOSTROPHE
+    usages[76] = 0x38;  // SLASH
+    usages[111] = 0x29; // ESCAPE
+    usages[113] = 0xE0; // CTRL_LEFT
+    usages[114] = 0xE4; // CTRL_RIGHT
+    usages[115] = 0x39; // CAPS_LOCK
+    usages[117] = 0xE3; // META_LEFT
+    usages[118] = 0xE7; // META_RIGHT
+    usages[143] = 0x53; // NUM_LOCK
+    usages[144] = 0x62; // NUMPAD_0
+    for (int i = 0; i < 9; i++) {
+        usages[static_cast<size_t>(145 + i)] = static_cast<uint8_t>(0x59 + i); // NUMPAD_1..9
+    }
+    usages[154] = 0x54; // NUMPAD_DIVIDE
+    usages[155] = 0x55; // NUMPAD_MULTIPLY
+    usages[156] = 0x56; // NUMPAD_SUBTRACT
+    usages[157] = 0x57; // NUMPAD_ADD
+    usages[158] = 0x63; // NUMPAD_DOT
+    usages[160] = 0x58; // NUMPAD_ENTER
+    usages[161] = 0x67; // NUMPAD_EQUALS
+    return usages;
+}
+
+constexpr std::array<uint8_t, 256> makeLinuxUsages() {
+    std::array<uint8_t, 256> usages{};
+    // KEY_ESC (1) .. KEY_CAPSLOCK (58) follow the PC/AT scancode order
+    constexpr uint8_t main[] = {
+        0x29, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x2D, 0x2E, 0x2A, 0x2B, // ESC..TAB
+        0x14, 0x1A, 0x08, 0x15, 0x17, 0x1C, 0x18, 0x0C, 0x12, 0x13, 0x2F, 0x30, 0x28, 0xE0,       // Q..LEFTCTRL
+        0x04, 0x16, 0x07, 0x09, 0x0A, 0x0B, 0x0D, 0x0E, 0x0F, 0x33, 0x34, 0x35, 0xE1, 0x31,       // A..BACKSLASH
+        0x1D, 0x1B, 0x06, 0x19, 0x05, 0x11, 0x10, 0x36, 0x37, 0x38, 0xE5, 0x55, 0xE2, 0x2C, 0x39, // Z..CAPSLOCK
+    };
+    for (size_t i = 0; i < sizeof(main); i++) {
+        usages[1 + i] = main[i];
+    }
+    usages[69] = 0x53;  // KEY_NUMLOCK
+    usages[71] = 0x5F;  // KEY_KP7
+    usages[72] = 0x60;  // KEY_KP8
+    usages[73] = 0x61;  // KEY_KP9
+    usages[74] = 0x56;  // KEY_KPMINUS
+    usages[75] = 0x5C;  // KEY_KP4
+    usages[76] = 0x5D;  // KEY_KP5
+    usages[77] = 0x5E;  // KEY_KP6
+    usages[78] = 0x57;  // KEY_KPPLUS
+    usages[79] = 0x59;  // KEY_KP1
+    usages[80] = 0x5A;  // KEY_KP2
+    usages[81] = 0x5B;  // KEY_KP3
+    usages[82] = 0x62;  // KEY_KP0
+    usages[83] = 0x63;  // KEY_KPDOT
+    usages[86] = 0x64;  // KEY_102ND
+    usages[96] = 0x58;  // KEY_KPENTER
+    usages[97] = 0xE4;  // KEY_RIGHTCTRL
+    usages[98] = 0x54;  // KEY_KPSLASH
+    usages[100] = 0xE6; // KEY_RIGHTALT
+    usages[117] = 0x67; // KEY_KPEQUAL
+    usages[125] = 0xE3; // KEY_LEFTMETA
+    usages[126] = 0xE7; // KEY_RIGHTMETA
+    return usages;
+}
+
+// Usage -> keycode; the first keycode wins where several share a usage
+constexpr std::array<uint8_t, 256> invert(const std::array<uint8_t, 256>& usages) {
+    std::array<uint8_t, 256> keyCodes{};
+    for (size_t keyCode = 0; keyCode < usages.size(); keyCode++) {
+        if (usages[keyCode] != 0 && keyCodes[usages[keyCode]] == 0) {
+            keyCodes[usages[keyCode]] = static_cast<uint8_t>(keyCode);
+        }
+    }
+    return keyCodes;
+}
+
+inline constexpr LayoutTable kUs = makeUs();
+inline constexpr LayoutTable kGerman = makeGerman();
+inline constexpr LayoutTable kFrench = makeFrench();
+inline constexpr std::array<uint8_t, 256> kAndroidUsages = makeAndroidUsages();
+inline constexpr std::array<uint8_t, 256> kAndroidKeyCodes = invert(kAndroidUsages);
+inline constexpr std::array<uint8_t, 256> kLinuxUsages = makeLinuxUsages();
+inline constexpr std::array<uint8_t, 256> kLinuxKeyCodes = invert(kLinuxUsages);
+
+} // namespace keymap_detail
+
+// Translates platform keycodes into characters without the platform's help:
+// keycodes are mapped to HID usages, and per-layout tables give the
+// character of each usage on the base, Shift and AltGr levels. All tables
+// are built at compile time, so a key is a few array lookups.
+//
+// Dead keys (^ ´ ` ¨) produce their spacing character; scanners do not
+// compose accents.
+class Keymap {
+public:
+    // HID usages the scan pipeline cares about
+    static constexpr uint8_t kUsageEnter = 0x28;
+    static constexpr uint8_t kUsageTab = 0x2B;
+    static constexpr uint8_t kUsageCloseBracket = 0x30;
+    static constexpr uint8_t kUsageCapsLock = 0x39;
+    static constexpr uint8_t kUsageKeypadEnter = 0x58;
+    static constexpr uint8_t kUsageLeftCtrl = 0xE0;
+    static constexpr uint8_t kUsageRightGui = 0xE7;
+
+    // 0 if the keycode has no HID equivalent
+    static constexpr uint8_t usage(KeyCodeSet set, int keyCode) {
+        if (keyCode < 0 || keyCode >= 256) {
+            return 0;
+        }
+        switch (set) {
+            case KeyCodeSet::Android:
+                return keymap_detail::kAndroidUsages[static_cast<size_t>(keyCode)];
+            case KeyCodeSet::Linux:
+                return keymap_detail::kLinuxUsages[static_cast<size_t>(keyCode)];
+            case KeyCodeSet::Hid:
+            default:
+                return static_cast<uint8_t>(keyCode);
+        }
+    }
+
+    // Keycode of a usage in another set (0 if it has none), for sources
+    // whose keycodes differ from the platform's
+    static constexpr int keyCode(KeyCodeSet set, uint8_t usage) {
+        switch (set) {
+            case KeyCodeSet::Android:
+                return keymap_detail::kAndroidKeyCodes[usage];
+            case KeyCodeSet::Linux:
+                return keymap_detail::kLinuxKeyCodes[usage];
+            case KeyCodeSet::Hid:
+            default:
+                return usage;
+        }
+    }
+
+    static constexpr bool isModifier(uint8_t usage) {
+        return (usage >= kUsageLeftCtrl && usage <= kUsageRightGui) || usage == kUsageCapsLock;
+    }
+
+    static constexpr bool isEnter(uint8_t usage) { return usage == kUsageEnter || usage == kUsageKeypadEnter; }
+
+    // Updates the modifier state; returns false if usage is not a modifier
+    static constexpr bool updateModifiers(KeyModifiers& modifiers, uint8_t usage, bool down) {
+        if (usage == kUsageCapsLock) {
+            if (down) {
+                modifiers.capsLock = !modifiers.capsLock;
+            }
+            return true;
+        }
+        if (usage < kUsageLeftCtrl || usage > kUsageRightGui) {
+            return false;
+        }
+        const auto bit = static_cast<uint8_t>(1u << (usage - kUsageLeftCtrl));
+        modifiers.held = down ? static_cast<uint8_t>(modifiers.held | bit) : static_cast<uint8_t>(modifiers.held & ~bit);
+        return true;
+    }
+
+    // Character for a key-down, 0 if the key produces none
+    static constexpr char32_t translate(KeymapLayout layout, uint8_t usage, const KeyModifiers& modifiers) {
+        // Keyboard-wedge scanners send the GS1 FNC1 separator (GS) as Ctrl+]
+        if (usage == kUsageCloseBracket && modifiers.ctrl() && !modifiers.altGr()) {
+            return U'\x1D';
+        }
+        if (usage >= keymap_detail::kTableSize) {
+            return 0;
+        }
+        const keymap_detail::KeyLevels& key = table(layout)[usage];
+        if (modifiers.altGr()) {
+            return key.altGr;
+        }
+        const bool shifted = modifiers.shift() != (modifiers.capsLock && key.capsLock);
+        return shifted ? key.shifted : key.base;
+    }
+
+    // Writes c as UTF-8 (at most 4 bytes); returns the byte count
+    static constexpr size_t encodeUtf8(char32_t c, char* out) {
+        if (c < 0x80) {
+            out[0] = static_cast<char>(c);
+            return 1;
+        }
+        if (c < 0x800) {
+            out[0] = static_cast<char>(0xC0 | (c >> 6));
+            out[1] = static_cast<char>(0x80 | (c & 0x3F));
+            return 2;
+        }
+        if (c < 0x10000) {
+            out[0] = static_cast<char>(0xE0 | (c >> 12));
+            out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (c & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (c >> 18));
+        out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (c & 0x3F));
+        return 4;
+    }
+
+private:
+    static constexpr const keymap_detail::LayoutTable& table(KeymapLayout layout) {
+        switch (layout) {
+            case KeymapLayout::German:
+                return keymap_detail::kGerman;
+            case KeymapLayout::French:
+                return keymap_detail::kFrench;
+            case KeymapLayout::Platform:
+            case KeymapLayout::Us:
+            default:
+                return keymap_detail::kUs;
+        }
+    }
+};
+
+static_assert(Keymap::usage(KeyCodeSet::Android, 66) == Keymap::kUsageEnter, "KEYCODE_ENTER");
+static_assert(Keymap::usage(KeyCodeSet::Linux, 58) == Keymap::kUsageCapsLock, "KEY_CAPSLOCK");
+static_assert(Keymap::keyCode(KeyCodeSet::Android, Keymap::usage(KeyCodeSet::Linux, 30)) == 29, "KEY_A -> KEYCODE_A");
+static_assert(Keymap::translate(KeymapLayout::German, 0x1C, KeyModifiers{}) == U'z', "QWERTZ");
+static_assert(Keymap::translate(KeymapLayout::French, 0x1E, KeyModifiers{KeyModifiers::kLeftShift, false}) == U'1',
+              "AZERTY digits need Shift");
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,137 @@
+#include "KeywordMatcher.hpp"
+#include <deque>
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+constexpr int32_t kMissing = -1;
+
+unsigned char toLower(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+}
+
+struct Anchored {
+    std::string_view text;
+    bool start = false;
+    bool end = false;
+};
+
+Anchored stripAnchors(std::string_view text) {
+    Anchored anchored;
+    if (!text.empty() && text.front() == '^') {
+        anchored.start = true;
+        text.remove_prefix(1);
+    }
+    if (!text.empty() && text.back() == '$') {
+        anchored.end = true;
+        text.remove_suffix(1);
+    }
+    anchored.text = text;
+    return anchored;
+}
+
+} // namespace
+
+std::shared_ptr<const KeywordMatcher> KeywordMatcher::compile(const std::vector<Keyword>& keywords) {
+    std::shared_ptr<KeywordMatcher> matcher(new KeywordMatcher());
+
+    // One class per distinct (lowercased) keyword byte; uppercase letters
+    // share their lowercase class
+    for (const Keyword& keyword : keywords) {
+        for (char c : stripAnchors(keyword.text).text) {
+            const unsigned char lower = toLower(static_cast<unsigned char>(c));
+            if (matcher->_byteClass[lower] == kOtherClass) {
+                if (matcher->_classCount == 256) {
+                    return nullptr;
+                }
+                matcher->_byteClass[lower] = static_cast<uint8_t>(matcher->_classCount++);
+            }
+        }
+    }
+    for (int c = 'A'; c <= 'Z'; c++) {
+        matcher->_byteClass[static_cast<size_t>(c)] = matcher->_byteClass[static_cast<size_t>(c - 'A' + 'a')];
+    }
+    const size_t classCount = matcher->_classCount;
+
+    // Trie
+    std::vector<int32_t> transitions(classCount, kMissing);
+    std::vector<uint32_t> outputs(1, 0);
+    for (const Keyword& keyword : keywords) {
+        const Anchored anchored = stripAnchors(keyword.text);
+        if (anchored.text.empty()) {
+            return nullptr;
+        }
+
+        size_t state = 0;
+        auto step = [&](uint8_t byteClass) {
+            int32_t target = transitions[state * classCount + byteClass];
+            if (target == kMissing) {
+                target = static_cast<int32_t>(outputs.size());
+                transitions[state * classCount + byteClass] = target;
+                outputs.push_back(0);
+                transitions.resize(transitions.size() + classCount, kMissing);
+            }
+            state = static_cast<size_t>(target);
+        };
+        if (anchored.start) {
+            step(kStartClass);
+        }
+        for (char c : anchored.text) {
+            step(matcher->_byteClass[static_cast<unsigned char>(c)]);
+        }
+        if (anchored.end) {
+            step(kEndClass);
+        }
+        outputs[state] |= keyword.tags;
+        if (outputs.size() > kMaxStates) {
+            return nullptr;
+        }
+    }
+
+    // Resolve failure links breadth-first into plain transitions, so every
+    // state has a successor for every class
+    std::vector<int32_t> failure(outputs.size(), 0);
+    std::deque<size_t> queue;
+    for (size_t byteClass = 0; byteClass < classCount; byteClass++) {
+        int32_t& target = transitions[byteClass];
+        if (target == kMissing) {
+            target = 0;
+        } else {
+            queue.push_back(static_cast<size_t>(target));
+        }
+    }
+    while (!queue.empty()) {
+        const size_t state = queue.front();
+        queue.pop_front();
+        const size_t fallback = static_cast<size_t>(failure[state]);
+        for (size_t byteClass = 0; byteClass < classCount; byteClass++) {
+            int32_t& target = transitions[state * classCount + byteClass];
+            const int32_t viaFailure = transitions[fallback * classCount + byteClass];
+            if (target == kMissing) {
+                target = viaFailure;
+                continue;
+            }
+            failure[static_cast<size_t>(target)] = viaFailure;
+            outputs[static_cast<size_t>(target)] |= outputs[static_cast<size_t>(viaFailure)];
+            queue.push_back(static_cast<size_t>(target));
+        }
+    }
+
+    matcher->_transitions.assign(transitions.begin(), transitions.end());
+    matcher->_outputs = std::move(outputs);
+    return matcher;
+}
+
+uint32_t KeywordMatcher::match(std::string_view text) const {
+    uint16_t state = next(0, kStartClass);
+    uint32_t tags = _outputs[state];
+    for (char c : text) {
+        state = next(state, _byteClass[static_cast<unsigned char>(c)]);
+        tags |= _outputs[state];
+    }
+    state = next(state, kEndClass);
+    return tags | _outputs[state];
+}
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+struct Keyword {
+    std::string text; // '^' prefix / '$' suffix anchor it to the start / end
+    uint32_t tags = 0;
+};
+
+// Finds every keyword in a text in one pass: the keywords are compiled into
+// an Aho-Corasick automaton with all failure transitions resolved, over byte
+// classes, so matching is one table lookup per character however many
+// keywords there are. ASCII letters match case-insensitively.
+class KeywordMatcher {
+public:
+    static constexpr size_t kMaxStates = 4096;
+
+    // nullptr if a keyword is empty or the automaton outgrows kMaxStates
+    static std::shared_ptr<const KeywordMatcher> compile(const std::vector<Keyword>& keywords);
+
+    // Union of the tags of all keywords that occur in text
+    uint32_t match(std::string_view text) const;
+
+    size_t stateCount() const { return _outputs.size(); }
+
+private:
+    // Classes 0-2 are any other byte and the start/end of the text
+    static constexpr uint8_t kOtherClass = 0;
+    static constexpr uint8_t kStartClass = 1;
+    static constexpr uint8_t kEndClass = 2;
+
+    KeywordMatcher() = default;
+
+    uint16_t next(uint16_t state, uint8_t byteClass) const {
+        return _transitions[static_cast<size_t>(state) * _classCount + byteClass];
+    }
+
+    std::array<uint8_t, 256> _byteClass{};
+    size_t _classCount = 3;
+    std::vector<uint16_t> _transitions; // [state * _classCount + class]
+    std::vector<uint32_t> _outputs;     // tags of keywords ending here (suffixes included)
+};
+
+} // namespace margelo::nitro::externalscanner
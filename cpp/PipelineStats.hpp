@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace margelo::nitro::externalscanner {
+
+// Lock-free latency histogram in nanoseconds with HDR-style log-linear
+// buckets: each power of two is split into 8 sub-buckets, so any value is
+// reported within 12.5% over the whole 64-bit range in 496 buckets.
+// Recording is a few relaxed atomic adds, safe from any thread.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+    static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    static constexpr size_t bucketOf(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        const int shift = std::bit_width(value) - 1 - kSubBucketBits;
+        return static_cast<size_t>(shift + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+    }
+
+    // Highest value that falls into bucket
+    static constexpr uint64_t upperBound(size_t bucket) {
+        if (bucket < kSubBuckets) {
+            return bucket;
+        }
+        const int shift = static_cast<int>(bucket / kSubBuckets) - 1;
+        const uint64_t lower = (kSubBuckets + bucket % kSubBuckets) << shift;
+        return lower + ((uint64_t{1} << shift) - 1);
+    }
+
+    void record(std::chrono::steady_clock::duration duration) {
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record(static_cast<uint64_t>(std::max<int64_t>(ns, 0)));
+    }
+
+    void record(uint64_t ns) {
+        _buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = _max.load(std::memory_order_relaxed);
+        while (ns > max && !_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    struct Summary {
+        uint64_t count = 0;
+        double mean = 0.0;
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+        uint64_t p999 = 0;
+        uint64_t max = 0;
+    };
+
+    // Percentiles from a relaxed snapshot; records racing with it may be
+    // counted in some fields and not others
+    Summary summarize() const {
+        std::array<uint64_t, kBuckets> counts;
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            counts[i] = _buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        Summary summary;
+        if (total == 0) {
+            return summary;
+        }
+        summary.count = total;
+        summary.mean = static_cast<double>(_sum.load(std::memory_order_relaxed)) / static_cast<double>(total);
+        summary.max = _max.load(std::memory_order_relaxed);
+        auto percentile = [&](double fraction) {
+            const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < kBuckets; i++) {
+                seen += counts[i];
+                if (seen >= target) {
+                    return std::min(upperBound(i), summary.max);
+                }
+            }
+            return summary.max;
+        };
+        summary.p50 = percentile(0.5);
+        summary.p90 = percentile(0.9);
+        summary.p99 = percentile(0.99);
+        summary.p999 = percentile(0.999);
+        return summary;
+    }
+
+    void reset() {
+        for (std::atomic<uint64_t>& bucket : _buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> _buckets{};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _max{0};
+};
+
+static_assert(LatencyHistogram::bucketOf(7) == 7);
+static_assert(LatencyHistogram::bucketOf(8) == 8 && LatencyHistogram::bucketOf(15) == 15);
+static_assert(LatencyHistogram::bucketOf(16) == 16 && LatencyHistogram::bucketOf(17) == 16);
+static_assert(LatencyHistogram::bucketOf(UINT64_MAX) == LatencyHistogram::kBuckets - 1);
+static_assert(LatencyHistogram::upperBound(LatencyHistogram::bucketOf(1000)) >= 1000);
+
+enum class StatCounter : size_t {
+    KeysReceived,   // key-downs accepted while scanning
+    KeysIgnored,    // key-downs while not scanning
+    KeysDropped,    // key ring or assembler table full
+    ScansEmitted,
+    ScansTooShort,
+    ScansTimedOut,  // completed by the inter-key timeout instead of a terminator
+    ScansInvalid,
+    ScansDuplicate,
+    ScansUnrouted,
+    ScansOverflowed, // longer than the maximum scan length
+    Count
+};
+
+enum class PipelineStage : size_t {
+    KeyIngest, // key timestamp until the assembler picks it up
+    Assembly,  // scan completion until the result is ready to dispatch
+    Dispatch,  // result ready until its callback starts (batch wait included)
+    Callback,  // time spent inside the JS callback
+    Count
+};
+
+// Counters and stage latencies of the scan pipeline. Each counter sits on
+// its own cache line, as the input thread and the input loop bump
+// different ones concurrently.
+class PipelineStats {
+public:
+    // Returns the new value
+    uint64_t increment(StatCounter counter, uint64_t amount = 1) {
+        return _counters[static_cast<size_t>(counter)].value.fetch_add(amount, std::memory_order_relaxed) + amount;
+    }
+
+    uint64_t get(StatCounter counter) const {
+        return _counters[static_cast<size_t>(counter)].value.load(std::memory_order_relaxed);
+    }
+
+    LatencyHistogram& stage(PipelineStage stage) { return _stages[static_cast<size_t>(stage)]; }
+    const LatencyHistogram& stage(PipelineStage stage) const { return _stages[static_cast<size_t>(stage)]; }
+
+    void reset() {
+        for (PaddedCounter& counter : _counters) {
+            counter.value.store(0, std::memory_order_relaxed);
+        }
+        for (LatencyHistogram& histogram : _stages) {
+            histogram.reset();
+        }
+    }
+
+private:
+    struct alignas(64) PaddedCounter {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::array<PaddedCounter, static_cast<size_t>(StatCounter::Count)> _counters{};
+    std::array<LatencyHistogram, static_cast<size_t>(PipelineStage::Count)> _stages{};
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "InputSource.hpp"
+#include "KeyEventRing.hpp"
+#include <atomic>
+#include <functional>
+#include <utility>
+
+namespace margelo::nitro::externalscanner {
+
+// Hands keys from the platform's input thread to the InputLoop: push() into a
+// lock-free ring, then signal() once per burst. On the loop thread drain()
+// calls the consumer, which pops them.
+//
+// push()/signal() belong to one producer thread. pop() may be called from
+// other threads than the loop as long as the consumer serializes them (e.g.
+// under the same mutex), which is how stale keys are discarded.
+class PlatformKeySource : public InputSource {
+public:
+    static constexpr size_t kCapacity = 1024;
+
+    using Consumer = std::function<void(PlatformKeySource& keys)>;
+
+    explicit PlatformKeySource(Consumer consume) : _consume(std::move(consume)) {}
+
+    // Producer side; never blocks
+    bool push(const KeyEvent& event) { return _ring.push(event); }
+    void signal() {
+        // Only the first signal after a drain costs a syscall
+        if (!_signaled.exchange(true, std::memory_order_acq_rel)) {
+            _wake.signal();
+        }
+    }
+
+    // Consumer side
+    bool pop(KeyEvent& event) { return _ring.pop(event); }
+    bool empty() const { return _ring.empty(); }
+
+    bool start() override { return _wake.open(); }
+    void stop() override {}
+    int readinessFd() const override { return _wake.fd(); }
+    bool drain(InputSink&) override {
+        // Cleared before re-arming, so a signal from here on wakes us again
+        _wake.clear();
+        _signaled.exchange(false, std::memory_order_acq_rel);
+        _consume(*this);
+        return true;
+    }
+
+private:
+    const Consumer _consume;
+    SpscRing<KeyEvent, kCapacity> _ring;
+    std::atomic<bool> _signaled{false};
+    WakeFd _wake;
+};
+
+} // namespace margelo::nitro::externalscanner
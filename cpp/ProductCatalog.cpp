@@ -0,0 +1,206 @@
+#include "ProductCatalog.hpp"
+#include "ScannerLog.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ES_LOG_TAG "ExternalScanner Catalog"
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+// Interpolation steps before falling back to plain binary search, which
+// bounds the worst case for unlucky (clustered) hash ranges
+constexpr int kInterpolationSteps = 4;
+
+} // namespace
+
+ProductCatalog::ProductCatalog(const uint8_t* data, size_t size)
+    : _data(data), _size(size) {
+    const auto* header = reinterpret_cast<const CatalogHeader*>(data);
+    _count = header->count;
+    _entries = reinterpret_cast<const CatalogEntry*>(data + header->indexOffset);
+    _blob = reinterpret_cast<const char*>(data + header->blobOffset);
+    _blobSize = header->blobSize;
+}
+
+ProductCatalog::~ProductCatalog() {
+    munmap(const_cast<uint8_t*>(_data), _size);
+}
+
+std::shared_ptr<const ProductCatalog> ProductCatalog::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ES_LOGW("open: Cannot open catalog '" << path << "'");
+        return nullptr;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CatalogHeader)) {
+        ES_LOGW("open: Catalog '" << path << "' is too small");
+        ::close(fd);
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ES_LOGW("open: mmap failed for catalog '" << path << "'");
+        return nullptr;
+    }
+
+    // Only the header is checked here; entries are bounds-checked on lookup
+    const auto* header = static_cast<const CatalogHeader*>(mapping);
+    const bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+                       header->version == kVersion &&
+                       header->indexOffset % alignof(CatalogEntry) == 0 &&
+                       header->indexOffset <= size &&
+                       header->count <= (size - header->indexOffset) / sizeof(CatalogEntry) &&
+                       header->blobOffset <= size &&
+                       header->blobSize <= size - header->blobOffset;
+    if (!valid) {
+        ES_LOGW("open: '" << path << "' is not a valid catalog");
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    // Lookups jump around the index; don't let the kernel read ahead
+    madvise(mapping, size, MADV_RANDOM);
+
+    ES_LOGI("open: Mapped catalog '" << path << "' with " << header->count << " entries");
+    return std::shared_ptr<const ProductCatalog>(new ProductCatalog(static_cast<const uint8_t*>(mapping), size));
+}
+
+uint64_t ProductCatalog::hashKey(std::string_view key) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : key) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::optional<std::string_view> ProductCatalog::blobRange(uint64_t offset, uint64_t length) const {
+    if (offset > _blobSize || length > _blobSize - offset) {
+        return std::nullopt;
+    }
+    return std::string_view(_blob + offset, static_cast<size_t>(length));
+}
+
+std::optional<std::string_view> ProductCatalog::lookup(std::string_view code) const {
+    if (_count == 0) {
+        return std::nullopt;
+    }
+    const uint64_t hash = hashKey(code);
+
+    // Find the first entry with entry.hash >= hash in [lo, hi)
+    uint64_t lo = 0;
+    uint64_t hi = _count;
+    for (int step = 0; step < kInterpolationSteps && hi - lo > 8; step++) {
+        const uint64_t loHash = _entries[lo].hash;
+        const uint64_t hiHash = _entries[hi - 1].hash;
+        if (hash <= loHash || hash > hiHash) {
+            break;
+        }
+        const double fraction = static_cast<double>(hash - loHash) / static_cast<double>(hiHash - loHash);
+        uint64_t guess = lo + static_cast<uint64_t>(fraction * static_cast<double>(hi - 1 - lo));
+        guess = std::min(std::max(guess, lo), hi - 1);
+        if (_entries[guess].hash < hash) {
+            lo = guess + 1;
+        } else {
+            hi = guess + 1;
+            if (guess == lo || _entries[guess - 1].hash < hash) {
+                lo = guess;
+                break;
+            }
+        }
+    }
+    while (lo < hi) {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        if (_entries[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (uint64_t i = lo; i < _count && _entries[i].hash == hash; i++) {
+        const CatalogEntry& entry = _entries[i];
+        std::optional<std::string_view> key = blobRange(entry.keyOffset, entry.keyLength);
+        if (key && *key == code) {
+            return blobRange(entry.recordOffset, entry.recordLength);
+        }
+    }
+    return std::nullopt;
+}
+
+bool ProductCatalog::write(const std::string& path, std::vector<std::pair<std::string, std::string>> entries) {
+    // Keep the last occurrence of each key
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::vector<std::pair<std::string, std::string>> unique;
+    unique.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i + 1 < entries.size() && entries[i + 1].first == entries[i].first) {
+            continue;
+        }
+        if (entries[i].first.size() > UINT16_MAX) {
+            return false;
+        }
+        unique.push_back(std::move(entries[i]));
+    }
+
+    std::vector<CatalogEntry> index;
+    index.reserve(unique.size());
+    std::string blob;
+    for (const auto& [key, record] : unique) {
+        if (blob.size() + key.size() + record.size() > UINT32_MAX) {
+            return false;
+        }
+        CatalogEntry entry{};
+        entry.hash = hashKey(key);
+        entry.keyOffset = static_cast<uint32_t>(blob.size());
+        entry.keyLength = static_cast<uint16_t>(key.size());
+        blob += key;
+        entry.recordOffset = static_cast<uint32_t>(blob.size());
+        entry.recordLength = static_cast<uint32_t>(record.size());
+        blob += record;
+        index.push_back(entry);
+    }
+    std::sort(index.begin(), index.end(), [&blob](const CatalogEntry& a, const CatalogEntry& b) {
+        if (a.hash != b.hash) {
+            return a.hash < b.hash;
+        }
+        return std::string_view(blob).substr(a.keyOffset, a.keyLength) <
+               std::string_view(blob).substr(b.keyOffset, b.keyLength);
+    });
+
+    CatalogHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = index.size();
+    header.indexOffset = sizeof(CatalogHeader);
+    header.blobOffset = header.indexOffset + index.size() * sizeof(CatalogEntry);
+    header.blobSize = blob.size();
+
+    const std::string tempPath = path + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && (index.empty() || std::fwrite(index.data(), sizeof(CatalogEntry), index.size(), file) == index.size());
+    ok = ok && (blob.empty() || std::fwrite(blob.data(), 1, blob.size(), file) == blob.size());
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace margelo::nitro::externalscanner
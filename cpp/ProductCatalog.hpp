@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+// Read-only product catalog, memory-mapped so opening it costs the same for
+// ten SKUs or ten million and lookups never copy.
+//
+// File layout (little endian):
+//   Header   64 bytes, see CatalogHeader
+//   Index    count × CatalogEntry, sorted by (hash, key)
+//   Blob     key and record bytes referenced by the entries
+//
+// Keys are hashed with 64-bit FNV-1a. The hashes are uniformly distributed,
+// so lookups use interpolation search (a few probes even for millions of
+// entries) and then compare the key bytes to rule out collisions.
+class ProductCatalog {
+public:
+    static constexpr char kMagic[8] = {'E', 'S', 'C', 'A', 'T', 'L', 'G', '1'};
+    static constexpr uint32_t kVersion = 1;
+
+    struct CatalogHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t count;
+        uint64_t indexOffset;
+        uint64_t blobOffset;
+        uint64_t blobSize;
+        uint8_t padding[16];
+    };
+    static_assert(sizeof(CatalogHeader) == 64, "catalog header must stay 64 bytes");
+
+    struct CatalogEntry {
+        uint64_t hash;
+        uint32_t keyOffset;    // into the blob
+        uint32_t recordOffset; // into the blob
+        uint16_t keyLength;
+        uint16_t reserved;
+        uint32_t recordLength;
+    };
+    static_assert(sizeof(CatalogEntry) == 24, "catalog entries must stay 24 bytes");
+
+    ~ProductCatalog();
+    ProductCatalog(const ProductCatalog&) = delete;
+    ProductCatalog& operator=(const ProductCatalog&) = delete;
+
+    // Maps the file and checks its header; nullptr if it is not a valid catalog
+    static std::shared_ptr<const ProductCatalog> open(const std::string& path);
+
+    // Writes a catalog file (atomically, via a temporary file and rename).
+    // Later duplicates of a key replace earlier ones.
+    static bool write(const std::string& path, std::vector<std::pair<std::string, std::string>> entries);
+
+    static uint64_t hashKey(std::string_view key);
+
+    // View of the record for code, valid as long as the catalog is alive
+    std::optional<std::string_view> lookup(std::string_view code) const;
+
+    size_t size() const { return static_cast<size_t>(_count); }
+
+private:
+    ProductCatalog(const uint8_t* data, size_t size);
+
+    const uint8_t* _data;
+    size_t _size;
+    const CatalogEntry* _entries;
+    uint64_t _count;
+    const char* _blob;
+    uint64_t _blobSize;
+
+    std::optional<std::string_view> blobRange(uint64_t offset, uint64_t length) const;
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "KeyTimingStats.hpp"
+#include "Keymap.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace margelo::nitro::externalscanner {
+
+// Fixed-capacity inline character buffer, so appending a key never
+// allocates. Characters that do not fit are refused; the scanner applies
+// its overflow policy and marks the scan overflowed.
+class ScanBuffer {
+public:
+    static constexpr size_t kCapacity = 4096; // longest QR code in byte mode is 2953
+
+    // False (and nothing appended) if the characters do not fit in limit
+    bool append(std::string_view characters, size_t limit = kCapacity) {
+        if (_size + characters.size() > std::min(limit, kCapacity)) {
+            return false;
+        }
+        std::memcpy(_data.data() + _size, characters.data(), characters.size());
+        _size += characters.size();
+        return true;
+    }
+
+    void clear() {
+        _size = 0;
+        _overflowed = false;
+    }
+
+    void markOverflowed() { _overflowed = true; }
+    bool overflowed() const { return _overflowed; }
+
+    std::string_view view() const { return std::string_view(_data.data(), _size); }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+private:
+    std::array<char, kCapacity> _data;
+    size_t _size = 0;
+    bool _overflowed = false;
+};
+
+// Scan assembly state for one input device, so keystrokes from scanners
+// firing at the same time never interleave into one buffer.
+struct ScanAssembler {
+    int deviceId = 0;
+    ScanBuffer buffer;
+    std::chrono::steady_clock::time_point lastKeyTime;
+    double timeout = 50.0; // ms between keys before the scan is complete
+    int deadlineTimer = -1;
+
+    // Inter-key timing, used by adaptive timeouts. The gap after a
+    // terminator separates two scans and is not recorded.
+    KeyTimingStats timing;
+    bool afterTerminator = true;
+
+    // Shift/AltGr/Caps Lock state of this keyboard
+    KeyModifiers modifiers;
+};
+
+// Flat small-vector of assemblers keyed by deviceId. Terminals have a
+// handful of scanners, so a linear scan over contiguous slots beats any
+// node-based map and never allocates.
+class AssemblerTable {
+public:
+    static constexpr size_t kCapacity = 16;
+
+    ScanAssembler* find(int deviceId) {
+        for (size_t i = 0; i < _size; i++) {
+            if (_slots[i].deviceId == deviceId) {
+                return &_slots[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Returns nullptr when full; the caller decides what to evict
+    ScanAssembler* insert(int deviceId) {
+        if (_size == kCapacity) {
+            return nullptr;
+        }
+        ScanAssembler& assembler = _slots[_size++];
+        assembler.deviceId = deviceId;
+        assembler.buffer.clear();
+        assembler.lastKeyTime = {};
+        assembler.deadlineTimer = -1;
+        assembler.timing.reset();
+        assembler.afterTerminator = true;
+        assembler.modifiers = {};
+        return &assembler;
+    }
+
+    // Removes the assembler (swap-with-last, so pointers are invalidated)
+    void erase(int deviceId) {
+        for (size_t i = 0; i < _size; i++) {
+            if (_slots[i].deviceId == deviceId) {
+                if (i != _size - 1) {
+                    std::swap(_slots[i], _slots[_size - 1]);
+                }
+                _size--;
+                return;
+            }
+        }
+    }
+
+    // Least recently used assembler, preferring idle ones
+    ScanAssembler* evictionCandidate() {
+        ScanAssembler* candidate = nullptr;
+        for (size_t i = 0; i < _size; i++) {
+            ScanAssembler& assembler = _slots[i];
+            if (candidate == nullptr ||
+                (assembler.buffer.empty() && !candidate->buffer.empty()) ||
+                (assembler.buffer.empty() == candidate->buffer.empty() && assembler.lastKeyTime < candidate->lastKeyTime)) {
+                candidate = &assembler;
+            }
+        }
+        return candidate;
+    }
+
+    ScanAssembler* begin() { return _slots.data(); }
+    ScanAssembler* end() { return _slots.data() + _size; }
+    size_t size() const { return _size; }
+
+private:
+    std::array<ScanAssembler, kCapacity> _slots;
+    size_t _size = 0;
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,136 @@
+#include "ScanFramer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace margelo::nitro::externalscanner {
+
+std::unique_ptr<ScanFramer> ScanFramer::create(const FramingConfig& config, std::string& error) {
+    if (config.lengthHeaderBytes != 0 && config.lengthHeaderBytes != 1 && config.lengthHeaderBytes != 2 &&
+        config.lengthHeaderBytes != 4) {
+        error = "lengthHeaderBytes must be 1, 2 or 4";
+        return nullptr;
+    }
+    if (config.prefix.size() > kMaxAffix || config.suffix.size() > kMaxAffix) {
+        error = "prefix and suffix are limited to " + std::to_string(kMaxAffix) + " bytes";
+        return nullptr;
+    }
+    if (config.lengthHeaderBytes == 0 && config.terminators.empty() && config.suffix.empty()) {
+        error = "frames need a terminator, a suffix or a length header";
+        return nullptr;
+    }
+    return std::unique_ptr<ScanFramer>(new ScanFramer(config));
+}
+
+ScanFramer::ScanFramer(const FramingConfig& config)
+    : _prefix(config.prefix), _suffix(config.suffix), _headerBytes(config.lengthHeaderBytes) {
+    if (_headerBytes == 0) {
+        for (char c : config.terminators) {
+            _isTerminator[static_cast<uint8_t>(c)] = true;
+        }
+    }
+    _state = startState();
+}
+
+size_t ScanFramer::advancePrefix(size_t matched, char c) const {
+    // Prefixes are short, so trying every shorter match beats a KMP table
+    for (size_t k = std::min(matched + 1, _prefix.size()); k > 0; k--) {
+        if (_prefix[k - 1] == c && _prefix.compare(0, k - 1, _prefix, matched + 1 - k, k - 1) == 0) {
+            return k;
+        }
+    }
+    return 0;
+}
+
+size_t ScanFramer::consume(std::string_view bytes) {
+    size_t i = 0;
+    while (i < bytes.size() && !_complete) {
+        const char c = bytes[i++];
+        switch (_state) {
+            case State::Prefix:
+                _matched = advancePrefix(_matched, c);
+                if (_matched == _prefix.size()) {
+                    _matched = 0;
+                    _length = 0;
+                    _state = _headerBytes > 0 ? State::Header : State::Body;
+                }
+                break;
+
+            case State::Header:
+                _length = (_length << 8) | static_cast<uint8_t>(c);
+                if (++_matched == _headerBytes) {
+                    _matched = 0;
+                    if (_length == 0) {
+                        _state = startState();
+                    } else if (_length > kMaxFrame) {
+                        _droppedFrames++;
+                        _state = State::Skip;
+                    } else {
+                        _state = State::Body;
+                    }
+                }
+                break;
+
+            case State::Skip:
+                if (--_length == 0) {
+                    _state = startState();
+                }
+                break;
+
+            case State::Body:
+                if (_headerBytes > 0) {
+                    _frame[_size++] = c;
+                    if (--_length == 0) {
+                        if (!_suffix.empty() && _size >= _suffix.size() &&
+                            frame().substr(_size - _suffix.size()) == _suffix) {
+                            _size -= _suffix.size();
+                        }
+                        finishFrame();
+                    }
+                    break;
+                }
+                if (_isTerminator[static_cast<uint8_t>(c)]) {
+                    finishFrame();
+                    break;
+                }
+                if (_size == kMaxFrame) {
+                    // Too long: keep only enough to still spot the suffix
+                    _overflowed = true;
+                    std::memmove(_frame.data(), _frame.data() + _size - kMaxAffix, kMaxAffix);
+                    _size = kMaxAffix;
+                }
+                _frame[_size++] = c;
+                if (!_suffix.empty() && _size >= _suffix.size() && frame().substr(_size - _suffix.size()) == _suffix) {
+                    _size -= _suffix.size();
+                    finishFrame();
+                }
+                break;
+        }
+    }
+    return i;
+}
+
+void ScanFramer::finishFrame() {
+    _state = startState();
+    if (_overflowed) {
+        _droppedFrames++;
+        _overflowed = false;
+        _size = 0;
+    } else if (_size > 0) {
+        _complete = true;
+    }
+}
+
+void ScanFramer::clearFrame() {
+    _complete = false;
+    _size = 0;
+}
+
+void ScanFramer::reset() {
+    clearFrame();
+    _state = startState();
+    _matched = 0;
+    _length = 0;
+    _overflowed = false;
+}
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ScanAssembler.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace margelo::nitro::externalscanner {
+
+struct FramingConfig {
+    std::string terminators = "\r\n"; // any of these bytes ends a frame
+    std::string prefix;               // a frame starts after it; bytes before it are dropped
+    std::string suffix;               // ends a frame (not part of the code)
+    size_t lengthHeaderBytes = 0;     // 1, 2 or 4: frames are a big-endian length, then the code
+};
+
+// Splits a byte stream from a serial scanner into scans.
+//
+// Terminator framing: after the prefix (if any), bytes collect until a
+// terminator byte or the suffix; empty frames are skipped. Length framing:
+// after the prefix (if any), a big-endian length header, then that many
+// bytes, with the suffix stripped if they end in it. Frames longer than
+// kMaxFrame are dropped. Feeding never allocates.
+class ScanFramer {
+public:
+    static constexpr size_t kMaxAffix = 16;
+    static constexpr size_t kMaxFrame = ScanBuffer::kCapacity + kMaxAffix;
+
+    // Returns nullptr and describes the problem in error if the config is invalid
+    static std::unique_ptr<ScanFramer> create(const FramingConfig& config, std::string& error);
+
+    // Consumes bytes up to and including the end of the next frame; check
+    // hasFrame() afterwards. Returns the number of bytes consumed.
+    size_t consume(std::string_view bytes);
+    bool hasFrame() const { return _complete; }
+    std::string_view frame() const { return std::string_view(_frame.data(), _size); }
+    void clearFrame();
+
+    // Forgets any partial frame (e.g. after a reconnect)
+    void reset();
+    uint64_t droppedFrames() const { return _droppedFrames; }
+
+private:
+    enum class State : uint8_t { Prefix, Header, Body, Skip };
+
+    explicit ScanFramer(const FramingConfig& config);
+
+    State startState() const { return _prefix.empty() ? (_headerBytes > 0 ? State::Header : State::Body) : State::Prefix; }
+    // Length of the longest prefix of _prefix that ends the matched bytes plus c
+    size_t advancePrefix(size_t matched, char c) const;
+    void finishFrame();
+
+    std::string _prefix;
+    std::string _suffix;
+    size_t _headerBytes = 0;
+    std::array<bool, 256> _isTerminator{};
+
+    State _state = State::Body;
+    size_t _matched = 0;    // prefix bytes matched / header bytes read
+    uint32_t _length = 0;   // length framing: payload bytes still expected
+    bool _overflowed = false;
+    bool _complete = false;
+    uint64_t _droppedFrames = 0;
+    size_t _size = 0;
+    std::array<char, kMaxFrame> _frame;
+};
+
+} // namespace margelo::nitro::externalscanner
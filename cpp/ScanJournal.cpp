@@ -0,0 +1,403 @@
+#include "ScanJournal.hpp"
+#include "ScannerLog.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ES_LOG_TAG "ExternalScanner Journal"
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+constexpr char kSegmentMagic[8] = {'E', 'S', 'J', 'R', 'N', 'L', '0', '1'};
+constexpr size_t kSegmentHeaderSize = 32;
+constexpr size_t kRecordHeaderSize = 32;
+constexpr const char* kSegmentSuffix = ".journal";
+
+struct SegmentHeader {
+    char magic[8];
+    uint64_t firstSequence;
+    uint64_t reserved[2];
+};
+static_assert(sizeof(SegmentHeader) == kSegmentHeaderSize);
+
+struct RecordHeader {
+    uint32_t length;
+    uint32_t crc;
+    uint64_t sequence;
+    double timestamp;
+    int32_t deviceId;
+    uint32_t reserved;
+};
+static_assert(sizeof(RecordHeader) == kRecordHeaderSize);
+
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+constexpr std::array<uint32_t, 256> kCrcTable = makeCrcTable();
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = kCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+constexpr size_t recordSize(size_t codeLength) {
+    return (kRecordHeaderSize + codeLength + 7) & ~size_t{7};
+}
+
+// Calls f(header, code) for each intact record in sequence order and
+// returns the offset just past the last one
+template <typename F>
+size_t forEachRecord(const uint8_t* data, size_t size, F&& f) {
+    SegmentHeader segment;
+    std::memcpy(&segment, data, sizeof(segment));
+    uint64_t expected = segment.firstSequence;
+    size_t offset = kSegmentHeaderSize;
+    while (offset + kRecordHeaderSize <= size) {
+        RecordHeader header;
+        std::memcpy(&header, data + offset, sizeof(header));
+        if (header.length == 0 || header.length > ScanJournal::kMaxCodeLength ||
+            recordSize(header.length) > size - offset || header.sequence != expected ||
+            crc32(data + offset + 8, kRecordHeaderSize - 8 + header.length) != header.crc) {
+            break;
+        }
+        f(header, std::string_view(reinterpret_cast<const char*>(data + offset + kRecordHeaderSize), header.length));
+        offset += recordSize(header.length);
+        expected++;
+    }
+    return offset;
+}
+
+bool validSegment(const uint8_t* data, size_t size) {
+    return size >= kSegmentHeaderSize && std::memcmp(data, kSegmentMagic, sizeof(kSegmentMagic)) == 0;
+}
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+} // namespace
+
+ScanJournal::ScanJournal(std::string directory, size_t segmentSize)
+    : _directory(std::move(directory)), _segmentSize(segmentSize) {}
+
+ScanJournal::~ScanJournal() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_data != nullptr && _syncPending) {
+        msync(_data, _mappedSize, MS_ASYNC);
+    }
+    closeSegment();
+    if (_ackFd >= 0) {
+        ::close(_ackFd);
+    }
+}
+
+std::unique_ptr<ScanJournal> ScanJournal::open(const std::string& directory, size_t segmentSize) {
+    if (segmentSize < kSegmentHeaderSize + recordSize(kMaxCodeLength)) {
+        ES_LOGE("open: Segment size " << segmentSize << " is too small");
+        return nullptr;
+    }
+    if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        ES_LOGE("open: Cannot create journal directory '" << directory << "': " << std::strerror(errno));
+        return nullptr;
+    }
+    std::unique_ptr<ScanJournal> journal(new ScanJournal(directory, segmentSize));
+    std::lock_guard<std::mutex> lock(journal->_mutex);
+    if (!journal->recover()) {
+        return nullptr;
+    }
+    ES_LOGI("open: Journal '" << directory << "' at sequence " << journal->_nextSequence - 1
+            << ", acknowledged " << journal->_acknowledged);
+    return journal;
+}
+
+std::string ScanJournal::segmentPath(uint64_t firstSequence) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu", static_cast<unsigned long long>(firstSequence));
+    return _directory + "/" + name + kSegmentSuffix;
+}
+
+bool ScanJournal::recover() {
+    _ackFd = ::open((_directory + "/acknowledged").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (_ackFd < 0) {
+        ES_LOGE("recover: Cannot open acknowledged file: " << std::strerror(errno));
+        return false;
+    }
+    uint64_t acknowledged = 0;
+    if (pread(_ackFd, &acknowledged, sizeof(acknowledged), 0) == sizeof(acknowledged)) {
+        _acknowledged = acknowledged;
+    }
+
+    DIR* dir = opendir(_directory.c_str());
+    if (dir == nullptr) {
+        ES_LOGE("recover: Cannot list '" << _directory << "'");
+        return false;
+    }
+    const size_t suffixLength = std::strlen(kSegmentSuffix);
+    while (dirent* entry = readdir(dir)) {
+        std::string_view name(entry->d_name);
+        if (name.size() != 20 + suffixLength || name.substr(20) != kSegmentSuffix) {
+            continue;
+        }
+        uint64_t firstSequence = 0;
+        bool digits = true;
+        for (char c : name.substr(0, 20)) {
+            digits &= c >= '0' && c <= '9';
+            firstSequence = firstSequence * 10 + static_cast<uint64_t>(c - '0');
+        }
+        if (digits) {
+            _segments.push_back({firstSequence, _directory + "/" + std::string(name)});
+        }
+    }
+    closedir(dir);
+    std::sort(_segments.begin(), _segments.end(),
+              [](const Segment& a, const Segment& b) { return a.firstSequence < b.firstSequence; });
+
+    if (_segments.empty()) {
+        _nextSequence = _acknowledged + 1;
+        _segments.push_back({_nextSequence, segmentPath(_nextSequence)});
+        return openSegment(_segments.back(), true);
+    }
+
+    if (!openSegment(_segments.back(), false)) {
+        return false;
+    }
+    SegmentHeader header;
+    std::memcpy(&header, _data, sizeof(header));
+    _nextSequence = header.firstSequence;
+    _writeOffset = forEachRecord(_data, _mappedSize, [this](const RecordHeader& record, std::string_view) {
+        _nextSequence = record.sequence + 1;
+    });
+
+    // Clear a torn record left by a crash so it is not mistaken for data later
+    if (_writeOffset + sizeof(uint32_t) <= _mappedSize) {
+        uint32_t length;
+        std::memcpy(&length, _data + _writeOffset, sizeof(length));
+        if (length != 0) {
+            ES_LOGW("recover: Discarding torn record at offset " << _writeOffset);
+            std::memset(_data + _writeOffset, 0, _mappedSize - _writeOffset);
+        }
+    }
+    _syncedOffset = _writeOffset;
+    // Sequences must stay contiguous within a segment, so if everything here
+    // was acknowledged beyond what survived, the next append starts a new one
+    if (_acknowledged >= _nextSequence) {
+        _nextSequence = _acknowledged + 1;
+        closeSegment();
+    }
+    prune();
+    return true;
+}
+
+bool ScanJournal::openSegment(const Segment& segment, bool create) {
+    int fd = ::open(segment.path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0), 0600);
+    if (fd < 0) {
+        ES_LOGE("openSegment: Cannot open '" << segment.path << "': " << std::strerror(errno));
+        return false;
+    }
+    size_t size = _segmentSize;
+    struct stat st{};
+    if (create ? ftruncate(fd, static_cast<off_t>(size)) != 0 : fstat(fd, &st) != 0) {
+        ES_LOGE("openSegment: Cannot size '" << segment.path << "': " << std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    if (!create) {
+        size = static_cast<size_t>(st.st_size);
+    }
+    void* mapping = size >= kSegmentHeaderSize ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ES_LOGE("openSegment: Cannot map '" << segment.path << "'");
+        return false;
+    }
+
+    _data = static_cast<uint8_t*>(mapping);
+    _mappedSize = size;
+    if (create) {
+        SegmentHeader header{};
+        std::memcpy(header.magic, kSegmentMagic, sizeof(kSegmentMagic));
+        header.firstSequence = segment.firstSequence;
+        std::memcpy(_data, &header, sizeof(header));
+        _writeOffset = kSegmentHeaderSize;
+        _syncedOffset = 0; // the header still has to reach storage
+    } else if (!validSegment(_data, size)) {
+        ES_LOGE("openSegment: '" << segment.path << "' is not a journal segment");
+        closeSegment();
+        return false;
+    }
+    return true;
+}
+
+void ScanJournal::closeSegment() {
+    if (_data != nullptr) {
+        munmap(_data, _mappedSize);
+        _data = nullptr;
+    }
+}
+
+bool ScanJournal::rotate() {
+    if (_data != nullptr) {
+        // Rare (once per segment), so flush the old tail synchronously
+        if (_syncPending) {
+            const size_t start = _syncedOffset & ~(pageSize() - 1);
+            msync(_data + start, _writeOffset - start, MS_SYNC);
+        }
+        closeSegment();
+    }
+    Segment segment{_nextSequence, segmentPath(_nextSequence)};
+    if (!openSegment(segment, true)) {
+        return false;
+    }
+    _segments.push_back(segment);
+    prune();
+    return true;
+}
+
+void ScanJournal::prune() {
+    // A segment is done once the next one starts at or before the acknowledged point
+    while (_segments.size() > 1 && _segments[1].firstSequence - 1 <= _acknowledged) {
+        unlink(_segments.front().path.c_str());
+        _segments.erase(_segments.begin());
+    }
+}
+
+uint64_t ScanJournal::append(std::string_view code, double timestamp, int32_t deviceId, bool* wasClean) {
+    if (code.empty() || code.size() > kMaxCodeLength) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    const size_t size = recordSize(code.size());
+    if ((_data == nullptr || _writeOffset + size > _mappedSize) && !rotate()) {
+        return 0;
+    }
+
+    RecordHeader header{};
+    header.length = static_cast<uint32_t>(code.size());
+    header.sequence = _nextSequence;
+    header.timestamp = timestamp;
+    header.deviceId = deviceId;
+
+    uint8_t* record = _data + _writeOffset;
+    std::memcpy(record + 8, reinterpret_cast<const uint8_t*>(&header) + 8, kRecordHeaderSize - 8);
+    std::memcpy(record + kRecordHeaderSize, code.data(), code.size());
+    header.crc = crc32(record + 8, kRecordHeaderSize - 8 + code.size());
+    std::memcpy(record + 4, &header.crc, sizeof(header.crc));
+    // Length goes last: until it is set the record reads as the end of the log
+    std::memcpy(record, &header.length, sizeof(header.length));
+
+    if (wasClean != nullptr) {
+        *wasClean = !_syncPending;
+    }
+    _syncPending = true;
+    _writeOffset += size;
+    return _nextSequence++;
+}
+
+void ScanJournal::sync() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_data == nullptr || !_syncPending) {
+        return;
+    }
+    const size_t start = _syncedOffset & ~(pageSize() - 1);
+    msync(_data + start, _writeOffset - start, MS_SYNC);
+    _syncedOffset = _writeOffset;
+    _syncPending = false;
+}
+
+void ScanJournal::readSegment(const uint8_t* data, size_t size, uint64_t fromSequence, size_t limit,
+                              std::vector<JournalRecord>& out) const {
+    forEachRecord(data, size, [&](const RecordHeader& header, std::string_view code) {
+        if (header.sequence >= fromSequence && out.size() < limit) {
+            out.push_back({header.sequence, header.timestamp, header.deviceId, std::string(code)});
+        }
+    });
+}
+
+std::vector<JournalRecord> ScanJournal::read(uint64_t afterSequence, size_t limit) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<JournalRecord> records;
+    const uint64_t from = std::max(afterSequence, _acknowledged) + 1;
+    for (size_t i = 0; i < _segments.size() && records.size() < limit; i++) {
+        if (i + 1 < _segments.size() && _segments[i + 1].firstSequence <= from) {
+            continue;
+        }
+        if (i + 1 == _segments.size()) {
+            if (_data != nullptr) {
+                readSegment(_data, _writeOffset, from, limit, records);
+            }
+            continue;
+        }
+
+        // Older segments are mapped read-only just for the read
+        int fd = ::open(_segments[i].path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st{};
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            continue;
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* mapping = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            continue;
+        }
+        if (validSegment(static_cast<const uint8_t*>(mapping), size)) {
+            readSegment(static_cast<const uint8_t*>(mapping), size, from, limit, records);
+        }
+        munmap(mapping, size);
+    }
+    return records;
+}
+
+void ScanJournal::acknowledge(uint64_t sequence) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    sequence = std::min(sequence, _nextSequence - 1);
+    if (sequence <= _acknowledged) {
+        return;
+    }
+    _acknowledged = sequence;
+    writeAcknowledged();
+    prune();
+}
+
+void ScanJournal::writeAcknowledged() {
+    // Losing this write only means some scans are replayed again
+    if (pwrite(_ackFd, &_acknowledged, sizeof(_acknowledged), 0) != sizeof(_acknowledged)) {
+        ES_LOGW("writeAcknowledged: " << std::strerror(errno));
+    }
+}
+
+uint64_t ScanJournal::lastSequence() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nextSequence - 1;
+}
+
+uint64_t ScanJournal::acknowledgedSequence() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _acknowledged;
+}
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+struct JournalRecord {
+    uint64_t sequence = 0;
+    double timestamp = 0.0;
+    int32_t deviceId = 0;
+    std::string code;
+};
+
+// Append-only journal of completed scans, so scans survive a JS reload or
+// the app being killed before JS persisted them.
+//
+// The journal is a directory of fixed-size segments named after their first
+// sequence number. Each segment is preallocated and mapped read-write, so an
+// append is a memcpy into the page cache (it survives the process dying);
+// sync() flushes it to storage. Every record is CRC-32 framed, and recovery
+// stops at the first torn or corrupt record.
+//
+// Segment: 32-byte header, then records padded to 8 bytes:
+//   uint32 length (code bytes, 0 = end), uint32 crc (of everything after it),
+//   uint64 sequence, double timestamp, int32 deviceId, uint32 reserved, code
+//
+// Acknowledged sequences are kept in a small `acknowledged` file; segments
+// that only hold acknowledged records are deleted.
+class ScanJournal {
+public:
+    static constexpr size_t kDefaultSegmentSize = 1 << 20;
+    static constexpr size_t kMaxCodeLength = 4096;
+
+    ~ScanJournal();
+    ScanJournal(const ScanJournal&) = delete;
+    ScanJournal& operator=(const ScanJournal&) = delete;
+
+    // Opens (creating if needed) the journal in directory; nullptr on failure
+    static std::unique_ptr<ScanJournal> open(const std::string& directory, size_t segmentSize = kDefaultSegmentSize);
+
+    // Appends a record and returns its sequence number, or 0 on failure.
+    // wasClean is set when nothing was waiting for sync() before this append.
+    uint64_t append(std::string_view code, double timestamp, int32_t deviceId, bool* wasClean = nullptr);
+
+    // Unacknowledged records with sequence > afterSequence, oldest first
+    std::vector<JournalRecord> read(uint64_t afterSequence, size_t limit);
+
+    // Marks every record up to and including sequence as processed
+    void acknowledge(uint64_t sequence);
+
+    // Flushes appended records to storage
+    void sync();
+
+    uint64_t lastSequence();
+    uint64_t acknowledgedSequence();
+
+private:
+    struct Segment {
+        uint64_t firstSequence;
+        std::string path;
+    };
+
+    ScanJournal(std::string directory, size_t segmentSize);
+
+    bool recover();
+    bool openSegment(const Segment& segment, bool create);
+    void closeSegment();
+    bool rotate();
+    void prune();
+    void readSegment(const uint8_t* data, size_t size, uint64_t fromSequence, size_t limit,
+                     std::vector<JournalRecord>& out) const;
+    std::string segmentPath(uint64_t firstSequence) const;
+    void writeAcknowledged();
+
+    std::mutex _mutex;
+    const std::string _directory;
+    const size_t _segmentSize;
+
+    std::vector<Segment> _segments; // oldest first; the last one is mapped
+    uint8_t* _data = nullptr;
+    size_t _mappedSize = 0;
+    size_t _writeOffset = 0;
+    size_t _syncedOffset = 0; // everything before this is on storage
+    bool _syncPending = false;
+
+    uint64_t _nextSequence = 1;
+    uint64_t _acknowledged = 0;
+    int _ackFd = -1;
+};
+
+} // namespace margelo::nitro::externalscanner
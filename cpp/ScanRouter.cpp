@@ -0,0 +1,523 @@
+#include "ScanRouter.hpp"
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <map>
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+using CharSet = std::bitset<256>;
+
+constexpr int kMaxRepeat = 100;
+constexpr size_t kMaxNfaStates = 20000;
+
+// Parsed pattern
+struct Node {
+    enum class Kind { Set, Concat, Alternation, Repeat };
+    Kind kind = Kind::Concat;
+    CharSet set;
+    std::vector<std::unique_ptr<Node>> children;
+    int min = 1;
+    int max = 1; // -1 = unbounded
+};
+using NodePtr = std::unique_ptr<Node>;
+
+NodePtr makeSet(const CharSet& set) {
+    auto node = std::make_unique<Node>();
+    node->kind = Node::Kind::Set;
+    node->set = set;
+    return node;
+}
+
+CharSet charRange(unsigned char from, unsigned char to) {
+    CharSet set;
+    for (int c = from; c <= to; c++) {
+        set.set(static_cast<size_t>(c));
+    }
+    return set;
+}
+
+class PatternParser {
+public:
+    explicit PatternParser(std::string_view pattern) : _pattern(pattern) {}
+
+    NodePtr parse(std::string& error) {
+        if (!_pattern.empty() && _pattern.front() == '^') {
+            _pattern.remove_prefix(1);
+        }
+        if (_pattern.size() >= 1 && _pattern.back() == '$' &&
+            (_pattern.size() < 2 || _pattern[_pattern.size() - 2] != '\\')) {
+            _pattern.remove_suffix(1);
+        }
+
+        NodePtr node = parseAlternation();
+        if (_error.empty() && _pos < _pattern.size()) {
+            fail("unbalanced ')'");
+        }
+        if (!_error.empty()) {
+            error = _error;
+            return nullptr;
+        }
+        return node;
+    }
+
+private:
+    std::string_view _pattern;
+    size_t _pos = 0;
+    std::string _error;
+
+    bool atEnd() const { return _pos >= _pattern.size(); }
+    char peek() const { return _pattern[_pos]; }
+
+    NodePtr fail(const std::string& message) {
+        if (_error.empty()) {
+            _error = message + " at offset " + std::to_string(_pos);
+        }
+        return nullptr;
+    }
+
+    NodePtr parseAlternation() {
+        NodePtr first = parseConcat();
+        if (!first || atEnd() || peek() != '|') {
+            return first;
+        }
+        auto node = std::make_unique<Node>();
+        node->kind = Node::Kind::Alternation;
+        node->children.push_back(std::move(first));
+        while (!atEnd() && peek() == '|') {
+            _pos++;
+            NodePtr branch = parseConcat();
+            if (!branch) {
+                return nullptr;
+            }
+            node->children.push_back(std::move(branch));
+        }
+        return node;
+    }
+
+    NodePtr parseConcat() {
+        auto node = std::make_unique<Node>();
+        node->kind = Node::Kind::Concat;
+        while (!atEnd() && peek() != '|' && peek() != ')') {
+            NodePtr item = parseRepeat();
+            if (!item) {
+                return nullptr;
+            }
+            node->children.push_back(std::move(item));
+        }
+        return node;
+    }
+
+    NodePtr parseRepeat() {
+        NodePtr atom = parseAtom();
+        while (atom && !atEnd()) {
+            int min = 0;
+            int max = -1;
+            const char c = peek();
+            if (c == '*') {
+                _pos++;
+            } else if (c == '+') {
+                min = 1;
+                _pos++;
+            } else if (c == '?') {
+                max = 1;
+                _pos++;
+            } else if (c == '{') {
+                _pos++;
+                if (!parseCount(min)) {
+                    return fail("expected repeat count");
+                }
+                max = min;
+                if (!atEnd() && peek() == ',') {
+                    _pos++;
+                    max = -1;
+                    if (!atEnd() && peek() != '}' && !parseCount(max)) {
+                        return fail("expected repeat count");
+                    }
+                }
+                if (atEnd() || peek() != '}') {
+                    return fail("expected '}'");
+                }
+                _pos++;
+                if (max != -1 && max < min) {
+                    return fail("repeat range out of order");
+                }
+            } else {
+                break;
+            }
+            auto node = std::make_unique<Node>();
+            node->kind = Node::Kind::Repeat;
+            node->min = min;
+            node->max = max;
+            node->children.push_back(std::move(atom));
+            atom = std::move(node);
+        }
+        return atom;
+    }
+
+    bool parseCount(int& count) {
+        size_t start = _pos;
+        count = 0;
+        while (!atEnd() && peek() >= '0' && peek() <= '9' && count <= kMaxRepeat) {
+            count = count * 10 + (peek() - '0');
+            _pos++;
+        }
+        return _pos > start && count <= kMaxRepeat;
+    }
+
+    NodePtr parseAtom() {
+        const char c = peek();
+        switch (c) {
+            case '(': {
+                _pos++;
+                if (_pattern.substr(_pos, 2) == "?:") {
+                    _pos += 2;
+                }
+                NodePtr inner = parseAlternation();
+                if (!inner) {
+                    return nullptr;
+                }
+                if (atEnd() || peek() != ')') {
+                    return fail("expected ')'");
+                }
+                _pos++;
+                return inner;
+            }
+            case '[':
+                _pos++;
+                return parseClass();
+            case '.':
+                _pos++;
+                return makeSet(CharSet().set());
+            case '\\': {
+                _pos++;
+                CharSet set;
+                if (!parseEscape(set)) {
+                    return nullptr;
+                }
+                return makeSet(set);
+            }
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+                return fail("nothing to repeat");
+            default:
+                _pos++;
+                return makeSet(CharSet().set(static_cast<unsigned char>(c)));
+        }
+    }
+
+    bool parseEscape(CharSet& set) {
+        if (atEnd()) {
+            fail("trailing '\\'");
+            return false;
+        }
+        const char c = peek();
+        _pos++;
+        switch (c) {
+            case 'd': set = charRange('0', '9'); break;
+            case 'D': set = ~charRange('0', '9'); break;
+            case 'w': set = charRange('0', '9') | charRange('A', 'Z') | charRange('a', 'z') | CharSet().set('_'); break;
+            case 'W': set = ~(charRange('0', '9') | charRange('A', 'Z') | charRange('a', 'z') | CharSet().set('_')); break;
+            case 's': set = charRange('\t', '\r') | CharSet().set(' '); break;
+            case 'S': set = ~(charRange('\t', '\r') | CharSet().set(' ')); break;
+            case 't': set.set('\t'); break;
+            case 'n': set.set('\n'); break;
+            case 'r': set.set('\r'); break;
+            default: set.set(static_cast<unsigned char>(c)); break;
+        }
+        return true;
+    }
+
+    NodePtr parseClass() {
+        CharSet set;
+        bool negate = false;
+        if (!atEnd() && peek() == '^') {
+            negate = true;
+            _pos++;
+        }
+        bool first = true;
+        while (!atEnd() && (peek() != ']' || first)) {
+            first = false;
+            CharSet item;
+            unsigned char from = static_cast<unsigned char>(peek());
+            if (peek() == '\\') {
+                _pos++;
+                if (!parseEscape(item)) {
+                    return nullptr;
+                }
+                set |= item;
+                continue;
+            }
+            _pos++;
+            if (_pos + 1 < _pattern.size() && peek() == '-' && _pattern[_pos + 1] != ']') {
+                const auto to = static_cast<unsigned char>(_pattern[_pos + 1]);
+                if (to < from) {
+                    return fail("character range out of order");
+                }
+                _pos += 2;
+                set |= charRange(from, to);
+            } else {
+                set.set(from);
+            }
+        }
+        if (atEnd()) {
+            return fail("expected ']'");
+        }
+        _pos++;
+        return makeSet(negate ? ~set : set);
+    }
+};
+
+// Thompson NFA for all rules together
+struct Nfa {
+    struct State {
+        std::vector<std::pair<size_t, int>> edges; // (set index, target)
+        std::vector<int> epsilon;
+        int acceptRule = -1;
+    };
+    std::vector<State> states;
+    std::vector<CharSet> sets;
+
+    int addState() {
+        states.emplace_back();
+        return static_cast<int>(states.size() - 1);
+    }
+
+    size_t addSet(const CharSet& set) {
+        for (size_t i = 0; i < sets.size(); i++) {
+            if (sets[i] == set) {
+                return i;
+            }
+        }
+        sets.push_back(set);
+        return sets.size() - 1;
+    }
+
+    void addEdge(int from, const CharSet& set, int to) {
+        const size_t index = addSet(set);
+        states[static_cast<size_t>(from)].edges.emplace_back(index, to);
+    }
+
+    void addEpsilon(int from, int to) {
+        states[static_cast<size_t>(from)].epsilon.push_back(to);
+    }
+
+    // Builds the fragment for node starting at start; returns its end state
+    int build(const Node& node, int start) {
+        if (states.size() > kMaxNfaStates) {
+            return start;
+        }
+        switch (node.kind) {
+            case Node::Kind::Set: {
+                int end = addState();
+                addEdge(start, node.set, end);
+                return end;
+            }
+            case Node::Kind::Concat: {
+                int current = start;
+                for (const NodePtr& child : node.children) {
+                    current = build(*child, current);
+                }
+                return current;
+            }
+            case Node::Kind::Alternation: {
+                int end = addState();
+                for (const NodePtr& child : node.children) {
+                    int branch = addState();
+                    addEpsilon(start, branch);
+                    addEpsilon(build(*child, branch), end);
+                }
+                return end;
+            }
+            case Node::Kind::Repeat: {
+                const Node& child = *node.children.front();
+                int current = start;
+                for (int i = 0; i < node.min; i++) {
+                    current = build(child, current);
+                }
+                if (node.max == -1) {
+                    int loop = addState();
+                    addEpsilon(current, loop);
+                    addEpsilon(build(child, loop), loop);
+                    return loop;
+                }
+                std::vector<int> skips;
+                for (int i = node.min; i < node.max; i++) {
+                    skips.push_back(current);
+                    current = build(child, current);
+                }
+                for (int skip : skips) {
+                    addEpsilon(skip, current);
+                }
+                return current;
+            }
+        }
+        return start;
+    }
+
+    void closure(std::vector<int>& set) const {
+        std::vector<bool> seen(states.size(), false);
+        std::vector<int> stack(set.begin(), set.end());
+        set.clear();
+        while (!stack.empty()) {
+            int state = stack.back();
+            stack.pop_back();
+            if (seen[static_cast<size_t>(state)]) {
+                continue;
+            }
+            seen[static_cast<size_t>(state)] = true;
+            set.push_back(state);
+            for (int next : states[static_cast<size_t>(state)].epsilon) {
+                stack.push_back(next);
+            }
+        }
+        std::sort(set.begin(), set.end());
+    }
+};
+
+} // namespace
+
+std::shared_ptr<const ScanRouter> ScanRouter::compile(const std::vector<RouteRule>& rules, std::string& error) {
+    if (rules.size() > kMaxRules) {
+        error = "at most " + std::to_string(kMaxRules) + " rules are supported";
+        return nullptr;
+    }
+
+    Nfa nfa;
+    const int start = nfa.addState();
+    for (size_t i = 0; i < rules.size(); i++) {
+        const RouteRule& rule = rules[i];
+        if (rule.minLength > rule.maxLength) {
+            error = "rule '" + rule.id + "': minLength > maxLength";
+            return nullptr;
+        }
+
+        int current = nfa.addState();
+        nfa.addEpsilon(start, current);
+        for (char c : rule.prefix) {
+            int next = nfa.addState();
+            nfa.addEdge(current, CharSet().set(static_cast<unsigned char>(c)), next);
+            current = next;
+        }
+
+        // Without a pattern, anything may follow the prefix
+        std::string patternError;
+        PatternParser parser(rule.pattern.empty() ? std::string_view(".*") : std::string_view(rule.pattern));
+        NodePtr pattern = parser.parse(patternError);
+        if (!pattern) {
+            error = "rule '" + rule.id + "': " + patternError;
+            return nullptr;
+        }
+        current = nfa.build(*pattern, current);
+        nfa.states[static_cast<size_t>(current)].acceptRule = static_cast<int>(i);
+
+        if (nfa.states.size() > kMaxNfaStates) {
+            error = "rule '" + rule.id + "': pattern too large";
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<ScanRouter> router(new ScanRouter());
+    router->_rules = rules;
+
+    // Bytes that no pattern tells apart share a class (and a table column)
+    std::map<std::vector<bool>, uint8_t> classes;
+    std::vector<unsigned char> representative;
+    for (int b = 0; b < 256; b++) {
+        std::vector<bool> signature(nfa.sets.size());
+        for (size_t s = 0; s < nfa.sets.size(); s++) {
+            signature[s] = nfa.sets[s].test(static_cast<size_t>(b));
+        }
+        auto [it, inserted] = classes.emplace(std::move(signature), static_cast<uint8_t>(classes.size()));
+        if (inserted) {
+            representative.push_back(static_cast<unsigned char>(b));
+        }
+        router->_byteClass[static_cast<size_t>(b)] = it->second;
+    }
+    router->_classCount = representative.size();
+
+    // Subset construction; DFA state 0 is the dead state
+    std::map<std::vector<int>, uint16_t> ids;
+    std::vector<std::vector<int>> pending;
+    auto stateFor = [&](std::vector<int>&& set) -> int {
+        if (set.empty()) {
+            return 0;
+        }
+        auto it = ids.find(set);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        if (router->_accepting.size() >= kMaxStates) {
+            return -1;
+        }
+        const auto id = static_cast<uint16_t>(router->_accepting.size());
+        uint64_t accepting = 0;
+        for (int state : set) {
+            int rule = nfa.states[static_cast<size_t>(state)].acceptRule;
+            if (rule >= 0) {
+                accepting |= uint64_t{1} << rule;
+            }
+        }
+        router->_accepting.push_back(accepting);
+        router->_transitions.resize(router->_accepting.size() * router->_classCount, 0);
+        ids.emplace(set, id);
+        pending.push_back(std::move(set));
+        return id;
+    };
+
+    router->_accepting.push_back(0);
+    router->_transitions.resize(router->_classCount, 0);
+    std::vector<int> initial = {start};
+    nfa.closure(initial);
+    router->_startState = static_cast<uint32_t>(stateFor(std::move(initial)));
+
+    for (size_t next = 0; next < pending.size(); next++) {
+        const std::vector<int> current = pending[next];
+        const uint16_t from = ids[current];
+        for (size_t cls = 0; cls < router->_classCount; cls++) {
+            const unsigned char byte = representative[cls];
+            std::vector<int> moved;
+            for (int state : current) {
+                for (const auto& [setIndex, target] : nfa.states[static_cast<size_t>(state)].edges) {
+                    if (nfa.sets[setIndex].test(byte)) {
+                        moved.push_back(target);
+                    }
+                }
+            }
+            nfa.closure(moved);
+            const int to = stateFor(std::move(moved));
+            if (to < 0) {
+                error = "rules too complex (more than " + std::to_string(kMaxStates) + " DFA states)";
+                return nullptr;
+            }
+            router->_transitions[from * router->_classCount + cls] = static_cast<uint16_t>(to);
+        }
+    }
+    return router;
+}
+
+int ScanRouter::match(std::string_view code) const {
+    uint32_t state = _startState;
+    for (char c : code) {
+        state = _transitions[state * _classCount + _byteClass[static_cast<unsigned char>(c)]];
+        if (state == 0) {
+            return -1;
+        }
+    }
+    uint64_t candidates = _accepting[state];
+    while (candidates != 0) {
+        const int rule = std::countr_zero(candidates);
+        const RouteRule& route = _rules[static_cast<size_t>(rule)];
+        if (code.size() >= route.minLength && code.size() <= route.maxLength) {
+            return rule;
+        }
+        candidates &= candidates - 1;
+    }
+    return -1;
+}
+
+} // namespace margelo::nitro::externalscanner
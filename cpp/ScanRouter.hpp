@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace margelo::nitro::externalscanner {
+
+struct RouteRule {
+    std::string id;
+    std::string prefix;  // literal, matched before pattern
+    std::string pattern; // regex for the rest of the code; empty = anything
+    size_t minLength = 0;
+    size_t maxLength = SIZE_MAX;
+};
+
+// Routes completed scans by shape. All rules are compiled once into a single
+// DFA over byte classes, so matching is one table lookup per character no
+// matter how many rules there are. The first rule (in registration order)
+// that matches the whole code and its length range wins.
+//
+// Patterns support literals, '.', classes ([A-Z0-9], [^-], \d \w \s), groups,
+// '|', and the quantifiers * + ? {n} {n,} {n,m}. They always match the whole
+// code (after the prefix); a leading '^' or trailing '$' is accepted.
+class ScanRouter {
+public:
+    static constexpr size_t kMaxRules = 64;
+    static constexpr size_t kMaxStates = 4096;
+
+    // Returns nullptr and describes the problem in error if a rule is invalid
+    static std::shared_ptr<const ScanRouter> compile(const std::vector<RouteRule>& rules, std::string& error);
+
+    // Index of the matching rule, or -1
+    int match(std::string_view code) const;
+
+    const std::string& ruleId(int index) const { return _rules[static_cast<size_t>(index)].id; }
+    size_t ruleCount() const { return _rules.size(); }
+    size_t stateCount() const { return _accepting.size(); }
+
+private:
+    ScanRouter() = default;
+
+    std::array<uint8_t, 256> _byteClass{};
+    size_t _classCount = 0;
+    uint32_t _startState = 0;
+    std::vector<uint16_t> _transitions; // [state * _classCount + class], 0 = dead
+    std::vector<uint64_t> _accepting;   // bit i set = rule i matches here
+    std::vector<RouteRule> _rules;
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,144 @@
+#include "ScanSegmenter.hpp"
+
+namespace margelo::nitro::externalscanner {
+
+namespace {
+
+struct AimSymbology {
+    std::string_view id; // code character, optionally followed by the modifier
+    std::string_view name;
+};
+
+// Exact code character + modifier entries first, then the code character
+// alone for any modifier. Names fit in the small-string buffer, so copying
+// them into a ScanResult never allocates.
+constexpr AimSymbology kAimSymbologies[] = {
+    {"C1", "GS1-128"},
+    {"E4", "EAN-8"},
+    {"d2", "GS1 DataMatrix"},
+    {"Q3", "GS1 QR Code"},
+    {"A", "Code 39"},
+    {"C", "Code 128"},
+    {"E", "EAN-13"},
+    {"F", "Codabar"},
+    {"G", "Code 93"},
+    {"H", "Code 11"},
+    {"I", "ITF"},
+    {"L", "PDF417"},
+    {"M", "MSI"},
+    {"Q", "QR Code"},
+    {"U", "MaxiCode"},
+    {"d", "Data Matrix"},
+    {"e", "GS1 DataBar"},
+    {"z", "Aztec"},
+};
+
+bool isAimCodeCharacter(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+bool isAimModifier(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z');
+}
+
+} // namespace
+
+std::string_view aimSymbology(std::string_view aimId) {
+    if (aimId.size() != 3 || aimId[0] != ']') {
+        return aimId;
+    }
+    const std::string_view id = aimId.substr(1);
+    for (const AimSymbology& entry : kAimSymbologies) {
+        if (entry.id == id || (entry.id.size() == 1 && entry.id[0] == id[0])) {
+            return entry.name;
+        }
+    }
+    return aimId;
+}
+
+std::unique_ptr<const ScanSegmenter> ScanSegmenter::create(const ScanFormatConfig& config, std::string& error) {
+    if (config.prefix.size() > kMaxAffix || config.suffix.size() > kMaxAffix) {
+        error = "prefix and suffix are limited to " + std::to_string(kMaxAffix) + " bytes";
+        return nullptr;
+    }
+    for (char c : config.separators) {
+        if (config.prefix.find(c) != std::string::npos || config.suffix.find(c) != std::string::npos) {
+            error = "separators must not occur in the prefix or suffix";
+            return nullptr;
+        }
+    }
+    return std::unique_ptr<const ScanSegmenter>(new ScanSegmenter(config));
+}
+
+ScanSegmenter::ScanSegmenter(const ScanFormatConfig& config)
+    : _prefix(config.prefix), _suffix(config.suffix), _aimIdentifiers(config.aimIdentifiers) {
+    for (char c : config.separators) {
+        _isSeparator[static_cast<uint8_t>(c)] = true;
+    }
+}
+
+size_t ScanSegmenter::split(std::string_view scan, Segments& out) const {
+    size_t count = 0;
+    State state = startState();
+    size_t start = 0;   // first byte of the current code
+    size_t matched = 0; // prefix bytes matched so far
+    std::string_view aimId;
+
+    for (size_t i = 0; i < scan.size(); i++) {
+        const char c = scan[i];
+        if (_isSeparator[static_cast<uint8_t>(c)] && count + 1 < kMaxSegments) {
+            finishSegment(scan, start, i, aimId, out, count);
+            state = startState();
+            start = i + 1;
+            matched = 0;
+            aimId = {};
+            continue;
+        }
+
+        if (state == State::Prefix) {
+            if (c == _prefix[matched]) {
+                if (++matched == _prefix.size()) {
+                    start = i + 1;
+                    matched = 0;
+                    state = _aimIdentifiers ? State::AimId : State::Body;
+                }
+                continue;
+            }
+            // No prefix: the code starts here, and may still carry an identifier
+            // unless part of a prefix matched, which is then part of the code
+            state = matched == 0 && _aimIdentifiers ? State::AimId : State::Body;
+            matched = 0;
+        }
+
+        if (state == State::AimId) {
+            const size_t at = i - start;
+            const bool valid = at == 0 ? c == ']' : (at == 1 ? isAimCodeCharacter(c) : isAimModifier(c));
+            if (!valid) {
+                state = State::Body;
+            } else if (at == 2) {
+                aimId = scan.substr(start, 3);
+                start = i + 1;
+                state = State::Body;
+            }
+        }
+    }
+    finishSegment(scan, start, scan.size(), aimId, out, count);
+    return count;
+}
+
+void ScanSegmenter::finishSegment(std::string_view scan, size_t start, size_t end, std::string_view aimId,
+                                  Segments& out, size_t& count) const {
+    std::string_view code = scan.substr(start, end - start);
+    if (!_suffix.empty() && code.size() >= _suffix.size() &&
+        code.compare(code.size() - _suffix.size(), _suffix.size(), _suffix) == 0) {
+        code.remove_suffix(_suffix.size());
+    }
+    if (code.empty()) {
+        return;
+    }
+    out[count].code = code;
+    out[count].symbology = aimId.empty() ? std::string_view() : aimSymbology(aimId);
+    count++;
+}
+
+} // namespace margelo::nitro::externalscanner
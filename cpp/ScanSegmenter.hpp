@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace margelo::nitro::externalscanner {
+
+struct ScanFormatConfig {
+    std::string prefix;          // stripped from the start of each code, e.g. STX
+    std::string suffix;          // stripped from the end of each code, e.g. ETX
+    bool aimIdentifiers = false; // codes start with an AIM symbology identifier (]Cm)
+    std::string separators;      // any of these characters separates codes, e.g. TAB
+};
+
+// One code out of a completed scan, viewing into the scanned buffer
+struct ScanSegment {
+    std::string_view code;
+    // Symbology named by the AIM identifier (see aimSymbology()); empty if none
+    std::string_view symbology;
+};
+
+// Name of the symbology an AIM identifier (ISO/IEC 15424, "]" + code
+// character + modifier) stands for, e.g. "]C1" -> "GS1-128"; the identifier
+// itself for code characters it does not know
+std::string_view aimSymbology(std::string_view aimId);
+
+// Whether a symbology name from aimSymbology() is one of the GS1 symbologies
+// (GS1-128, GS1 DataMatrix, GS1 QR Code, GS1 DataBar)
+constexpr bool isGs1Symbology(std::string_view name) {
+    return name.substr(0, 4) == "GS1-" || name.substr(0, 4) == "GS1 ";
+}
+
+// Whether aimSymbology() knew the identifier the name came from
+constexpr bool isKnownSymbology(std::string_view name) {
+    return !name.empty() && name.front() != ']';
+}
+
+// Splits a completed scan from a scanner configured with framing characters,
+// AIM identifiers and/or several codes per trigger into its codes.
+//
+// One pass, one state machine per code: the prefix, then the AIM identifier
+// (when enabled), then the code up to a separator or the end of the scan,
+// with the suffix stripped from its end. A code without the prefix or a
+// valid identifier is taken as it is. Splitting never allocates.
+class ScanSegmenter {
+public:
+    static constexpr size_t kMaxAffix = 16;
+    static constexpr size_t kMaxSegments = 16;
+    using Segments = std::array<ScanSegment, kMaxSegments>;
+
+    // Returns nullptr and describes the problem in error if the config is invalid
+    static std::unique_ptr<const ScanSegmenter> create(const ScanFormatConfig& config, std::string& error);
+
+    // Fills out with the non-empty codes in scan and returns their number.
+    // Beyond kMaxSegments, the last code keeps the rest of the scan.
+    size_t split(std::string_view scan, Segments& out) const;
+
+private:
+    enum class State : uint8_t { Prefix, AimId, Body };
+
+    explicit ScanSegmenter(const ScanFormatConfig& config);
+
+    State startState() const { return !_prefix.empty() ? State::Prefix : (_aimIdentifiers ? State::AimId : State::Body); }
+    // Adds scan[start, end) minus the suffix, if not empty
+    void finishSegment(std::string_view scan, size_t start, size_t end, std::string_view aimId, Segments& out,
+                       size_t& count) const;
+
+    std::string _prefix;
+    std::string _suffix;
+    bool _aimIdentifiers = false;
+    std::array<bool, 256> _isSeparator{};
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace margelo::nitro::externalscanner {
+
+// Time source of the scan pipeline: key timestamps, inter-key timeouts,
+// deadlines and ScanResult.timestamp all come from here, so a scanner can
+// run on virtual time for deterministic replay.
+class ScannerClock {
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    virtual ~ScannerClock() = default;
+
+    virtual time_point now() const = 0;
+    // Milliseconds since the Unix epoch, for ScanResult.timestamp
+    virtual int64_t wallTimeMs() const = 0;
+    // Manual clocks only move when told to; whoever moves them also fires
+    // the scanner's deadlines (see HybridExternalScanner::fireDeadlines)
+    virtual bool isManual() const { return false; }
+};
+
+class SteadyScannerClock final : public ScannerClock {
+public:
+    time_point now() const override { return std::chrono::steady_clock::now(); }
+
+    int64_t wallTimeMs() const override {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Clock that stands still until set(); wall time follows it from a fixed
+// origin, so replayed scans get the timestamps they had when recorded.
+class VirtualClock final : public ScannerClock {
+public:
+    VirtualClock(time_point start, int64_t startWallMs)
+        : _now(start.time_since_epoch().count()), _start(start), _startWallMs(startWallMs) {}
+
+    time_point now() const override {
+        return time_point(time_point::duration(_now.load(std::memory_order_acquire)));
+    }
+
+    int64_t wallTimeMs() const override {
+        return _startWallMs + std::chrono::duration_cast<std::chrono::milliseconds>(now() - _start).count();
+    }
+
+    bool isManual() const override { return true; }
+
+    // Never moves backwards
+    void set(time_point time) {
+        const int64_t ticks = time.time_since_epoch().count();
+        if (ticks > _now.load(std::memory_order_relaxed)) {
+            _now.store(ticks, std::memory_order_release);
+        }
+    }
+
+private:
+    std::atomic<int64_t> _now;
+    const time_point _start;
+    const int64_t _startWallMs;
+};
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,116 @@
+#include "ScannerLog.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+void writeLog(int level, const char* tag, const std::string& message) {
+#ifdef __ANDROID__
+    int priority = ANDROID_LOG_VERBOSE;
+    switch (level) {
+        case ES_LOG_LEVEL_DEBUG: priority = ANDROID_LOG_DEBUG; break;
+        case ES_LOG_LEVEL_INFO: priority = ANDROID_LOG_INFO; break;
+        case ES_LOG_LEVEL_WARN: priority = ANDROID_LOG_WARN; break;
+        case ES_LOG_LEVEL_ERROR: priority = ANDROID_LOG_ERROR; break;
+        default: break;
+    }
+    __android_log_write(priority, tag, message.c_str());
+#else
+    // No std::endl: flushing on every line is what made logging expensive
+    (level >= ES_LOG_LEVEL_WARN ? std::cerr : std::cout) << "[" << tag << "] " << message << '\n';
+#endif
+}
+
+std::atomic<bool> ScanTrace::_enabled{false};
+std::atomic<uint64_t> ScanTrace::_next{0};
+ScanTrace::Record ScanTrace::_records[ScanTrace::kCapacity];
+
+void ScanTrace::setEnabled(bool enabled) {
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void ScanTrace::record(TraceEvent event, int32_t a, int64_t b) {
+    const uint64_t index = _next.fetch_add(1, std::memory_order_relaxed);
+    Record& rec = _records[index & (kCapacity - 1)];
+    rec.seq.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    rec.time.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    rec.event.store(static_cast<uint32_t>(event), std::memory_order_relaxed);
+    rec.a.store(a, std::memory_order_relaxed);
+    rec.b.store(b, std::memory_order_relaxed);
+    rec.seq.store(index * 2 + 2, std::memory_order_release);
+}
+
+static const char* traceEventName(uint32_t event) {
+    switch (static_cast<TraceEvent>(event)) {
+        case TraceEvent::KeyIngested: return "KeyIngested";
+        case TraceEvent::KeyDropped: return "KeyDropped";
+        case TraceEvent::KeyProcessed: return "KeyProcessed";
+        case TraceEvent::ScanTimeout: return "ScanTimeout";
+        case TraceEvent::ScanEmitted: return "ScanEmitted";
+        case TraceEvent::ScanRejected: return "ScanRejected";
+        case TraceEvent::ScanningStarted: return "ScanningStarted";
+        case TraceEvent::ScanningStopped: return "ScanningStopped";
+        case TraceEvent::DeviceConnected: return "DeviceConnected";
+        case TraceEvent::DeviceDisconnected: return "DeviceDisconnected";
+        case TraceEvent::ScanInvalid: return "ScanInvalid";
+        case TraceEvent::ScanDuplicate: return "ScanDuplicate";
+        case TraceEvent::ScanUnrouted: return "ScanUnrouted";
+    }
+    return "Unknown";
+}
+
+std::string ScanTrace::dump() {
+    struct Snapshot {
+        uint64_t seq;
+        int64_t time;
+        uint32_t event;
+        int32_t a;
+        int64_t b;
+    };
+
+    std::vector<Snapshot> snapshots;
+    snapshots.reserve(kCapacity);
+    for (Record& rec : _records) {
+        uint64_t before = rec.seq.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1) != 0) {
+            continue; // empty or being written
+        }
+        Snapshot snap{before,
+                      rec.time.load(std::memory_order_relaxed),
+                      rec.event.load(std::memory_order_relaxed),
+                      rec.a.load(std::memory_order_relaxed),
+                      rec.b.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (rec.seq.load(std::memory_order_relaxed) == before) {
+            snapshots.push_back(snap);
+        }
+    }
+
+    std::sort(snapshots.begin(), snapshots.end(),
+              [](const Snapshot& l, const Snapshot& r) { return l.seq < r.seq; });
+
+    std::ostringstream out;
+    const int64_t origin = snapshots.empty() ? 0 : snapshots.front().time;
+    for (const Snapshot& snap : snapshots) {
+        auto offset = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::duration(snap.time - origin)).count();
+        out << '+' << offset << "us " << traceEventName(snap.event)
+            << " a=" << snap.a << " b=" << snap.b << '\n';
+    }
+    return out.str();
+}
+
+void ScanTrace::clear() {
+    for (Record& rec : _records) {
+        rec.seq.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace margelo::nitro::externalscanner
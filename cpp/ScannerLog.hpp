@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Compile-time log levels. Anything below ES_LOG_LEVEL is stripped by the
+// preprocessor, so per-key TRACE logs cost nothing in release builds.
+#define ES_LOG_LEVEL_TRACE 0
+#define ES_LOG_LEVEL_DEBUG 1
+#define ES_LOG_LEVEL_INFO 2
+#define ES_LOG_LEVEL_WARN 3
+#define ES_LOG_LEVEL_ERROR 4
+#define ES_LOG_LEVEL_NONE 5
+
+#ifndef ES_LOG_LEVEL
+#ifdef NDEBUG
+#define ES_LOG_LEVEL ES_LOG_LEVEL_WARN
+#else
+#define ES_LOG_LEVEL ES_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// Each translation unit defines ES_LOG_TAG before logging
+#define ES_LOG_WRITE(level, msg)                                                          \
+    do {                                                                                  \
+        std::ostringstream _esLogStream;                                                  \
+        _esLogStream << msg;                                                              \
+        ::margelo::nitro::externalscanner::writeLog(level, ES_LOG_TAG, _esLogStream.str()); \
+    } while (0)
+
+#define ES_LOG_STRIPPED(msg) do {} while (0)
+
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_TRACE
+#define ES_LOGT(msg) ES_LOG_WRITE(ES_LOG_LEVEL_TRACE, msg)
+#else
+#define ES_LOGT(msg) ES_LOG_STRIPPED(msg)
+#endif
+
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_DEBUG
+#define ES_LOGD(msg) ES_LOG_WRITE(ES_LOG_LEVEL_DEBUG, msg)
+#else
+#define ES_LOGD(msg) ES_LOG_STRIPPED(msg)
+#endif
+
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_INFO
+#define ES_LOGI(msg) ES_LOG_WRITE(ES_LOG_LEVEL_INFO, msg)
+#else
+#define ES_LOGI(msg) ES_LOG_STRIPPED(msg)
+#endif
+
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_WARN
+#define ES_LOGW(msg) ES_LOG_WRITE(ES_LOG_LEVEL_WARN, msg)
+#else
+#define ES_LOGW(msg) ES_LOG_STRIPPED(msg)
+#endif
+
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_ERROR
+#define ES_LOGE(msg) ES_LOG_WRITE(ES_LOG_LEVEL_ERROR, msg)
+#else
+#define ES_LOGE(msg) ES_LOG_STRIPPED(msg)
+#endif
+
+// Binary trace points. Compiled in unless ES_TRACE_DISABLED is defined; at
+// runtime they cost one relaxed load until tracing is switched on.
+#ifndef ES_TRACE_DISABLED
+#define ES_TRACE(event, a, b)                                                          \
+    do {                                                                               \
+        if (::margelo::nitro::externalscanner::ScanTrace::isEnabled()) {               \
+            ::margelo::nitro::externalscanner::ScanTrace::record(                      \
+                ::margelo::nitro::externalscanner::TraceEvent::event,                  \
+                static_cast<int32_t>(a), static_cast<int64_t>(b));                     \
+        }                                                                              \
+    } while (0)
+#else
+#define ES_TRACE(event, a, b) do {} while (0)
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+void writeLog(int level, const char* tag, const std::string& message);
+
+enum class TraceEvent : uint32_t {
+    KeyIngested = 1,   // a = keyCode, b = deviceId
+    KeyDropped,        // a = keyCode, b = deviceId
+    KeyProcessed,      // a = keyCode, b = buffer length
+    ScanTimeout,       // a = buffer length, b = elapsed ms
+    ScanEmitted,       // a = code length, b = deviceId
+    ScanRejected,      // a = code length, b = min length
+    ScanningStarted,
+    ScanningStopped,
+    DeviceConnected,   // a = deviceId
+    DeviceDisconnected, // a = deviceId
+    ScanInvalid,       // a = code length, b = deviceId
+    ScanDuplicate,     // a = code length, b = deviceId
+    ScanUnrouted       // a = code length, b = deviceId
+};
+
+// Fixed-size, lock-free, multi-producer trace ring. Old records are
+// overwritten; dump() returns the surviving records oldest-first.
+class ScanTrace {
+public:
+    static constexpr size_t kCapacity = 4096;
+
+    static bool isEnabled() {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+    static void setEnabled(bool enabled);
+    static void record(TraceEvent event, int32_t a, int64_t b);
+    static std::string dump();
+    static void clear();
+
+private:
+    // 32 bytes per record. seq is written last and is odd while the record
+    // is being filled so readers can skip torn entries.
+    struct Record {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<int64_t> time{0};
+        std::atomic<uint32_t> event{0};
+        std::atomic<int32_t> a{0};
+        std::atomic<int64_t> b{0};
+    };
+
+    static std::atomic<bool> _enabled;
+    static std::atomic<uint64_t> _next;
+    static Record _records[kCapacity];
+};
+
+} // namespace margelo::nitro::externalscanner
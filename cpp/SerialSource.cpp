@@ -0,0 +1,217 @@
+#include "SerialSource.hpp"
+#include "ScannerLog.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <termios.h>
+#endif
+
+#define ES_LOG_TAG "ExternalScanner Serial"
+
+namespace margelo::nitro::externalscanner {
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr std::string_view kTcpScheme = "tcp://";
+
+speed_t toSpeed(int baudRate) {
+    switch (baudRate) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return B0;
+    }
+}
+
+// Raw 8N1 without flow control, so every byte arrives as sent
+bool configureTty(int fd, int baudRate) {
+    termios tty{};
+    if (tcgetattr(fd, &tty) != 0) {
+        ES_LOGE("configureTty: " << std::strerror(errno));
+        return false;
+    }
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    if (baudRate > 0) {
+        const speed_t speed = toSpeed(baudRate);
+        if (speed == B0) {
+            ES_LOGE("configureTty: Unsupported baud rate " << baudRate);
+            return false;
+        }
+        cfsetispeed(&tty, speed);
+        cfsetospeed(&tty, speed);
+    }
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
+        ES_LOGE("configureTty: " << std::strerror(errno));
+        return false;
+    }
+    // Drop whatever was buffered before we took over
+    tcflush(fd, TCIFLUSH);
+    return true;
+}
+
+int connectTcp(std::string_view target) {
+    const size_t colon = target.rfind(':');
+    if (colon == std::string_view::npos) {
+        ES_LOGE("connectTcp: Missing port in '" << target << "'");
+        return -1;
+    }
+    std::string host(target.substr(0, colon));
+    const std::string port(target.substr(colon + 1));
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    // Numeric only: a DNS lookup would block the caller
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+    addrinfo* address = nullptr;
+    const int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &address);
+    if (status != 0) {
+        ES_LOGE("connectTcp: Invalid address '" << target << "': " << gai_strerror(status));
+        return -1;
+    }
+    const int fd = socket(address->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    // Completes in the background; a failed connect shows up as a read error
+    if (fd < 0 || (connect(fd, address->ai_addr, address->ai_addrlen) != 0 && errno != EINPROGRESS)) {
+        ES_LOGE("connectTcp: Cannot connect to '" << target << "': " << std::strerror(errno));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        freeaddrinfo(address);
+        return -1;
+    }
+    freeaddrinfo(address);
+    return fd;
+}
+
+} // namespace
+
+SerialSource::SerialSource(std::string path, FramingConfig framing, int baudRate, int deviceId)
+    : _path(path), _name(std::move(path)), _framing(std::move(framing)), _baudRate(baudRate), _deviceId(deviceId) {}
+
+SerialSource::SerialSource(int fd, std::string name, FramingConfig framing, int deviceId)
+    : _fd(fd), _name(std::move(name)), _framing(std::move(framing)), _deviceId(deviceId) {}
+
+SerialSource::~SerialSource() {
+    stop();
+}
+
+bool SerialSource::start() {
+    std::string error;
+    _framer = ScanFramer::create(_framing, error);
+    if (!_framer) {
+        ES_LOGE("start: Invalid framing for '" << _name << "': " << error);
+        return false;
+    }
+
+    if (_path.empty()) {
+        const int flags = fcntl(_fd, F_GETFL);
+        if (flags < 0 || fcntl(_fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+            ES_LOGE("start: Cannot make '" << _name << "' non-blocking: " << std::strerror(errno));
+            return false;
+        }
+    } else if (std::string_view(_path).substr(0, kTcpScheme.size()) == kTcpScheme) {
+        _fd = connectTcp(std::string_view(_path).substr(kTcpScheme.size()));
+    } else {
+        // O_RDWR raises DTR, which some scanners wait for
+        _fd = ::open(_path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (_fd < 0) {
+            ES_LOGE("start: Cannot open '" << _path << "': " << std::strerror(errno));
+        } else if (isatty(_fd) && !configureTty(_fd, _baudRate)) {
+            stop();
+        }
+    }
+    return _fd >= 0;
+}
+
+void SerialSource::stop() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+std::optional<SourceDevice> SerialSource::device() const {
+    return SourceDevice{_deviceId, _name, 0, 0};
+}
+
+bool SerialSource::drain(InputSink& sink) {
+    char buffer[kReadSize];
+    const ssize_t bytes = read(_fd, buffer, sizeof(buffer));
+    if (bytes <= 0) {
+        if (bytes < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return true;
+        }
+        if (bytes == 0 || errno == EIO) {
+            ES_LOGI("drain: " << _deviceId << " '" << _name << "' closed");
+        } else {
+            ES_LOGE("drain: Cannot read '" << _name << "': " << std::strerror(errno));
+        }
+        return false;
+    }
+
+    std::string_view remaining(buffer, static_cast<size_t>(bytes));
+    while (!remaining.empty()) {
+        remaining.remove_prefix(_framer->consume(remaining));
+        if (_framer->hasFrame()) {
+            sink.onSourceFrame(_deviceId, _framer->frame());
+            _framer->clearFrame();
+        }
+    }
+    return true;
+}
+
+#else
+
+SerialSource::SerialSource(std::string path, FramingConfig framing, int baudRate, int deviceId)
+    : _path(path), _name(std::move(path)), _framing(std::move(framing)), _baudRate(baudRate), _deviceId(deviceId) {}
+
+SerialSource::SerialSource(int fd, std::string name, FramingConfig framing, int deviceId)
+    : _fd(fd), _name(std::move(name)), _framing(std::move(framing)), _deviceId(deviceId) {}
+
+SerialSource::~SerialSource() {
+    stop();
+}
+
+bool SerialSource::start() {
+    ES_LOGE("start: Serial input is only available on Linux");
+    return false;
+}
+
+void SerialSource::stop() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+std::optional<SourceDevice> SerialSource::device() const {
+    return SourceDevice{_deviceId, _name, 0, 0};
+}
+
+bool SerialSource::drain(InputSink&) {
+    return false;
+}
+
+#endif
+
+} // namespace margelo::nitro::externalscanner
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "InputSource.hpp"
+#include "ScanFramer.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace margelo::nitro::externalscanner {
+
+// Reads a scanner in serial mode (USB CDC-ACM, RS-232) or behind a
+// serial-to-TCP bridge, which sends the code as plain bytes instead of
+// emulating keystrokes.
+//
+// Each drain() reads whatever is available and splits it into scans with
+// the stream's ScanFramer; each complete frame goes to the sink. The source
+// ends when the peer hangs up or the tty goes away. On other platforms than
+// Linux start() fails.
+class SerialSource : public InputSource {
+public:
+    // Device ids from kDeviceIdBase up, clear of platform and evdev ids
+    static constexpr int kDeviceIdBase = 0x20000;
+    static constexpr size_t kReadSize = 4096;
+
+    // Opens a tty or pty on start(), switched to raw mode at baudRate (0 =
+    // keep the current speed), or connects to "tcp://address:port" (numeric
+    // address)
+    SerialSource(std::string path, FramingConfig framing, int baudRate, int deviceId);
+    // Reads fd, which it takes ownership of
+    SerialSource(int fd, std::string name, FramingConfig framing, int deviceId);
+    ~SerialSource() override;
+
+    bool start() override;
+    void stop() override;
+    int readinessFd() const override { return _fd; }
+    bool drain(InputSink& sink) override;
+    std::optional<SourceDevice> device() const override;
+
+private:
+    int _fd = -1;
+    const std::string _path; // empty for fd sources
+    const std::string _name;
+    const FramingConfig _framing;
+    const int _baudRate = 0;
+    const int _deviceId = 0;
+    std::unique_ptr<ScanFramer> _framer;
+};
+
+} // namespace margelo::nitro::externalscanner
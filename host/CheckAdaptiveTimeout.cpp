@@ -0,0 +1,69 @@
+// Replays fast scanner bursts (2 ms between keys, no terminator) delivered
+// the way the Android key batch does, in 16 ms batches, with the adaptive
+// timeout on. Each barcode must come out as one scan, also once the timeout
+// has been learned. Exits non-zero on a mismatch.
+//
+// Usage: CheckAdaptiveTimeout
+
+#include "KeyTraceReplayer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+constexpr int kDeviceId = 7;
+constexpr int kScans = 20;
+constexpr const char* kCode = "4006381333931ABCDEFGHIJ";
+
+// kScans bursts of kCode, keyGap apart, one second between bursts
+KeyTrace makeTrace(std::chrono::milliseconds keyGap) {
+    KeyTrace trace;
+    const auto second = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1));
+    const auto gap = std::chrono::duration_cast<std::chrono::steady_clock::duration>(keyGap);
+    trace.startTime = second.count();
+    for (int scan = 0; scan < kScans; scan++) {
+        auto time = second * (scan + 1);
+        for (const char* c = kCode; *c != '\0'; c++) {
+            trace.events.push_back(KeyEvent::make(0, 0, std::string_view(c, 1), kDeviceId, time.count()));
+            time += gap;
+        }
+    }
+    return trace;
+}
+
+bool run(const char* name, std::chrono::milliseconds keyGap, std::chrono::milliseconds batchHold) {
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setAdaptiveTimeout(true);
+    ReplayOptions options;
+    options.batchHold = batchHold;
+    const std::vector<ScanResult> results = replayKeyTrace(*scanner, makeTrace(keyGap), options);
+
+    int whole = 0;
+    for (const ScanResult& result : results) {
+        whole += result.code == kCode ? 1 : 0;
+    }
+    const double learned = scanner->getLearnedTimeouts().empty() ? 0.0 : scanner->getLearnedTimeouts()[0].timeoutMs;
+    const bool ok = whole == kScans && results.size() == static_cast<size_t>(kScans);
+    std::printf("%-32s %zu scans, %d whole of %d, learned %.0f ms  %s\n", name, results.size(), whole, kScans,
+                learned, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    ok &= run("2 ms keys, one by one", std::chrono::milliseconds(2), std::chrono::milliseconds(0));
+    ok &= run("2 ms keys, 16 ms batches", std::chrono::milliseconds(2), std::chrono::milliseconds(16));
+    ok &= run("1 ms keys, 16 ms batches", std::chrono::milliseconds(1), std::chrono::milliseconds(16));
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: batched bursts split into several scans\n");
+        return 1;
+    }
+    std::printf("OK: batched bursts\n");
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Writes product catalogs to a temporary directory, maps them and checks
+// lookups: every written code is found with its record, codes that were not
+// written miss, later duplicates win, and damaged files are refused. Exits
+// non-zero on a mismatch.
+//
+// Usage: CheckCatalog
+
+#include "ProductCatalog.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+bool expect(const char* name, const std::string& got, const std::string& expected) {
+    const bool ok = got == expected;
+    std::printf("%-36s %-24s %s\n", name, got.empty() ? "(empty)" : got.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+std::string lookup(const ProductCatalog& catalog, std::string_view code) {
+    std::optional<std::string_view> record = catalog.lookup(code);
+    return record ? std::string(*record) : "(miss)";
+}
+
+std::string gtin(int i) {
+    char code[16];
+    std::snprintf(code, sizeof(code), "0400638%06d", i);
+    return code;
+}
+
+bool checkLookups(const std::string& path) {
+    constexpr int kProducts = 20000;
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (int i = 0; i < kProducts; i++) {
+        entries.emplace_back(gtin(i), "product " + std::to_string(i));
+    }
+    entries.emplace_back(gtin(7), "product 7, repriced");
+    entries.emplace_back("ABC-1", "");
+    if (!ProductCatalog::write(path, entries)) {
+        return expect("write catalog", "failed", "written");
+    }
+    std::shared_ptr<const ProductCatalog> catalog = ProductCatalog::open(path);
+    if (!catalog) {
+        return expect("open catalog", "failed", "opened");
+    }
+
+    bool ok = expect("entries", std::to_string(catalog->size()), std::to_string(kProducts + 1));
+    ok &= expect("first code", lookup(*catalog, gtin(0)), "product 0");
+    ok &= expect("last code", lookup(*catalog, gtin(kProducts - 1)), "product " + std::to_string(kProducts - 1));
+    ok &= expect("later duplicate wins", lookup(*catalog, gtin(7)), "product 7, repriced");
+    ok &= expect("empty record", lookup(*catalog, "ABC-1"), "");
+    ok &= expect("unknown code", lookup(*catalog, gtin(kProducts)), "(miss)");
+    ok &= expect("prefix of a code", lookup(*catalog, gtin(5).substr(0, 12)), "(miss)");
+    ok &= expect("empty code", lookup(*catalog, ""), "(miss)");
+
+    bool allFound = true;
+    for (int i = 0; i < kProducts; i++) {
+        allFound &= i == 7 || catalog->lookup(gtin(i)) == std::optional<std::string_view>("product " + std::to_string(i));
+    }
+    ok &= expect("every code found", allFound ? "yes" : "no", "yes");
+    return ok;
+}
+
+bool checkEmpty(const std::string& path) {
+    if (!ProductCatalog::write(path, {})) {
+        return expect("write empty catalog", "failed", "written");
+    }
+    std::shared_ptr<const ProductCatalog> catalog = ProductCatalog::open(path);
+    return expect("empty catalog", catalog ? lookup(*catalog, gtin(0)) : "not opened", "(miss)");
+}
+
+bool checkDamaged(const std::string& directory, const std::string& valid) {
+    const std::string truncated = directory + "/truncated.catalog";
+    std::filesystem::copy_file(valid, truncated);
+    std::filesystem::resize_file(truncated, std::filesystem::file_size(valid) / 2);
+
+    const std::string garbage = directory + "/garbage.catalog";
+    std::ofstream(garbage) << "code\trecord\n";
+
+    bool ok = expect("truncated file", ProductCatalog::open(truncated) ? "opened" : "refused", "refused");
+    ok &= expect("not a catalog", ProductCatalog::open(garbage) ? "opened" : "refused", "refused");
+    ok &= expect("missing file", ProductCatalog::open(directory + "/missing") ? "opened" : "refused", "refused");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    char pattern[] = "/tmp/catalog-XXXXXX";
+    const char* created = mkdtemp(pattern);
+    if (created == nullptr) {
+        std::fprintf(stderr, "FAIL: cannot create a temporary directory\n");
+        return 1;
+    }
+    const std::string directory = created;
+    const std::string products = directory + "/products.catalog";
+
+    bool ok = checkLookups(products);
+    ok &= checkEmpty(directory + "/empty.catalog");
+    ok &= checkDamaged(directory, products);
+    std::filesystem::remove_all(directory);
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: catalog lookups came out wrong\n");
+        return 1;
+    }
+    std::printf("OK: product catalog\n");
+    return 0;
+}
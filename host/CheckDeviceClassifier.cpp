@@ -0,0 +1,80 @@
+// Classifies input devices with the built-in detection and checks the
+// verdicts: scanner names, built-in hardware names, USB ids, virtual devices
+// and non-keyboards. Also checks the verdict cache with colliding device ids
+// and removals. Exits non-zero on a mismatch.
+//
+// Usage: CheckDeviceClassifier
+
+#include "DeviceClassifier.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+struct Case {
+    const char* name;
+    InputDeviceDescriptor device;
+    bool expected;
+};
+
+InputDeviceDescriptor keyboard(const char* name, int vendorId = 0, int productId = 0) {
+    return InputDeviceDescriptor{name, vendorId, productId, false, true};
+}
+
+bool expect(const char* name, const char* got, const char* expected) {
+    const bool ok = std::string(got) == expected;
+    std::printf("%-36s %-12s %s\n", name, got, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+const char* verdict(std::optional<bool> isScanner) {
+    return !isScanner ? "unknown" : (*isScanner ? "scanner" : "not scanner");
+}
+
+} // namespace
+
+int main() {
+    const std::vector<Case> cases = {
+        {"scanner name", keyboard("Honeywell 1900GSR"), true},
+        {"scanner name, any case", keyboard("BARCODE READER"), true},
+        {"keyboard with USB ids", keyboard("USB Keyboard", 0x413C, 0x2107), true},
+        {"keyboard without USB ids", keyboard("qwerty"), false},
+        {"built-in keys", keyboard("gpio-keys"), false},
+        {"built-in keypad, anchored", keyboard("mtk-kpd"), false},
+        {"built-in name beats scanner name", keyboard("zebra_ts", 0x05E0, 0x1200), false},
+        {"anchor elsewhere in the name", keyboard("my-kpd-scanner"), true},
+        {"virtual device", InputDeviceDescriptor{"Virtual Scanner", 0, 0, true, true}, false},
+        {"not a keyboard", InputDeviceDescriptor{"Zebra Mouse", 0x05E0, 0x0001, false, false}, false},
+    };
+
+    DeviceClassifier classifier;
+    bool ok = true;
+    for (const Case& check : cases) {
+        ok &= expect(check.name, classifier.classify(check.device) ? "scanner" : "not scanner",
+                     check.expected ? "scanner" : "not scanner");
+    }
+
+    // Ids that share a home slot probe past each other; removing one leaves
+    // a tombstone, so the ones after it are still found
+    const int stride = static_cast<int>(DeviceClassifier::kCacheCapacity);
+    for (int i = 1; i <= 4; i++) {
+        classifier.update(i * stride, i % 2 == 0 ? keyboard("Scanner") : keyboard("qwerty"));
+    }
+    ok &= expect("cached, colliding ids", verdict(classifier.cached(4 * stride)), "scanner");
+    classifier.forget(2 * stride);
+    ok &= expect("forgotten device", verdict(classifier.cached(2 * stride)), "unknown");
+    ok &= expect("collision after a removal", verdict(classifier.cached(3 * stride)), "not scanner");
+    classifier.update(3 * stride, keyboard("Scanner"));
+    ok &= expect("verdict updated on change", verdict(classifier.cached(3 * stride)), "scanner");
+    ok &= expect("never classified", verdict(classifier.cached(7)), "unknown");
+
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: devices classified wrong\n");
+        return 1;
+    }
+    std::printf("OK: device classifier\n");
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Compiles a set of device rules and checks the verdict for each device:
+// id ranges, name patterns, priorities and reject-over-accept ties, invalid
+// rules, and connected devices being re-classified when the rules change.
+// Exits non-zero on a mismatch.
+//
+// Usage: CheckDeviceRules
+
+#include "DeviceClassifier.hpp"
+#include "DeviceRuleTable.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+struct Case {
+    const char* name;
+    const char* deviceName;
+    int vendorId;
+    int productId;
+    const char* expected; // "accept", "reject" or "none"
+};
+
+DeviceMatchRule rule(std::optional<int> vendorId, int productIdMin, int productIdMax, const char* namePattern,
+                     bool accept, int priority = 0) {
+    return DeviceMatchRule{vendorId, productIdMin, productIdMax, namePattern, accept, priority};
+}
+
+const char* verdict(std::optional<bool> accepted) {
+    return !accepted ? "none" : (*accepted ? "accept" : "reject");
+}
+
+bool expect(const char* name, const char* got, const char* expected) {
+    const bool ok = std::string(got) == expected;
+    std::printf("%-36s %-10s %s\n", name, got, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+bool runInvalid(const char* name, const DeviceMatchRule& invalid) {
+    std::string error;
+    const bool rejected = DeviceRuleTable::compile({invalid}, error) == nullptr && !error.empty();
+    return expect(name, rejected ? "rejected" : "compiled", "rejected");
+}
+
+} // namespace
+
+int main() {
+    const std::vector<DeviceMatchRule> rules = {
+        rule(0x0C2E, 0, 0xFFFF, "", true),                    // Honeywell
+        rule(0x05E0, 0x1200, 0x12FF, "", true),               // Zebra scanners
+        rule(0x046D, 0, 0xFFFF, "", false, 10),               // Logitech keyboards
+        rule(0x046D, 0, 0xFFFF, "scanner", true, 10),         // ties with the reject above
+        rule(std::nullopt, 0, 0xFFFF, "keyboard", false),
+        rule(0x1234, 0, 0xFFFF, "", true),
+        rule(std::nullopt, 0, 0xFFFF, "^acme", false),        // ties with the accept above
+        rule(0x2222, 0, 0xFFFF, "", false),
+        rule(0x2222, 0x0010, 0x0020, "", true, 1),            // outranks the reject above
+    };
+    std::string error;
+    std::shared_ptr<const DeviceRuleTable> table = DeviceRuleTable::compile(rules, error);
+    if (!table) {
+        std::fprintf(stderr, "FAIL: rules did not compile: %s\n", error.c_str());
+        return 1;
+    }
+
+    const std::vector<Case> cases = {
+        {"vendor", "Honeywell 1900", 0x0C2E, 0x0B01, "accept"},
+        {"product range start", "Zebra DS2208", 0x05E0, 0x1200, "accept"},
+        {"product range end", "Zebra DS2208", 0x05E0, 0x12FF, "accept"},
+        {"past the product range", "Zebra DS2208", 0x05E0, 0x1300, "none"},
+        {"vendor reject", "Logitech USB Receiver", 0x046D, 0xC52B, "reject"},
+        {"reject beats accept on a tie", "Logitech Scanner", 0x046D, 0xC52B, "reject"},
+        {"name pattern", "USB Keyboard", 0, 0, "reject"},
+        {"anchored name, tie with an id", "ACME Scanner", 0x1234, 0x0001, "reject"},
+        {"anchored name elsewhere", "Scanner by Acme", 0x1234, 0x0001, "accept"},
+        {"narrow range outranks vendor", "Gadget", 0x2222, 0x0015, "accept"},
+        {"vendor outside the range", "Gadget", 0x2222, 0x0030, "reject"},
+        {"no rule matches", "Generic HID", 0x9999, 0x0001, "none"},
+        {"no USB ids, no name rule", "Zebra DS2208", 0, 0, "none"},
+    };
+
+    bool ok = true;
+    for (const Case& check : cases) {
+        ok &= expect(check.name, verdict(table->evaluate(check.deviceName, check.vendorId, check.productId)),
+                     check.expected);
+    }
+    ok &= runInvalid("product range without vendor", rule(std::nullopt, 0x10, 0x20, "", true));
+    ok &= runInvalid("inverted product range", rule(0x1234, 0x20, 0x10, "", true));
+    ok &= runInvalid("vendor out of range", rule(0x10000, 0, 0xFFFF, "", true));
+
+    // A connected keyboard with USB ids is a scanner by default, until a
+    // rule rejects it; dropping the rules restores the default
+    DeviceClassifier classifier;
+    classifier.update(5, InputDeviceDescriptor{"Logitech USB Receiver", 0x046D, 0xC52B, false, true});
+    ok &= expect("default detection", verdict(classifier.cached(5)), "accept");
+    classifier.setRules(table);
+    ok &= expect("re-classified by the rules", verdict(classifier.cached(5)), "reject");
+    classifier.setRules(nullptr);
+    ok &= expect("rules removed", verdict(classifier.cached(5)), "accept");
+
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: device rules gave the wrong verdict\n");
+        return 1;
+    }
+    std::printf("OK: device rules\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Parses GS1 element strings, marked by an AIM identifier or FNC1 and as
+// keyboard-wedge scanners send them (unmarked), and checks the elements that
+// come out, including plain codes that must not be taken as GS1. Exits
+// non-zero on a mismatch.
+//
+// Usage: CheckGs1
+
+#include "Gs1Parser.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+struct Case {
+    const char* name;
+    std::string input;
+    bool knownGs1;
+    std::string expected; // "ai=value ..." or "" if not GS1
+};
+
+std::string describe(const std::optional<std::vector<Gs1Element>>& elements) {
+    std::string text;
+    if (!elements) {
+        return text;
+    }
+    for (const Gs1Element& element : *elements) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += element.ai + "=" + element.value;
+    }
+    return text;
+}
+
+bool run(const Case& check) {
+    const std::string got = describe(parseGs1Elements(check.input, check.knownGs1));
+    const bool ok = got == check.expected;
+    std::printf("%-36s %-32s %s\n", check.name, got.empty() ? "(not GS1)" : got.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    const std::string fnc1 = "\x1D";
+    const std::vector<Case> cases = {
+        // Plain codes that also read as AI strings
+        {"unmarked EAN-13", "4006381333931", false, ""},
+        {"unmarked alphanumeric", "10ABC", false, ""},
+        {"unmarked GTIN, bad check digit", "0109501101020918", false, ""},
+        // Unmarked data that starts with an SSCC or GTIN
+        {"unmarked GTIN", "0109501101020917", false, "01=09501101020917"},
+        {"unmarked SSCC", "00106141411234567897", false, "00=106141411234567897"},
+        {"unmarked GTIN + lot", "010950110102091710ABC123", false, "01=09501101020917 10=ABC123"},
+        // Marked data
+        {"leading FNC1", fnc1 + "10ABC", false, "10=ABC"},
+        {"AIM ]C1", "]C110ABC", false, "10=ABC"},
+        {"AIM ]d2", "]d2" "21SERIAL7", false, "21=SERIAL7"},
+        {"symbology known", "10ABC", true, "10=ABC"},
+        {"non-GS1 AIM identifier", "]E04006381333931", false, ""},
+        // Variable-length AIs end at FNC1 or the end of the data
+        {"FNC1 after variable AI", "]C110ABC" + fnc1 + "17250101", false, "10=ABC 17=250101"},
+        {"fixed AIs without FNC1", "]C1" "0109501101020917" "17250101" "10LOT", false,
+         "01=09501101020917 17=250101 10=LOT"},
+        {"variable AI at its maximum", "]C110" + std::string(20, 'A'), false, "10=" + std::string(20, 'A')},
+        {"variable AI too long", "]C110" + std::string(21, 'A'), false, ""},
+        {"empty variable AI", "]C110" + fnc1 + "17250101", false, ""},
+        {"fixed AI too short", "]C1" "01095011010209", false, ""},
+    };
+
+    bool ok = true;
+    for (const Case& check : cases) {
+        ok &= run(check);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: GS1 element strings parsed wrong\n");
+        return 1;
+    }
+    std::printf("OK: GS1 element strings\n");
+    return 0;
+}
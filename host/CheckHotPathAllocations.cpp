@@ -0,0 +1,181 @@
+// Feeds scans through the scanner with the global allocator instrumented
+// and fails if the key path (ingest, append, terminate, dispatch) allocates
+// once warmed up. Exits non-zero on any allocation.
+//
+// Usage: CheckHotPathAllocations [scans]
+
+#include "HybridExternalScanner.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+std::atomic<bool> gCounting{false};
+std::atomic<uint64_t> gAllocations{0};
+
+void* allocate(std::size_t size, std::size_t alignment = 0) {
+    if (gCounting.load(std::memory_order_relaxed)) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment > alignof(std::max_align_t)) {
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    return std::malloc(size);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* pointer = allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* pointer = allocate(size, static_cast<std::size_t>(alignment))) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+namespace {
+
+constexpr int kEnterKey = 66; // Android KEYCODE_ENTER
+constexpr int kWarmupScans = 256;
+
+struct Scenario {
+    const char* name;
+    bool threaded = false;
+    bool batched = false;
+    size_t codeLength = 13;
+    size_t maxScanLength = ScanBuffer::kCapacity;
+    ScanOverflowPolicy overflow = ScanOverflowPolicy::DISCARD;
+};
+
+// Distinct digits per scan, as a real stream of codes would be
+void feedScan(HybridExternalScanner& scanner, uint64_t index, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        const char c = static_cast<char>('0' + (index + i) % 10);
+        scanner.onKeyEvent(0, 0, std::string_view(&c, 1), 1);
+    }
+    scanner.onKeyEvent(kEnterKey, 0, std::string_view(), 1);
+}
+
+void waitFor(const std::atomic<uint64_t>& delivered, uint64_t target) {
+    while (delivered.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+// Allocations while feeding scans after warm-up
+uint64_t run(const Scenario& scenario, uint64_t scans) {
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(scenario.threaded);
+    scanner->setMaxScanLength(static_cast<double>(scenario.maxScanLength), scenario.overflow);
+
+    // Split scans deliver more than one result per fed scan
+    const uint64_t perScan = (scenario.codeLength + scenario.maxScanLength - 1) / scenario.maxScanLength;
+    std::atomic<uint64_t> delivered{0};
+    if (scenario.batched) {
+        // Flushes happen when the batch is full, well inside the latency budget
+        scanner->startScanningBatched([&](const std::vector<ScanResult>& results) {
+            delivered.fetch_add(results.size(), std::memory_order_release);
+        }, 60000.0);
+    } else {
+        scanner->startScanning([&](const ScanResult&) { delivered.fetch_add(1, std::memory_order_release); },
+                               std::nullopt);
+    }
+
+    // Keep the key ring from overflowing and batches from straddling the
+    // counted section
+    const uint64_t window = 32;
+    auto feed = [&](uint64_t first, uint64_t count) {
+        for (uint64_t i = first; i < first + count; i++) {
+            feedScan(*scanner, i, scenario.codeLength);
+            if ((i + 1) % window == 0) {
+                waitFor(delivered, (i + 1) * perScan);
+            }
+        }
+    };
+
+    feed(0, kWarmupScans);
+    gAllocations.store(0, std::memory_order_relaxed);
+    gCounting.store(true, std::memory_order_release);
+    feed(kWarmupScans, scans);
+    gCounting.store(false, std::memory_order_release);
+
+    const uint64_t allocations = gAllocations.load(std::memory_order_relaxed);
+    const uint64_t emitted = static_cast<uint64_t>(scanner->getStats().scansEmitted);
+    scanner->stopScanning();
+    std::printf("%-28s %8llu scans  %6llu allocations\n", scenario.name, static_cast<unsigned long long>(emitted),
+                static_cast<unsigned long long>(allocations));
+    return allocations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Whole windows, so every counted scan is delivered before counting stops
+    const uint64_t scans = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000) / 32 * 32;
+
+    Scenario inlineScans{"inline"};
+    Scenario threadedScans{"threaded"};
+    threadedScans.threaded = true;
+    Scenario batchedScans{"batched"};
+    batchedScans.batched = true;
+    Scenario longScans{"inline, 200-char codes"};
+    longScans.codeLength = 200;
+    Scenario splitScans{"inline, split at 16 chars"};
+    splitScans.codeLength = 40;
+    splitScans.maxScanLength = 16;
+    splitScans.overflow = ScanOverflowPolicy::SPLIT;
+
+    uint64_t total = 0;
+    for (const Scenario& scenario : {inlineScans, threadedScans, batchedScans, longScans, splitScans}) {
+        total += run(scenario, scans);
+    }
+    if (total != 0) {
+        std::fprintf(stderr, "FAIL: %llu allocations on the key path after warm-up\n",
+                     static_cast<unsigned long long>(total));
+        return 1;
+    }
+    std::printf("OK: no allocations on the key path after warm-up\n");
+    return 0;
+}
@@ -0,0 +1,206 @@
+// Runs pipe-backed sources on an InputLoop and checks what reaches the sink:
+// frames from several sources, device reports on add and remove, sources that
+// end, removal from the loop thread while draining, failed starts and the
+// source limit. Exits non-zero on a mismatch or if the loop hangs.
+//
+// Usage: CheckInputLoop
+
+#include "InputLoop.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+// Reads newline-separated frames from a pipe; the test writes the other end
+class PipeSource : public InputSource {
+public:
+    explicit PipeSource(int deviceId, bool startOk = true) : _deviceId(deviceId), _startOk(startOk) {}
+    ~PipeSource() override { closeWriter(); }
+
+    bool start() override {
+        int fds[2];
+        if (!_startOk || pipe(fds) != 0) {
+            return false;
+        }
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        _readFd = fds[0];
+        _writeFd = fds[1];
+        return true;
+    }
+    void stop() override {
+        close(_readFd);
+        stopped = true;
+    }
+    int readinessFd() const override { return _readFd; }
+    bool drain(InputSink& sink) override {
+        char buffer[256];
+        const ssize_t n = read(_readFd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            return n < 0; // EAGAIN keeps the source, EOF ends it
+        }
+        std::string_view bytes(buffer, static_cast<size_t>(n));
+        for (size_t end; (end = bytes.find('\n')) != std::string_view::npos; bytes.remove_prefix(end + 1)) {
+            sink.onSourceFrame(_deviceId, bytes.substr(0, end));
+        }
+        return true;
+    }
+    std::optional<SourceDevice> device() const override { return SourceDevice{_deviceId, "pipe", 0, 0}; }
+
+    void send(std::string_view line) {
+        const std::string data = std::string(line) + "\n";
+        (void)!write(_writeFd, data.data(), data.size());
+    }
+    void closeWriter() {
+        if (_writeFd >= 0) {
+            close(_writeFd);
+            _writeFd = -1;
+        }
+    }
+
+    std::atomic<bool> stopped{false};
+
+private:
+    const int _deviceId;
+    const bool _startOk;
+    int _readFd = -1;
+    int _writeFd = -1;
+};
+
+// Records "device:frame", "+device" and "-device" in arrival order. A frame
+// "remove" removes its own source from the loop thread.
+class RecordingSink : public InputSink {
+public:
+    void onSourceKeys(const KeyEvent*, size_t) override {}
+    void onSourceFrame(int deviceId, std::string_view frame) override {
+        if (frame == "remove") {
+            loop->remove(sourceIds[deviceId]);
+        }
+        record(std::to_string(deviceId) + ":" + std::string(frame));
+    }
+    void onSourceDevice(const SourceDevice& device, bool connected) override {
+        record((connected ? "+" : "-") + std::to_string(device.deviceId));
+    }
+
+    // Waits until event was recorded; false after a timeout
+    bool waitFor(const std::string& event) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _changed.wait_for(lock, std::chrono::seconds(2), [&] {
+            for (const std::string& seen : _events) {
+                if (seen == event) {
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+    std::string events() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::string text;
+        for (const std::string& event : _events) {
+            text += (text.empty() ? "" : " ") + event;
+        }
+        return text;
+    }
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _events.clear();
+    }
+
+    InputLoop* loop = nullptr;
+    int sourceIds[8] = {};
+
+private:
+    void record(std::string event) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _events.push_back(std::move(event));
+        _changed.notify_all();
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::vector<std::string> _events;
+};
+
+bool expect(const char* name, bool ok, const std::string& detail) {
+    std::printf("%-36s %-24s %s\n", name, detail.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    RecordingSink sink;
+    std::unique_ptr<InputLoop> loop = InputLoop::start(sink);
+    if (!loop) {
+        std::fprintf(stderr, "FAIL: the input loop did not start\n");
+        return 1;
+    }
+    sink.loop = loop.get();
+    bool ok = true;
+
+    auto first = std::make_shared<PipeSource>(1);
+    auto second = std::make_shared<PipeSource>(2);
+    sink.sourceIds[1] = loop->add(first);
+    sink.sourceIds[2] = loop->add(second);
+    ok &= expect("devices reported on add", sink.events() == "+1 +2", sink.events());
+
+    sink.clear();
+    first->send("ABC");
+    second->send("XYZ");
+    const bool delivered = sink.waitFor("1:ABC") && sink.waitFor("2:XYZ");
+    ok &= expect("frames from both sources", delivered, sink.events());
+
+    sink.clear();
+    loop->remove(sink.sourceIds[1]);
+    ok &= expect("removed and stopped", first->stopped && sink.events() == "-1", sink.events());
+
+    sink.clear();
+    second->closeWriter();
+    const bool ended = sink.waitFor("-2") && second->stopped;
+    ok &= expect("ended source stopped", ended, sink.events());
+
+    sink.clear();
+    auto third = std::make_shared<PipeSource>(3);
+    sink.sourceIds[3] = loop->add(third);
+    third->send("remove");
+    const bool removed = sink.waitFor("-3") && third->stopped;
+    ok &= expect("removed from the loop thread", removed, sink.events());
+
+    ok &= expect("failed start", loop->add(std::make_shared<PipeSource>(4, false)) == -1, "not added");
+
+    sink.clear();
+    std::vector<std::shared_ptr<PipeSource>> many;
+    int added = 0;
+    for (size_t i = 0; i <= InputLoop::kMaxSources; i++) {
+        auto source = std::make_shared<PipeSource>(5);
+        if (loop->add(source) >= 0) {
+            added++;
+            many.push_back(source);
+        }
+    }
+    ok &= expect("source limit", added == static_cast<int>(InputLoop::kMaxSources),
+                 std::to_string(added) + " added");
+
+    loop.reset();
+    bool allStopped = true;
+    for (const auto& source : many) {
+        allStopped &= source->stopped;
+    }
+    ok &= expect("sources stopped with the loop", allStopped, allStopped ? "all" : "some left");
+
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: input loop delivered wrong\n");
+        return 1;
+    }
+    std::printf("OK: input loop\n");
+    return 0;
+}
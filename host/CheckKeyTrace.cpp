@@ -0,0 +1,130 @@
+// Records a key trace of a live session on a virtual clock (terminated scans,
+// scans completed by the timeout, two devices typing at once, slow typing),
+// then replays the file at several speeds. Every replay must produce the
+// scans the live session did. Exits non-zero on a mismatch.
+//
+// Usage: CheckKeyTrace
+
+#include "KeyTraceReplayer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+constexpr int kEnter = 66; // Android KEYCODE_ENTER
+
+struct Key {
+    int64_t atMs;
+    int deviceId;
+    int keyCode;
+    const char* characters;
+};
+
+// Keys of one code, gapMs apart from atMs on, optionally with Enter after it
+void type(std::vector<Key>& keys, int64_t atMs, int deviceId, const char* code, int64_t gapMs, bool enter) {
+    for (const char* c = code; *c != '\0'; c++, atMs += gapMs) {
+        keys.push_back({atMs, deviceId, 0, c});
+    }
+    if (enter) {
+        keys.push_back({atMs, deviceId, kEnter, "\n"});
+    }
+}
+
+std::string describe(const std::vector<ScanResult>& scans) {
+    std::string text;
+    for (const ScanResult& scan : scans) {
+        text += (text.empty() ? "" : " ") + std::to_string(static_cast<int>(scan.deviceId)) + ":" + scan.code;
+    }
+    return text;
+}
+
+// Runs keys through a live scanner while recording them to path
+std::vector<ScanResult> record(const std::vector<Key>& keys, const std::string& path) {
+    const auto start = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+    auto clock = std::make_shared<VirtualClock>(start, 1700000000000);
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(false);
+    scanner->setClock(clock);
+
+    std::vector<ScanResult> scans;
+    scanner->startKeyTrace(path);
+    scanner->startScanning([&](const ScanResult& result) { scans.push_back(result); }, std::nullopt);
+    for (const Key& key : keys) {
+        clock->set(start + std::chrono::milliseconds(key.atMs));
+        scanner->fireDeadlines();
+        scanner->onKeyEvent(key.keyCode, 0, std::string_view(key.characters, 1), key.deviceId);
+    }
+    clock->set(start + std::chrono::milliseconds(keys.back().atMs + 1000));
+    scanner->fireDeadlines();
+    scanner->stopScanning();
+    scanner->stopKeyTrace();
+    return scans;
+}
+
+bool expect(const char* name, const std::string& got, const std::string& expected) {
+    const bool ok = got == expected;
+    std::printf("%-36s %s\n", name, ok ? "ok" : "FAIL");
+    if (!ok) {
+        std::printf("  got      %s\n  expected %s\n", got.c_str(), expected.c_str());
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    std::vector<Key> keys;
+    type(keys, 0, 1, "ABC123", 3, true);
+    type(keys, 1000, 1, "4006381333931", 4, true); // interleaved with device 2
+    type(keys, 1001, 2, "XYZ789", 4, true);
+    type(keys, 2000, 1, "NOTERMINATOR", 3, false);  // completed by the timeout
+    type(keys, 3000, 1, "AB", 3, true);             // too short
+    type(keys, 4000, 2, "SLOW", 200, true);         // typed, not scanned
+    type(keys, 6000, 2, "LAST01", 3, true);
+    std::stable_sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) { return a.atMs < b.atMs; });
+
+    char path[] = "/tmp/keytrace-XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        std::fprintf(stderr, "FAIL: cannot create a temporary file\n");
+        return 1;
+    }
+    close(fd);
+
+    const std::string live = describe(record(keys, path));
+    std::optional<KeyTrace> trace = KeyTrace::load(path);
+    unlink(path);
+    bool ok = expect("live session", live,
+                     "1:ABC123 2:XYZ789 1:4006381333931 1:NOTERMINATOR 2:LAST01");
+    if (!trace) {
+        std::fprintf(stderr, "FAIL: the recorded trace did not load\n");
+        return 1;
+    }
+    ok &= expect("keys recorded", std::to_string(trace->events.size()), std::to_string(keys.size()));
+
+    const auto replay = [&](ReplaySpeed speed, double scale) {
+        auto scanner = std::make_shared<HybridExternalScanner>();
+        ReplayOptions options;
+        options.speed = speed;
+        options.scale = scale;
+        return describe(replayKeyTrace(*scanner, *trace, options));
+    };
+    ok &= expect("replay, as fast as possible", replay(ReplaySpeed::AsFastAsPossible, 1.0), live);
+    ok &= expect("replay again", replay(ReplaySpeed::AsFastAsPossible, 1.0), live);
+    ok &= expect("replay, scaled 100x", replay(ReplaySpeed::Scaled, 100.0), live);
+
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: key trace replayed differently\n");
+        return 1;
+    }
+    std::printf("OK: key trace\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Feeds byte streams through the serial framer, all at once and one byte at
+// a time, and checks the frames that come out: terminators, prefix/suffix
+// pairs, length headers, noise between frames and oversized frames. Exits
+// non-zero on a mismatch.
+//
+// Usage: CheckScanFramer
+
+#include "ScanFramer.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+struct Case {
+    const char* name;
+    FramingConfig config;
+    std::string stream;
+    std::string expected; // frames joined by '|', then "+N dropped" if any
+};
+
+FramingConfig framing(const char* terminators, const char* prefix = "", const char* suffix = "",
+                      size_t lengthHeaderBytes = 0) {
+    return FramingConfig{terminators, prefix, suffix, lengthHeaderBytes};
+}
+
+// Frames out of stream, fed in chunks of at most chunk bytes
+std::string feed(const FramingConfig& config, std::string_view stream, size_t chunk) {
+    std::string error;
+    std::unique_ptr<ScanFramer> framer = ScanFramer::create(config, error);
+    if (!framer) {
+        return "error";
+    }
+    std::string frames;
+    for (size_t offset = 0; offset < stream.size(); offset += chunk) {
+        std::string_view bytes = stream.substr(offset, chunk);
+        while (!bytes.empty()) {
+            bytes.remove_prefix(framer->consume(bytes));
+            if (framer->hasFrame()) {
+                frames += (frames.empty() ? "" : "|") + std::string(framer->frame());
+                framer->clearFrame();
+            }
+        }
+    }
+    if (framer->droppedFrames() > 0) {
+        frames += " +" + std::to_string(framer->droppedFrames()) + " dropped";
+    }
+    return frames;
+}
+
+bool run(const Case& check) {
+    const std::string whole = feed(check.config, check.stream, check.stream.size() + 1);
+    const std::string bytewise = feed(check.config, check.stream, 1);
+    const bool ok = whole == check.expected && bytewise == check.expected;
+    std::printf("%-36s %-24s %s\n", check.name, whole.c_str(), ok ? "ok" : "FAIL");
+    if (bytewise != whole) {
+        std::printf("%-36s %-24s\n", "  fed one byte at a time", bytewise.c_str());
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    using namespace std::string_literals;
+    const std::string oversized(ScanFramer::kMaxFrame + 1, 'X');
+
+    const std::vector<Case> cases = {
+        {"CR LF terminators", framing("\r\n"), "ABC\r\nDEF\r\n", "ABC|DEF"},
+        {"partial frame held back", framing("\r\n"), "ABC\rDE", "ABC"},
+        {"prefix and suffix", framing("", "\x02", "\x03"), "noise\x02" "ABC\x03\x02" "DEF\x03", "ABC|DEF"},
+        {"overlapping prefix", framing("\r", "AAB"), "AAAB123\r", "123"},
+        {"multi-byte suffix", framing("", "", "#END"), "ABC#EN" "D#ENDDEF#END", "ABC|DEF"},
+        {"1-byte length header", framing("", "", "", 1), "\x03" "ABC\x02" "DE", "ABC|DE"},
+        {"2-byte length header", framing("", "", "", 2), "\0\x03" "ABC\0\x01Z"s, "ABC|Z"},
+        {"4-byte header, suffix stripped", framing("", "", "\x03", 4), "\0\0\0\x04" "ABC\x03"s, "ABC"},
+        {"oversized frame dropped", framing("\r"), oversized + "\rOK\r", "OK +1 dropped"},
+        {"invalid length header size", framing("", "", "", 3), "", "error"},
+        {"no way to end a frame", framing(""), "", "error"},
+        {"prefix too long", framing("\r", "0123456789ABCDEFG"), "", "error"},
+    };
+
+    bool ok = true;
+    for (const Case& check : cases) {
+        ok &= run(check);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: byte streams framed wrong\n");
+        return 1;
+    }
+    std::printf("OK: scan framer\n");
+    return 0;
+}
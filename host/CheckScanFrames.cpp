@@ -0,0 +1,115 @@
+// Feeds framed scans (as serial and TCP sources deliver them) through the
+// scanner on a virtual clock and checks what comes out: repeats of a code are
+// only suppressed within the duplicate window, and once more devices than
+// assembler slots show up, a stream that just sent a frame keeps its slot
+// while idle keyboards are recycled. Exits non-zero on a mismatch.
+//
+// Usage: CheckScanFrames
+
+#include "HybridExternalScanner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+constexpr int kDeviceId = 0x20000; // first serial device id
+
+struct Step {
+    int64_t atMs; // virtual time the frame arrives
+    const char* frame;
+};
+
+struct Case {
+    const char* name;
+    double dedupWindowMs;
+    std::vector<Step> steps;
+    size_t expectedScans;
+};
+
+bool run(const Case& check) {
+    const auto start = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+    auto clock = std::make_shared<VirtualClock>(start, 0);
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(false);
+    scanner->setClock(clock);
+    scanner->setDuplicateFilter(check.dedupWindowMs, DedupScope::DEVICE);
+
+    size_t scans = 0;
+    scanner->startScanning([&](const ScanResult&) { scans++; }, std::nullopt);
+    for (const Step& step : check.steps) {
+        clock->set(start + std::chrono::milliseconds(step.atMs));
+        scanner->onScanFrame(kDeviceId, step.frame);
+    }
+    scanner->stopScanning();
+
+    const bool ok = scans == check.expectedScans;
+    std::printf("%-36s %zu scans, expected %zu  %s\n", check.name, scans, check.expectedScans, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+bool hasAssembler(const std::vector<DeviceTiming>& timings, int deviceId) {
+    return std::any_of(timings.begin(), timings.end(),
+                       [&](const DeviceTiming& timing) { return timing.deviceId == deviceId; });
+}
+
+// Fills all but one slot with keyboards, sends a frame, then adds one more
+// keyboard: the least recently used keyboard goes, not the stream
+bool runEviction() {
+    const auto start = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+    auto clock = std::make_shared<VirtualClock>(start, 0);
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(false);
+    scanner->setClock(clock);
+
+    const auto key = [&](int deviceId, int64_t atMs) {
+        clock->set(start + std::chrono::milliseconds(atMs));
+        scanner->onKeyEvent(0, 0, "A", deviceId);
+        scanner->onKeyEvent(66, 0, "\n", deviceId); // Enter, so the slot is idle
+    };
+    scanner->startScanning([](const ScanResult&) {}, std::nullopt);
+    const int keyboards = static_cast<int>(AssemblerTable::kCapacity) - 1;
+    for (int deviceId = 1; deviceId <= keyboards; deviceId++) {
+        key(deviceId, deviceId * 10);
+    }
+    clock->set(start + std::chrono::milliseconds(1000));
+    scanner->onScanFrame(kDeviceId, "ABC123");
+    key(keyboards + 1, 2000);
+    const std::vector<DeviceTiming> timings = scanner->getLearnedTimeouts();
+    scanner->stopScanning();
+
+    const bool streamKept = hasAssembler(timings, kDeviceId);
+    const bool oldestEvicted = !hasAssembler(timings, 1);
+    const bool ok = streamKept && oldestEvicted;
+    std::printf("%-36s stream %s, oldest keyboard %s  %s\n", "slot eviction with a stream",
+                streamKept ? "kept" : "evicted", oldestEvicted ? "evicted" : "kept", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<Case> cases = {
+        {"filter off", 0, {{0, "ABC123"}, {10, "ABC123"}, {20, "ABC123"}}, 3},
+        {"repeats outside the window", 50, {{0, "ABC123"}, {300, "ABC123"}, {600, "ABC123"}}, 3},
+        {"repeats inside the window", 50, {{0, "ABC123"}, {10, "ABC123"}, {20, "ABC123"}}, 1},
+        {"different codes inside the window", 50, {{0, "ABC123"}, {10, "XYZ789"}, {20, "ABC123"}}, 2},
+    };
+
+    bool ok = true;
+    for (const Case& check : cases) {
+        ok &= run(check);
+    }
+    ok &= runEviction();
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: framed scans came out wrong\n");
+        return 1;
+    }
+    std::printf("OK: framed scans\n");
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Writes scans to a journal in a temporary directory, tears the last record
+// as a crash mid-append would, and checks what reopening replays: the intact
+// records, then new appends in place of the torn one, minus whatever was
+// acknowledged. Also checks replay across rotated segments. Exits non-zero on
+// a mismatch.
+//
+// Usage: CheckScanJournal
+
+#include "ScanJournal.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+// "sequence:code ..." for the unacknowledged records, codes cut at padding
+std::string replay(ScanJournal& journal) {
+    std::string text;
+    for (const JournalRecord& record : journal.read(0, 100)) {
+        const std::string code = record.code.substr(0, record.code.find('.'));
+        text += (text.empty() ? "" : " ") + std::to_string(record.sequence) + ":" + code;
+    }
+    return text;
+}
+
+bool expect(const char* name, const std::string& got, const std::string& expected) {
+    const bool ok = got == expected;
+    std::printf("%-36s %-32s %s\n", name, got.empty() ? "(nothing)" : got.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+std::string onlySegment(const std::string& directory) {
+    std::string path;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() == ".journal") {
+            path = entry.path().string();
+        }
+    }
+    return path;
+}
+
+// Flips a byte of the third record's code, so its CRC no longer matches.
+// Records are 32 bytes plus the code padded to 8, after a 32-byte header.
+void tearThirdRecord(const std::string& segment, size_t codeLength) {
+    const size_t record = (32 + codeLength + 7) & ~size_t{7};
+    std::fstream file(segment, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(32 + 2 * record + 32));
+    file.put('#');
+}
+
+bool checkTornWrite(const std::string& directory) {
+    bool ok = true;
+    {
+        auto journal = ScanJournal::open(directory);
+        if (!journal) {
+            return expect("open journal", "failed", "opened");
+        }
+        journal->append("SCAN-001", 1.0, 1);
+        journal->append("SCAN-002", 2.0, 1);
+        journal->append("SCAN-003", 3.0, 1);
+        journal->sync();
+    }
+    tearThirdRecord(onlySegment(directory), 8);
+    {
+        auto journal = ScanJournal::open(directory);
+        ok &= expect("torn record dropped", replay(*journal), "1:SCAN-001 2:SCAN-002");
+        journal->append("SCAN-004", 4.0, 1);
+        ok &= expect("append after recovery", replay(*journal), "1:SCAN-001 2:SCAN-002 3:SCAN-004");
+        journal->acknowledge(2);
+        journal->sync();
+    }
+    {
+        auto journal = ScanJournal::open(directory);
+        ok &= expect("acknowledged records not replayed", replay(*journal), "3:SCAN-004");
+        ok &= expect("sequence continues", std::to_string(journal->append("SCAN-005", 5.0, 1)), "4");
+    }
+    return ok;
+}
+
+bool checkSegments(const std::string& directory) {
+    bool ok = true;
+    std::string expected;
+    // The smallest segment that fits a record of kMaxCodeLength; padded
+    // codes put two records in each
+    constexpr size_t kSegmentSize = 32 + 32 + ScanJournal::kMaxCodeLength;
+    {
+        auto journal = ScanJournal::open(directory, kSegmentSize);
+        for (int i = 1; i <= 8; i++) {
+            const std::string label = "ITEM-" + std::to_string(i);
+            journal->append(label + std::string(1500, '.'), static_cast<double>(i), 2);
+            if (i > 6) {
+                expected += (expected.empty() ? "" : " ") + std::to_string(i) + ":" + label;
+            }
+        }
+        journal->acknowledge(6);
+        journal->sync();
+    }
+    auto journal = ScanJournal::open(directory, kSegmentSize);
+    if (!journal) {
+        return expect("reopen rotated journal", "failed", "opened");
+    }
+    ok &= expect("replay across segments", replay(*journal), expected);
+    size_t segments = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        segments += entry.path().extension() == ".journal";
+    }
+    ok &= expect("acknowledged segments deleted", std::to_string(segments), "1");
+    return ok;
+}
+
+std::string makeDirectory() {
+    char pattern[] = "/tmp/scanjournal-XXXXXX";
+    const char* directory = mkdtemp(pattern);
+    return directory != nullptr ? directory : "";
+}
+
+} // namespace
+
+int main() {
+    const std::string torn = makeDirectory();
+    const std::string rotated = makeDirectory();
+    if (torn.empty() || rotated.empty()) {
+        std::fprintf(stderr, "FAIL: cannot create a temporary directory\n");
+        return 1;
+    }
+    const bool ok = checkTornWrite(torn) & checkSegments(rotated);
+    std::filesystem::remove_all(torn);
+    std::filesystem::remove_all(rotated);
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: journal replayed wrong\n");
+        return 1;
+    }
+    std::printf("OK: scan journal\n");
+    return 0;
+}
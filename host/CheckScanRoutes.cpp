@@ -0,0 +1,91 @@
+// Compiles a set of routing rules and checks which rule each code matches:
+// the first rule in registration order wins, length ranges count the whole
+// code, and invalid rules are rejected. Exits non-zero on a mismatch.
+//
+// Usage: CheckScanRoutes
+
+#include "ScanRouter.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+struct Case {
+    const char* name;
+    std::string code;
+    const char* expected; // rule id, or "" for no match
+};
+
+RouteRule rule(const char* id, const char* prefix, const char* pattern, size_t minLength = 0,
+               size_t maxLength = SIZE_MAX) {
+    return RouteRule{id, prefix, pattern, minLength, maxLength};
+}
+
+bool run(const ScanRouter& router, const Case& check) {
+    const int index = router.match(check.code);
+    const std::string got = index >= 0 ? router.ruleId(index) : "";
+    const bool ok = got == check.expected;
+    std::printf("%-36s %-12s %s\n", check.name, got.empty() ? "(none)" : got.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+bool runInvalid(const char* name, const std::vector<RouteRule>& rules) {
+    std::string error;
+    const bool ok = ScanRouter::compile(rules, error) == nullptr && !error.empty();
+    std::printf("%-36s %-12s %s\n", name, ok ? "rejected" : "compiled", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<RouteRule> rules = {
+        rule("sscc", "00", "\\d{18}"),
+        rule("gtin", "", "\\d{14}"),
+        rule("retail", "", "\\d+", 8, 13),
+        rule("isbn", "978", "\\d{10}"), // shadowed by "retail"
+        rule("location", "LOC-", "[A-Z]{2}\\d{3}"),
+        rule("any-location", "LOC-", ""),
+        rule("order", "", "^(PO|SO)-\\d+$"),
+        rule("short", "", ".*", 1, 4),
+    };
+    std::string error;
+    std::shared_ptr<const ScanRouter> router = ScanRouter::compile(rules, error);
+    if (!router) {
+        std::fprintf(stderr, "FAIL: rules did not compile: %s\n", error.c_str());
+        return 1;
+    }
+
+    const std::vector<Case> cases = {
+        {"SSCC with its prefix", "00106141411234567897", "sscc"},
+        {"GTIN-14", "10614141123453", "gtin"},
+        {"EAN-13 within the length range", "4006381333931", "retail"},
+        {"EAN-8 at the minimum length", "96385074", "retail"},
+        {"digits below the length range", "1234567", ""},
+        {"earlier rule shadows a later one", "9780306406157", "retail"},
+        {"prefix and pattern", "LOC-AB123", "location"},
+        {"prefix, pattern mismatch", "LOC-ab", "any-location"},
+        {"prefix alone", "LOC-", "any-location"},
+        {"alternation", "SO-17", "order"},
+        {"alternation mismatch", "XO-17", ""},
+        {"maximum length", "ab-c", "short"},
+        {"above the maximum length", "ab-cd", ""},
+    };
+
+    bool ok = true;
+    for (const Case& check : cases) {
+        ok &= run(*router, check);
+    }
+    ok &= runInvalid("minLength above maxLength", {rule("bad", "", "\\d+", 10, 5)});
+    ok &= runInvalid("unterminated class", {rule("bad", "", "[A-")});
+    ok &= runInvalid("too many rules", std::vector<RouteRule>(ScanRouter::kMaxRules + 1, rule("r", "", "A")));
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: scans routed wrong\n");
+        return 1;
+    }
+    std::printf("OK: scan routes\n");
+    return 0;
+}
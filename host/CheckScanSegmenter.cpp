@@ -0,0 +1,146 @@
+// Splits scans from scanners configured with a prefix/suffix, AIM identifiers
+// and several codes per trigger, and checks the codes and symbologies that
+// come out. Also runs framed scans through the scanner with GS1 parsing on:
+// only GS1 symbologies, or scans without a known identifier, get elements.
+// Exits non-zero on a mismatch.
+//
+// Usage: CheckScanSegmenter
+
+#include "HybridExternalScanner.hpp"
+#include "ScanSegmenter.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+struct SplitCase {
+    const char* name;
+    ScanFormatConfig config;
+    std::string scan;
+    std::string expected; // "code [symbology]; ..." or "error"
+};
+
+std::string printable(std::string_view text) {
+    std::string out;
+    for (char c : text) {
+        if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\x%02X", static_cast<unsigned char>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+bool runSplit(const SplitCase& check) {
+    std::string got;
+    std::string error;
+    std::unique_ptr<const ScanSegmenter> segmenter = ScanSegmenter::create(check.config, error);
+    if (!segmenter) {
+        got = "error";
+    } else {
+        ScanSegmenter::Segments segments;
+        const size_t count = segmenter->split(check.scan, segments);
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) {
+                got += "; ";
+            }
+            got += printable(segments[i].code);
+            if (!segments[i].symbology.empty()) {
+                got += " [" + std::string(segments[i].symbology) + "]";
+            }
+        }
+    }
+    const bool ok = got == check.expected;
+    std::printf("%-36s %-40s %s\n", check.name, got.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+struct Gs1Case {
+    const char* name;
+    const char* frame;
+    const char* expected; // "ai=value ..." or "" for no elements
+};
+
+bool runGs1(const Gs1Case& check) {
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(false);
+    scanner->setScanFormat(ScanFormat(std::nullopt, std::nullopt, true, std::nullopt));
+    scanner->setGs1Parsing(true);
+
+    std::string got = "(no scan)";
+    scanner->startScanning([&](const ScanResult& result) {
+        got.clear();
+        for (const Gs1Element& element : result.elements.value_or(std::vector<Gs1Element>())) {
+            got += (got.empty() ? "" : " ") + element.ai + "=" + element.value;
+        }
+    }, std::nullopt);
+    scanner->onScanFrame(0x20000, check.frame);
+    scanner->stopScanning();
+
+    const bool ok = got == check.expected;
+    std::printf("%-36s %-40s %s\n", check.name, got.empty() ? "(no elements)" : got.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    const ScanFormatConfig plain;
+    const ScanFormatConfig framed{"\x02", "\x03", false, ""};
+    const ScanFormatConfig aim{"", "", true, ""};
+    const ScanFormatConfig multi{"", "", true, "\t"};
+    const ScanFormatConfig all{"\x02", "\x03", true, "\t"};
+    const ScanFormatConfig commas{"", "", false, ","};
+
+    std::string manyCodes;
+    for (char c = 'A'; c <= 'T'; c++) {
+        manyCodes += std::string(manyCodes.empty() ? "" : ",") + c;
+    }
+
+    const std::vector<SplitCase> cases = {
+        {"no format", plain, "ABC123", "ABC123"},
+        {"prefix and suffix", framed, "\x02" "ABC123" "\x03", "ABC123"},
+        {"suffix only", framed, "ABC123" "\x03", "ABC123"},
+        {"partial prefix stays in the code", {"##", "", false, ""}, "#ABC", "#ABC"},
+        {"AIM EAN-13", aim, "]E04006381333931", "4006381333931 [EAN-13]"},
+        {"AIM EAN-8", aim, "]E496385074", "96385074 [EAN-8]"},
+        {"AIM GS1-128", aim, "]C10109501101020917", "0109501101020917 [GS1-128]"},
+        {"AIM Code 128", aim, "]C0ABC", "ABC [Code 128]"},
+        {"unknown AIM identifier", aim, "]X9ABC", "ABC []X9]"},
+        {"no AIM identifier", aim, "]1ABC", "]1ABC"},
+        {"two codes per trigger", multi, "]E04006381333931\t]C10109501101020917",
+         "4006381333931 [EAN-13]; 0109501101020917 [GS1-128]"},
+        {"prefix, AIM, suffix per code", all, "\x02]E0123\x03\t\x02]A0XYZ\x03", "123 [EAN-13]; XYZ [Code 39]"},
+        {"empty codes skipped", commas, "A,,B,", "A; B"},
+        {"codes beyond the maximum", commas, manyCodes, "A; B; C; D; E; F; G; H; I; J; K; L; M; N; O; P,Q,R,S,T"},
+        {"separator in the suffix", {"", ",", false, ","}, "A,", "error"},
+        {"prefix too long", {std::string(ScanSegmenter::kMaxAffix + 1, '#'), "", false, ""}, "A", "error"},
+    };
+    const std::vector<Gs1Case> gs1Cases = {
+        {"GS1 parsing, GS1-128", "]C110ABC", "10=ABC"},
+        {"GS1 parsing, EAN-13", "]E04006381333931", ""},
+        {"GS1 parsing, Code 128", "]C00109501101020917", ""},
+        {"GS1 parsing, unknown identifier", "]X90109501101020917", "01=09501101020917"},
+    };
+
+    bool ok = true;
+    for (const SplitCase& check : cases) {
+        ok &= runSplit(check);
+    }
+    for (const Gs1Case& check : gs1Cases) {
+        ok &= runGs1(check);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: scans split wrong\n");
+        return 1;
+    }
+    std::printf("OK: scan segmenter\n");
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Runs one session through a scanner on a virtual clock and checks every
+// pipeline counter in getStats(): keys received and ignored, and scans
+// emitted, too short, timed out, invalid, duplicate, unrouted and
+// overflowed. Also checks the latency histogram percentiles against exact
+// ones and that resetStats() clears everything. Exits non-zero on a mismatch.
+//
+// Usage: CheckStats
+
+#include "HybridExternalScanner.hpp"
+#include "PipelineStats.hpp"
+#include "ScannerClock.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+constexpr int kEnter = 66; // Android KEYCODE_ENTER
+
+// Types code 3 ms per key from atMs on, optionally followed by Enter
+void type(HybridExternalScanner& scanner, VirtualClock& clock, std::chrono::steady_clock::time_point start,
+          int64_t atMs, const std::string& code, bool enter) {
+    for (size_t i = 0; i < code.size(); i++, atMs += 3) {
+        clock.set(start + std::chrono::milliseconds(atMs));
+        scanner.fireDeadlines();
+        scanner.onKeyEvent(0, 0, std::string_view(code).substr(i, 1), 1);
+    }
+    if (enter) {
+        clock.set(start + std::chrono::milliseconds(atMs));
+        scanner.onKeyEvent(kEnter, 0, "\n", 1);
+    }
+}
+
+bool expect(const char* name, double got, double expected) {
+    const bool ok = got == expected;
+    std::printf("%-36s %-10.0f %s\n", name, got, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Percentiles of 1..100000 ns must be within a sub-bucket (12.5%) of exact
+bool checkHistogram() {
+    LatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 100000; ns++) {
+        histogram.record(ns);
+    }
+    const LatencyHistogram::Summary summary = histogram.summarize();
+    auto near = [](uint64_t got, uint64_t exact) { return got >= exact && got <= exact + exact / 8; };
+    const bool ok = summary.count == 100000 && summary.max == 100000 && near(summary.p50, 50000) &&
+                    near(summary.p90, 90000) && near(summary.p99, 99000) && near(summary.p999, 99900);
+    std::printf("%-36s p50 %llu p99 %llu %s\n", "histogram percentiles", static_cast<unsigned long long>(summary.p50),
+                static_cast<unsigned long long>(summary.p99), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    const auto start = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+    auto clock = std::make_shared<VirtualClock>(start, 1700000000000);
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->setThreadedProcessing(false);
+    scanner->setClock(clock);
+    scanner->setValidationPolicy(ValidationPolicy::REJECT);
+    scanner->setDuplicateFilter(1000, DedupScope::DEVICE);
+    scanner->setMaxScanLength(20, ScanOverflowPolicy::DISCARD);
+    ScanRoute route;
+    route.id = "known";
+    route.prefix = "4";
+    ScanRoute other;
+    other.id = "other";
+    other.prefix = "X";
+    scanner->setScanRoutes({route, other}, true);
+
+    int keys = 0;
+    int scans = 0;
+    const auto session = [&](int64_t atMs, const std::string& code, bool enter) {
+        type(*scanner, *clock, start, atMs, code, enter);
+        keys += static_cast<int>(code.size()) + (enter ? 1 : 0);
+    };
+
+    scanner->onKeyEvent(0, 0, "A", 1); // not scanning yet
+    scanner->startScanning([&](const ScanResult&) { scans++; }, std::nullopt);
+    session(0, "4006381333931", true);
+    session(100, "4006381333931", true);       // duplicate
+    session(2000, "4006381333932", true);      // bad check digit
+    session(3000, "AB", true);                 // too short
+    session(4000, "ZZZ123", true);             // no route
+    session(5000, std::string(25, '4'), true); // overflowed
+    session(6000, "X12345", false);            // completed by the timeout
+    clock->set(start + std::chrono::milliseconds(7000));
+    scanner->fireDeadlines();
+
+    const ScannerStats stats = scanner->getStats();
+    bool ok = true;
+    ok &= expect("callbacks", scans, 2);
+    ok &= expect("keys received", stats.keysReceived, keys);
+    ok &= expect("keys ignored", stats.keysIgnored, 1);
+    ok &= expect("keys dropped", stats.keysDropped, 0);
+    ok &= expect("scans emitted", stats.scansEmitted, 2);
+    ok &= expect("scans too short", stats.scansTooShort, 1);
+    ok &= expect("scans timed out", stats.scansTimedOut, 1);
+    ok &= expect("scans invalid", stats.scansInvalid, 1);
+    ok &= expect("scans duplicate", stats.scansDuplicate, 1);
+    ok &= expect("suppressed duplicate count", scanner->getSuppressedDuplicateCount(), 1);
+    ok &= expect("scans unrouted", stats.scansUnrouted, 1);
+    ok &= expect("scans overflowed", stats.scansOverflowed, 1);
+    ok &= expect("assembly latencies", stats.assembly.count, 2);
+    ok &= expect("callback latencies", stats.callback.count, 2);
+
+    scanner->resetStats();
+    const ScannerStats reset = scanner->getStats();
+    ok &= expect("keys received after reset", reset.keysReceived, 0);
+    ok &= expect("scans emitted after reset", reset.scansEmitted, 0);
+    ok &= expect("assembly latencies after reset", reset.assembly.count, 0);
+    scanner->stopScanning();
+
+    ok &= checkHistogram();
+
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: pipeline stats counted wrong\n");
+        return 1;
+    }
+    std::printf("OK: pipeline stats\n");
+    return 0;
+}
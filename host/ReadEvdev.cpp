@@ -0,0 +1,102 @@
+// Reads scans straight from evdev devices (see cpp/EvdevInput.hpp) and prints
+// them, one per line: timestamp (ms), device id, code. With --stdin it reads
+// input_event structs from standard input instead, e.g. from a pipe.
+//
+// Usage: ReadEvdev [--vendor id] [--product id] [--grab] [--dir path]
+//                  [--layout us|de|fr] [--stdin]
+
+#include "HybridExternalScanner.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr, "Usage: ReadEvdev [--vendor id] [--product id] [--grab] [--dir path] "
+                         "[--layout us|de|fr] [--stdin]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    EvdevInputOptions options;
+    bool fromStdin = false;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (argument == "--grab") {
+            options.grab = true;
+        } else if (argument == "--stdin") {
+            fromStdin = true;
+        } else if (argument == "--vendor" && value != nullptr) {
+            options.vendorId = static_cast<double>(std::strtol(value, nullptr, 0));
+            i++;
+        } else if (argument == "--product" && value != nullptr) {
+            options.productId = static_cast<double>(std::strtol(value, nullptr, 0));
+            i++;
+        } else if (argument == "--dir" && value != nullptr) {
+            options.directory = value;
+            i++;
+        } else if (argument == "--layout" && value != nullptr) {
+            if (std::strcmp(value, "de") == 0) {
+                scanner->setKeyboardLayout(KeyboardLayout::DE);
+            } else if (std::strcmp(value, "fr") == 0) {
+                scanner->setKeyboardLayout(KeyboardLayout::FR);
+            } else {
+                scanner->setKeyboardLayout(KeyboardLayout::US);
+            }
+            i++;
+        } else {
+            return usage();
+        }
+    }
+
+    scanner->startScanning([](const ScanResult& result) {
+        std::printf("%.0f\t%.0f\t%s\n", result.timestamp, result.deviceId, result.code.c_str());
+        std::fflush(stdout);
+    }, std::nullopt);
+
+    if (!fromStdin) {
+        const double opened = scanner->startEvdevInput(options);
+        if (opened < 0) {
+            return 1;
+        }
+        std::fprintf(stderr, "Reading %.0f devices\n", opened);
+        // Runs until killed; scanners plugged in later are picked up as well
+        for (;;) {
+            pause();
+        }
+    }
+
+    // Stop once standard input closes (its device disconnects) and its last
+    // scan completed
+    std::mutex mutex;
+    std::condition_variable closed;
+    bool done = false;
+    scanner->onScannerConnectionChanged([&](bool connected) {
+        if (!connected) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+            closed.notify_one();
+        }
+    });
+    if (scanner->addInputSource(std::make_shared<EvdevSource>(dup(STDIN_FILENO), EvdevSource::kDeviceIdBase,
+                                                              KeyCodeSet::Android)) < 0) {
+        return 1;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    closed.wait(lock, [&done] { return done; });
+    lock.unlock();
+    scanner->stopScanning();
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Reads scans from a serial scanner (see cpp/SerialSource.hpp) and prints
+// them, one per line: timestamp (ms), device id, code. With --pty it opens a
+// pseudo-terminal pair, reads the scanner side and writes standard input
+// into the other end, so framing can be tried without hardware:
+//
+//   printf '\x02ABC\x03' | ReadSerial --pty --prefix '\x02' --suffix '\x03'
+//
+// Usage: ReadSerial <tty|tcp://address:port|--pty> [--baud n] [--terminators s]
+//                   [--prefix s] [--suffix s] [--length-header n]
+// Strings take \r, \n, \t and \xHH escapes.
+
+#include "HybridExternalScanner.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr, "Usage: ReadSerial <tty|tcp://address:port|--pty> [--baud n] [--terminators s] "
+                         "[--prefix s] [--suffix s] [--length-header n]\n");
+    return 2;
+}
+
+std::string unescape(const char* value) {
+    std::string result;
+    for (const char* p = value; *p != '\0'; p++) {
+        if (*p != '\\' || p[1] == '\0') {
+            result += *p;
+            continue;
+        }
+        switch (*++p) {
+            case 'r': result += '\r'; break;
+            case 'n': result += '\n'; break;
+            case 't': result += '\t'; break;
+            case 'x': {
+                char* end = nullptr;
+                const char digits[3] = {p[1], p[1] != '\0' ? p[2] : '\0', '\0'};
+                const long code = std::strtol(digits, &end, 16);
+                result += end == digits ? 'x' : static_cast<char>(code);
+                p += end - digits;
+                break;
+            }
+            default: result += *p; break;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return usage();
+    }
+    std::string path = argv[1];
+    SerialFraming framing;
+    double baudRate = 0;
+    for (int i = 2; i < argc; i++) {
+        const std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            return usage();
+        }
+        if (argument == "--baud") {
+            baudRate = std::atof(value);
+        } else if (argument == "--terminators") {
+            framing.terminators = unescape(value);
+        } else if (argument == "--prefix") {
+            framing.prefix = unescape(value);
+        } else if (argument == "--suffix") {
+            framing.suffix = unescape(value);
+        } else if (argument == "--length-header") {
+            framing.lengthHeaderBytes = std::atof(value);
+        } else {
+            return usage();
+        }
+        i++;
+    }
+
+    int master = -1;
+    if (path == "--pty") {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+            std::perror("ReadSerial: pty");
+            return 1;
+        }
+        path = ptsname(master);
+    }
+
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    scanner->startScanning([](const ScanResult& result) {
+        std::printf("%.0f\t%.0f\t%s\n", result.timestamp, result.deviceId, result.code.c_str());
+        std::fflush(stdout);
+    }, std::nullopt);
+    if (scanner->openSerialInput(path, framing, baudRate) < 0) {
+        return 1;
+    }
+
+    if (master < 0) {
+        // Runs until killed
+        for (;;) {
+            pause();
+        }
+    }
+
+    char buffer[4096];
+    ssize_t bytes = 0;
+    while ((bytes = read(STDIN_FILENO, buffer, sizeof(buffer))) > 0) {
+        if (write(master, buffer, static_cast<size_t>(bytes)) != bytes) {
+            std::perror("ReadSerial: write");
+            return 1;
+        }
+    }
+    // Give the reader time to drain the pty
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    scanner->stopScanning();
+    close(master);
+    return 0;
+}
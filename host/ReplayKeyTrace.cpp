@@ -0,0 +1,69 @@
+// Replays a key trace recorded with startKeyTrace() and prints the scans,
+// one per line: timestamp (ms), device id, code.
+//
+// Usage: ReplayKeyTrace <trace> [--timeout ms] [--min-length n] [--adaptive]
+//                               [--speed fast|recorded|<factor>] [--batch ms]
+
+#include "KeyTraceReplayer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace margelo::nitro::externalscanner;
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr, "Usage: ReplayKeyTrace <trace> [--timeout ms] [--min-length n] [--adaptive] "
+                         "[--speed fast|recorded|<factor>] [--batch ms]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return usage();
+    }
+    auto scanner = std::make_shared<HybridExternalScanner>();
+    ReplayOptions options;
+    for (int i = 2; i < argc; i++) {
+        const std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (argument == "--adaptive") {
+            scanner->setAdaptiveTimeout(true);
+        } else if (argument == "--timeout" && value != nullptr) {
+            scanner->setScanTimeout(std::atof(value));
+            i++;
+        } else if (argument == "--min-length" && value != nullptr) {
+            scanner->setMinScanLength(std::atof(value));
+            i++;
+        } else if (argument == "--batch" && value != nullptr) {
+            options.batchHold = std::chrono::milliseconds(std::atoi(value));
+            i++;
+        } else if (argument == "--speed" && value != nullptr) {
+            if (std::strcmp(value, "fast") == 0) {
+                options.speed = ReplaySpeed::AsFastAsPossible;
+            } else if (std::strcmp(value, "recorded") == 0) {
+                options.speed = ReplaySpeed::Recorded;
+            } else {
+                options.speed = ReplaySpeed::Scaled;
+                options.scale = std::atof(value);
+            }
+            i++;
+        } else {
+            return usage();
+        }
+    }
+
+    std::optional<KeyTrace> trace = KeyTrace::load(argv[1]);
+    if (!trace) {
+        return 1;
+    }
+    for (const ScanResult& result : replayKeyTrace(*scanner, *trace, options)) {
+        std::printf("%.0f\t%.0f\t%s\n", result.timestamp, result.deviceId, result.code.c_str());
+    }
+    return 0;
+}
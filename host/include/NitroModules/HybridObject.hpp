@@ -0,0 +1,40 @@
+#pragma once
+
+// Host stand-in for Nitro's HybridObject: enough for the generated spec to
+// compile and register its methods, without a JS runtime.
+
+#include <memory>
+
+namespace margelo::nitro {
+
+class Prototype {
+public:
+    template <typename Method>
+    void registerHybridMethod(const char*, Method) {}
+    template <typename Getter>
+    void registerHybridGetter(const char*, Getter) {}
+    template <typename Setter>
+    void registerHybridSetter(const char*, Setter) {}
+};
+
+class HybridObject : public std::enable_shared_from_this<HybridObject> {
+public:
+    explicit HybridObject(const char* name) : _name(name) {}
+    virtual ~HybridObject() = default;
+
+    const char* getName() const { return _name; }
+
+protected:
+    virtual void loadHybridMethods() {}
+
+    template <typename Derived, typename Register>
+    void registerHybrids(Derived*, Register&& registerMethods) {
+        Prototype prototype;
+        registerMethods(prototype);
+    }
+
+private:
+    const char* _name;
+};
+
+} // namespace margelo::nitro
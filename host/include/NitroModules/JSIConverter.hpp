@@ -0,0 +1,19 @@
+#pragma once
+
+// Host stand-in: converters are never invoked without a JS runtime
+
+#include "NitroHash.hpp"
+#include "jsi.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace margelo::nitro {
+
+template <typename T, typename Enable = void>
+struct JSIConverter {
+    static T fromJSI(jsi::Runtime&, const jsi::Value&) { return T{}; }
+    static jsi::Value toJSI(jsi::Runtime&, const T&) { return {}; }
+    static bool canConvert(jsi::Runtime&, const jsi::Value&) { return false; }
+};
+
+} // namespace margelo::nitro
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "jsi.hpp"
+
+namespace margelo::nitro {
+
+inline bool isPlainObject(jsi::Runtime&, const jsi::Object&) { return true; }
+
+} // namespace margelo::nitro
@@ -0,0 +1,6 @@
+#pragma once
+
+// Swift interop annotations are meaningless on the host
+#define SWIFT_PRIVATE
+#define SWIFT_NAME(name)
+#define CLOSED_ENUM
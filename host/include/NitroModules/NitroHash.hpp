@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace margelo::nitro {
+
+// FNV-1a, like Nitro's; only used to switch over union strings
+constexpr uint64_t hashString(const char* string, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<uint8_t>(string[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+template <size_t N>
+constexpr uint64_t hashString(const char (&string)[N]) {
+    return hashString(string, N - 1);
+}
+
+} // namespace margelo::nitro
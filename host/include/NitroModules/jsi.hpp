@@ -0,0 +1,39 @@
+#pragma once
+
+// Host stand-in for the JSI types referenced by the generated converters.
+// Nothing here talks to a JS runtime; see the top-level CMakeLists.txt.
+
+#include <string>
+
+namespace facebook::jsi {
+
+class Runtime {};
+class Object;
+
+class Value {
+public:
+    Value() = default;
+    Value(const Object&) {}
+    bool isObject() const { return false; }
+    bool isString() const { return false; }
+    bool isUndefined() const { return true; }
+    Object asObject(Runtime&) const;
+    Object getObject(Runtime&) const;
+};
+
+class Object {
+public:
+    Object() = default;
+    explicit Object(Runtime&) {}
+    Value getProperty(Runtime&, const char*) const { return {}; }
+    void setProperty(Runtime&, const char*, const Value&) {}
+};
+
+inline Object Value::asObject(Runtime&) const { return Object(); }
+inline Object Value::getObject(Runtime&) const { return Object(); }
+
+} // namespace facebook::jsi
+
+namespace margelo::nitro {
+namespace jsi = facebook::jsi;
+} // namespace margelo::nitro
@@ -1,12 +1,24 @@
 #import "ExternalScannerObserver.h"
 #include "HybridExternalScanner_ios.hpp"
 #include "DeviceInfo.hpp"
+#include "ScannerLog.hpp"
 #include <vector>
 
 using namespace margelo::nitro::externalscanner;
 
 #define LOG_TAG @"[ExternalScanner]"
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_DEBUG
 #define ES_LOG(fmt, ...) NSLog(@"%@ " fmt, LOG_TAG, ##__VA_ARGS__)
+#else
+#define ES_LOG(fmt, ...) do {} while (0)
+#endif
+
+// Per-key logs are only compiled in at TRACE level
+#if ES_LOG_LEVEL <= ES_LOG_LEVEL_TRACE
+#define ES_LOG_KEY(fmt, ...) ES_LOG(fmt, ##__VA_ARGS__)
+#else
+#define ES_LOG_KEY(fmt, ...) do {} while (0)
+#endif
 
 @interface ExternalScannerObserver ()
 
@@ -64,7 +76,8 @@ using namespace margelo::nitro::externalscanner;
         ES_LOG(@"checkConnectedDevices - Keyboard input available: %@", keyboard.keyboardInput ? @"YES" : @"NO");
         [self.connectedDevices addObject:@{
             @"id": @(1),
-            @"name": @"External Keyboard",
+            // Device rules match on the name; there are no USB ids here
+            @"name": keyboard.vendorName ?: @"External Keyboard",
             @"vendorId": @(0),
             @"productId": @(0),
             @"isExternal": @YES
@@ -140,7 +153,7 @@ using namespace margelo::nitro::externalscanner;
                                                      GCControllerButtonInput * _Nonnull key,
                                                      GCKeyCode keyCode,
                                                      BOOL pressed) {
-            ES_LOG(@"keyChangedHandler - keyCode: %ld, pressed: %@", (long)keyCode, pressed ? @"YES" : @"NO");
+            ES_LOG_KEY(@"keyChangedHandler - keyCode: %ld, pressed: %@", (long)keyCode, pressed ? @"YES" : @"NO");
             [weakSelf handleKeyCode:keyCode pressed:pressed];
         };
         ES_LOG(@"setupGCKeyboardHandler - Handler set successfully");
@@ -161,21 +174,21 @@ using namespace margelo::nitro::externalscanner;
 }
 
 - (void)handleTextInput:(NSString *)text {
-    ES_LOG(@"handleTextInput - text: '%@', isMonitoring: %@", text, self.isMonitoring ? @"YES" : @"NO");
+    ES_LOG_KEY(@"handleTextInput - text: '%@', isMonitoring: %@", text, self.isMonitoring ? @"YES" : @"NO");
 
     if (!self.isMonitoring) {
-        ES_LOG(@"handleTextInput - Not monitoring, ignoring");
+        ES_LOG_KEY(@"handleTextInput - Not monitoring, ignoring");
         return;
     }
 
     auto instance = HybridExternalScannerIOS::getInstance();
     if (!instance) {
-        ES_LOG(@"handleTextInput - ERROR: Instance is null");
+        ES_LOG_KEY(@"handleTextInput - ERROR: Instance is null");
         return;
     }
 
     if (!instance->isScanning()) {
-        ES_LOG(@"handleTextInput - Not scanning, ignoring");
+        ES_LOG_KEY(@"handleTextInput - Not scanning, ignoring");
         return;
     }
 
@@ -183,7 +196,7 @@ using namespace margelo::nitro::externalscanner;
         unichar c = [text characterAtIndex:i];
         NSString *charStr = [NSString stringWithCharacters:&c length:1];
 
-        ES_LOG(@"handleTextInput - Sending char: '%@'", charStr);
+        ES_LOG_KEY(@"handleTextInput - Sending char: '%@'", charStr);
         instance->handleKeyInput(
             std::string([charStr UTF8String]),
             0,
@@ -193,94 +206,47 @@ using namespace margelo::nitro::externalscanner;
 }
 
 - (void)handleEnterKey {
-    ES_LOG(@"handleEnterKey - Called, isMonitoring: %@", self.isMonitoring ? @"YES" : @"NO");
+    ES_LOG_KEY(@"handleEnterKey - Called, isMonitoring: %@", self.isMonitoring ? @"YES" : @"NO");
 
     if (!self.isMonitoring) return;
 
     auto instance = HybridExternalScannerIOS::getInstance();
     if (!instance || !instance->isScanning()) {
-        ES_LOG(@"handleEnterKey - Instance null or not scanning");
+        ES_LOG_KEY(@"handleEnterKey - Instance null or not scanning");
         return;
     }
 
-    ES_LOG(@"handleEnterKey - Sending enter key");
+    ES_LOG_KEY(@"handleEnterKey - Sending enter key");
     instance->handleKeyInput("", 40, true);
 }
 
 - (void)handleKeyCode:(GCKeyCode)keyCode pressed:(BOOL)pressed {
-    ES_LOG(@"handleKeyCode - keyCode: %ld, pressed: %@, isMonitoring: %@",
+    ES_LOG_KEY(@"handleKeyCode - keyCode: %ld, pressed: %@, isMonitoring: %@",
            (long)keyCode, pressed ? @"YES" : @"NO", self.isMonitoring ? @"YES" : @"NO");
 
     if (!self.isMonitoring) {
-        ES_LOG(@"handleKeyCode - Not monitoring, ignoring");
-        return;
-    }
-
-    if (!pressed) {
-        ES_LOG(@"handleKeyCode - Key up event, ignoring");
+        ES_LOG_KEY(@"handleKeyCode - Not monitoring, ignoring");
         return;
     }
 
     auto instance = HybridExternalScannerIOS::getInstance();
     if (!instance) {
-        ES_LOG(@"handleKeyCode - ERROR: Instance is null");
+        ES_LOG_KEY(@"handleKeyCode - ERROR: Instance is null");
         return;
     }
 
     bool isScanning = instance->isScanning();
-    ES_LOG(@"handleKeyCode - isScanning: %@", isScanning ? @"YES" : @"NO");
+    ES_LOG_KEY(@"handleKeyCode - isScanning: %@", isScanning ? @"YES" : @"NO");
 
     if (!isScanning) {
-        ES_LOG(@"handleKeyCode - Not scanning, ignoring");
+        ES_LOG_KEY(@"handleKeyCode - Not scanning, ignoring");
         return;
     }
 
-    // Convert GCKeyCode to character
-    NSString *character = [self characterForKeyCode:keyCode];
-    ES_LOG(@"handleKeyCode - Mapped character: '%@'", character ?: @"(nil/enter)");
-
-    std::string charStr = character ? std::string([character UTF8String]) : "";
-    ES_LOG(@"handleKeyCode - Sending to C++: char='%s', keyCode=%ld", charStr.c_str(), (long)keyCode);
-
-    instance->handleKeyInput(charStr, (int)keyCode, pressed);
-}
-
-- (NSString *)characterForKeyCode:(GCKeyCode)keyCode {
-    // Check for Enter/Return keys first
-    if (keyCode == GCKeyCodeReturnOrEnter || keyCode == GCKeyCodeKeypadEnter) {
-        ES_LOG(@"characterForKeyCode - Enter key detected (keyCode: %ld)", (long)keyCode);
-        return nil;
-    }
-
-    // Numbers 0-9
-    if (keyCode >= GCKeyCodeOne && keyCode <= GCKeyCodeNine) {
-        return [NSString stringWithFormat:@"%c", (char)('1' + (keyCode - GCKeyCodeOne))];
-    }
-    if (keyCode == GCKeyCodeZero) {
-        return @"0";
-    }
-
-    // Letters A-Z
-    if (keyCode >= GCKeyCodeKeyA && keyCode <= GCKeyCodeKeyZ) {
-        return [NSString stringWithFormat:@"%c", (char)('A' + (keyCode - GCKeyCodeKeyA))];
-    }
-
-    // Special characters
-    if (keyCode == GCKeyCodeHyphen) return @"-";
-    if (keyCode == GCKeyCodeEqualSign) return @"=";
-    if (keyCode == GCKeyCodeOpenBracket) return @"[";
-    if (keyCode == GCKeyCodeCloseBracket) return @"]";
-    if (keyCode == GCKeyCodeBackslash) return @"\\";
-    if (keyCode == GCKeyCodeSemicolon) return @";";
-    if (keyCode == GCKeyCodeQuote) return @"'";
-    if (keyCode == GCKeyCodeGraveAccentAndTilde) return @"`";
-    if (keyCode == GCKeyCodeComma) return @",";
-    if (keyCode == GCKeyCodePeriod) return @".";
-    if (keyCode == GCKeyCodeSlash) return @"/";
-    if (keyCode == GCKeyCodeSpacebar) return @" ";
-
-    ES_LOG(@"characterForKeyCode - Unknown keyCode: %ld", (long)keyCode);
-    return nil;
+    // The C++ keymap translates the key (see cpp/Keymap.hpp) and tracks
+    // the modifiers from key-down/up, so no characters are sent from here
+    ES_LOG_KEY(@"handleKeyCode - Sending to C++: keyCode=%ld, pressed: %@", (long)keyCode, pressed ? @"YES" : @"NO");
+    instance->handleKeyInput("", (int)keyCode, pressed);
 }
 
 - (BOOL)hasExternalScanner {
@@ -0,0 +1,76 @@
+///
+/// DedupScope.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/NitroHash.hpp>)
+#include <NitroModules/NitroHash.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * An enum which can be represented as a JavaScript union (DedupScope).
+   */
+  enum class DedupScope {
+    DEVICE      SWIFT_NAME(device) = 0,
+    GLOBAL      SWIFT_NAME(global) = 1,
+  } CLOSED_ENUM;
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ DedupScope <> JS DedupScope (union)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::DedupScope> final {
+    static inline margelo::nitro::externalscanner::DedupScope fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, arg);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("device"): return margelo::nitro::externalscanner::DedupScope::DEVICE;
+        case hashString("global"): return margelo::nitro::externalscanner::DedupScope::GLOBAL;
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert \"" + unionValue + "\" to enum DedupScope - invalid value!");
+      }
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, margelo::nitro::externalscanner::DedupScope arg) {
+      switch (arg) {
+        case margelo::nitro::externalscanner::DedupScope::DEVICE: return JSIConverter<std::string>::toJSI(runtime, "device");
+        case margelo::nitro::externalscanner::DedupScope::GLOBAL: return JSIConverter<std::string>::toJSI(runtime, "global");
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert DedupScope to JS - invalid value: "
+                                    + std::to_string(static_cast<int>(arg)) + "!");
+      }
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isString()) {
+        return false;
+      }
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, value);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("device"):
+        case hashString("global"):
+          return true;
+        default:
+          return false;
+      }
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,98 @@
+///
+/// DeviceRule.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+// Forward declaration of `RuleAction` to properly resolve imports.
+namespace margelo::nitro::externalscanner { enum class RuleAction; }
+
+#include "RuleAction.hpp"
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (DeviceRule).
+   */
+  struct DeviceRule {
+  public:
+    std::optional<double> vendorId     SWIFT_PRIVATE;
+    std::optional<double> productIdMin     SWIFT_PRIVATE;
+    std::optional<double> productIdMax     SWIFT_PRIVATE;
+    std::optional<std::string> namePattern     SWIFT_PRIVATE;
+    RuleAction action     SWIFT_PRIVATE;
+    std::optional<double> priority     SWIFT_PRIVATE;
+
+  public:
+    DeviceRule() = default;
+    explicit DeviceRule(std::optional<double> vendorId, std::optional<double> productIdMin, std::optional<double> productIdMax, std::optional<std::string> namePattern, RuleAction action, std::optional<double> priority): vendorId(vendorId), productIdMin(productIdMin), productIdMax(productIdMax), namePattern(namePattern), action(action), priority(priority) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ DeviceRule <> JS DeviceRule (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::DeviceRule> final {
+    static inline margelo::nitro::externalscanner::DeviceRule fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::DeviceRule(
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "vendorId")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "productIdMin")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "productIdMax")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "namePattern")),
+        JSIConverter<margelo::nitro::externalscanner::RuleAction>::fromJSI(runtime, obj.getProperty(runtime, "action")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "priority"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::DeviceRule& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "vendorId", JSIConverter<std::optional<double>>::toJSI(runtime, arg.vendorId));
+      obj.setProperty(runtime, "productIdMin", JSIConverter<std::optional<double>>::toJSI(runtime, arg.productIdMin));
+      obj.setProperty(runtime, "productIdMax", JSIConverter<std::optional<double>>::toJSI(runtime, arg.productIdMax));
+      obj.setProperty(runtime, "namePattern", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.namePattern));
+      obj.setProperty(runtime, "action", JSIConverter<margelo::nitro::externalscanner::RuleAction>::toJSI(runtime, arg.action));
+      obj.setProperty(runtime, "priority", JSIConverter<std::optional<double>>::toJSI(runtime, arg.priority));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "vendorId"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "productIdMin"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "productIdMax"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "namePattern"))) return false;
+      if (!JSIConverter<margelo::nitro::externalscanner::RuleAction>::canConvert(runtime, obj.getProperty(runtime, "action"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "priority"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
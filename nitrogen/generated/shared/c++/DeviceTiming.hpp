@@ -0,0 +1,91 @@
+///
+/// DeviceTiming.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (DeviceTiming).
+   */
+  struct DeviceTiming {
+  public:
+    double deviceId     SWIFT_PRIVATE;
+    double timeoutMs     SWIFT_PRIVATE;
+    double sampleCount     SWIFT_PRIVATE;
+    double p50IntervalMs     SWIFT_PRIVATE;
+    double p99IntervalMs     SWIFT_PRIVATE;
+
+  public:
+    DeviceTiming() = default;
+    explicit DeviceTiming(double deviceId, double timeoutMs, double sampleCount, double p50IntervalMs, double p99IntervalMs): deviceId(deviceId), timeoutMs(timeoutMs), sampleCount(sampleCount), p50IntervalMs(p50IntervalMs), p99IntervalMs(p99IntervalMs) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ DeviceTiming <> JS DeviceTiming (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::DeviceTiming> final {
+    static inline margelo::nitro::externalscanner::DeviceTiming fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::DeviceTiming(
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "deviceId")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "timeoutMs")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "sampleCount")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "p50IntervalMs")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "p99IntervalMs"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::DeviceTiming& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "deviceId", JSIConverter<double>::toJSI(runtime, arg.deviceId));
+      obj.setProperty(runtime, "timeoutMs", JSIConverter<double>::toJSI(runtime, arg.timeoutMs));
+      obj.setProperty(runtime, "sampleCount", JSIConverter<double>::toJSI(runtime, arg.sampleCount));
+      obj.setProperty(runtime, "p50IntervalMs", JSIConverter<double>::toJSI(runtime, arg.p50IntervalMs));
+      obj.setProperty(runtime, "p99IntervalMs", JSIConverter<double>::toJSI(runtime, arg.p99IntervalMs));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "deviceId"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "timeoutMs"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "sampleCount"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "p50IntervalMs"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "p99IntervalMs"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
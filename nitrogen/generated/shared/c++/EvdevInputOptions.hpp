@@ -0,0 +1,88 @@
+///
+/// EvdevInputOptions.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (EvdevInputOptions).
+   */
+  struct EvdevInputOptions {
+  public:
+    std::optional<double> vendorId     SWIFT_PRIVATE;
+    std::optional<double> productId     SWIFT_PRIVATE;
+    std::optional<bool> grab     SWIFT_PRIVATE;
+    std::optional<std::string> directory     SWIFT_PRIVATE;
+
+  public:
+    EvdevInputOptions() = default;
+    explicit EvdevInputOptions(std::optional<double> vendorId, std::optional<double> productId, std::optional<bool> grab, std::optional<std::string> directory): vendorId(vendorId), productId(productId), grab(grab), directory(directory) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ EvdevInputOptions <> JS EvdevInputOptions (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::EvdevInputOptions> final {
+    static inline margelo::nitro::externalscanner::EvdevInputOptions fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::EvdevInputOptions(
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "vendorId")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "productId")),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "grab")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "directory"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::EvdevInputOptions& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "vendorId", JSIConverter<std::optional<double>>::toJSI(runtime, arg.vendorId));
+      obj.setProperty(runtime, "productId", JSIConverter<std::optional<double>>::toJSI(runtime, arg.productId));
+      obj.setProperty(runtime, "grab", JSIConverter<std::optional<bool>>::toJSI(runtime, arg.grab));
+      obj.setProperty(runtime, "directory", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.directory));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "vendorId"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "productId"))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, "grab"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "directory"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,80 @@
+///
+/// FsyncPolicy.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/NitroHash.hpp>)
+#include <NitroModules/NitroHash.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * An enum which can be represented as a JavaScript union (FsyncPolicy).
+   */
+  enum class FsyncPolicy {
+    NEVER      SWIFT_NAME(never) = 0,
+    INTERVAL      SWIFT_NAME(interval) = 1,
+    ALWAYS      SWIFT_NAME(always) = 2,
+  } CLOSED_ENUM;
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ FsyncPolicy <> JS FsyncPolicy (union)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::FsyncPolicy> final {
+    static inline margelo::nitro::externalscanner::FsyncPolicy fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, arg);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("never"): return margelo::nitro::externalscanner::FsyncPolicy::NEVER;
+        case hashString("interval"): return margelo::nitro::externalscanner::FsyncPolicy::INTERVAL;
+        case hashString("always"): return margelo::nitro::externalscanner::FsyncPolicy::ALWAYS;
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert \"" + unionValue + "\" to enum FsyncPolicy - invalid value!");
+      }
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, margelo::nitro::externalscanner::FsyncPolicy arg) {
+      switch (arg) {
+        case margelo::nitro::externalscanner::FsyncPolicy::NEVER: return JSIConverter<std::string>::toJSI(runtime, "never");
+        case margelo::nitro::externalscanner::FsyncPolicy::INTERVAL: return JSIConverter<std::string>::toJSI(runtime, "interval");
+        case margelo::nitro::externalscanner::FsyncPolicy::ALWAYS: return JSIConverter<std::string>::toJSI(runtime, "always");
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert FsyncPolicy to JS - invalid value: "
+                                    + std::to_string(static_cast<int>(arg)) + "!");
+      }
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isString()) {
+        return false;
+      }
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, value);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("never"):
+        case hashString("interval"):
+        case hashString("always"):
+          return true;
+        default:
+          return false;
+      }
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,88 @@
+///
+/// Gs1Element.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <string>
+#include <optional>
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (Gs1Element).
+   */
+  struct Gs1Element {
+  public:
+    std::string ai     SWIFT_PRIVATE;
+    std::string value     SWIFT_PRIVATE;
+    std::optional<double> numericValue     SWIFT_PRIVATE;
+    std::optional<std::string> date     SWIFT_PRIVATE;
+
+  public:
+    Gs1Element() = default;
+    explicit Gs1Element(std::string ai, std::string value, std::optional<double> numericValue, std::optional<std::string> date): ai(ai), value(value), numericValue(numericValue), date(date) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ Gs1Element <> JS Gs1Element (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::Gs1Element> final {
+    static inline margelo::nitro::externalscanner::Gs1Element fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::Gs1Element(
+        JSIConverter<std::string>::fromJSI(runtime, obj.getProperty(runtime, "ai")),
+        JSIConverter<std::string>::fromJSI(runtime, obj.getProperty(runtime, "value")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "numericValue")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "date"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::Gs1Element& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "ai", JSIConverter<std::string>::toJSI(runtime, arg.ai));
+      obj.setProperty(runtime, "value", JSIConverter<std::string>::toJSI(runtime, arg.value));
+      obj.setProperty(runtime, "numericValue", JSIConverter<std::optional<double>>::toJSI(runtime, arg.numericValue));
+      obj.setProperty(runtime, "date", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.date));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<std::string>::canConvert(runtime, obj.getProperty(runtime, "ai"))) return false;
+      if (!JSIConverter<std::string>::canConvert(runtime, obj.getProperty(runtime, "value"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "numericValue"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "date"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -18,10 +18,41 @@ namespace margelo::nitro::externalscanner {
       prototype.registerHybridMethod("getConnectedDevices", &HybridExternalScannerSpec::getConnectedDevices);
       prototype.registerHybridMethod("onScannerConnectionChanged", &HybridExternalScannerSpec::onScannerConnectionChanged);
       prototype.registerHybridMethod("startScanning", &HybridExternalScannerSpec::startScanning);
+      prototype.registerHybridMethod("startScanningBatched", &HybridExternalScannerSpec::startScanningBatched);
       prototype.registerHybridMethod("stopScanning", &HybridExternalScannerSpec::stopScanning);
       prototype.registerHybridMethod("isScanning", &HybridExternalScannerSpec::isScanning);
       prototype.registerHybridMethod("setScanTimeout", &HybridExternalScannerSpec::setScanTimeout);
       prototype.registerHybridMethod("setMinScanLength", &HybridExternalScannerSpec::setMinScanLength);
+      prototype.registerHybridMethod("setThreadedProcessing", &HybridExternalScannerSpec::setThreadedProcessing);
+      prototype.registerHybridMethod("setTraceEnabled", &HybridExternalScannerSpec::setTraceEnabled);
+      prototype.registerHybridMethod("dumpTrace", &HybridExternalScannerSpec::dumpTrace);
+      prototype.registerHybridMethod("setAdaptiveTimeout", &HybridExternalScannerSpec::setAdaptiveTimeout);
+      prototype.registerHybridMethod("getLearnedTimeouts", &HybridExternalScannerSpec::getLearnedTimeouts);
+      prototype.registerHybridMethod("setGs1Parsing", &HybridExternalScannerSpec::setGs1Parsing);
+      prototype.registerHybridMethod("setValidationPolicy", &HybridExternalScannerSpec::setValidationPolicy);
+      prototype.registerHybridMethod("setDuplicateFilter", &HybridExternalScannerSpec::setDuplicateFilter);
+      prototype.registerHybridMethod("getSuppressedDuplicateCount", &HybridExternalScannerSpec::getSuppressedDuplicateCount);
+      prototype.registerHybridMethod("loadCatalog", &HybridExternalScannerSpec::loadCatalog);
+      prototype.registerHybridMethod("unloadCatalog", &HybridExternalScannerSpec::unloadCatalog);
+      prototype.registerHybridMethod("lookupCatalog", &HybridExternalScannerSpec::lookupCatalog);
+      prototype.registerHybridMethod("setScanRoutes", &HybridExternalScannerSpec::setScanRoutes);
+      prototype.registerHybridMethod("openJournal", &HybridExternalScannerSpec::openJournal);
+      prototype.registerHybridMethod("closeJournal", &HybridExternalScannerSpec::closeJournal);
+      prototype.registerHybridMethod("readJournal", &HybridExternalScannerSpec::readJournal);
+      prototype.registerHybridMethod("acknowledgeScans", &HybridExternalScannerSpec::acknowledgeScans);
+      prototype.registerHybridMethod("getStats", &HybridExternalScannerSpec::getStats);
+      prototype.registerHybridMethod("resetStats", &HybridExternalScannerSpec::resetStats);
+      prototype.registerHybridMethod("startKeyTrace", &HybridExternalScannerSpec::startKeyTrace);
+      prototype.registerHybridMethod("stopKeyTrace", &HybridExternalScannerSpec::stopKeyTrace);
+      prototype.registerHybridMethod("setMaxScanLength", &HybridExternalScannerSpec::setMaxScanLength);
+      prototype.registerHybridMethod("getDeviceGeneration", &HybridExternalScannerSpec::getDeviceGeneration);
+      prototype.registerHybridMethod("setDeviceRules", &HybridExternalScannerSpec::setDeviceRules);
+      prototype.registerHybridMethod("setKeyboardLayout", &HybridExternalScannerSpec::setKeyboardLayout);
+      prototype.registerHybridMethod("startEvdevInput", &HybridExternalScannerSpec::startEvdevInput);
+      prototype.registerHybridMethod("stopEvdevInput", &HybridExternalScannerSpec::stopEvdevInput);
+      prototype.registerHybridMethod("openSerialInput", &HybridExternalScannerSpec::openSerialInput);
+      prototype.registerHybridMethod("closeSerialInput", &HybridExternalScannerSpec::closeSerialInput);
+      prototype.registerHybridMethod("setScanFormat", &HybridExternalScannerSpec::setScanFormat);
     });
   }
 
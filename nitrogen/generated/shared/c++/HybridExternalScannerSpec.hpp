@@ -17,6 +17,34 @@
 namespace margelo::nitro::externalscanner { struct DeviceInfo; }
 // Forward declaration of `ScanResult` to properly resolve imports.
 namespace margelo::nitro::externalscanner { struct ScanResult; }
+// Forward declaration of `DeviceTiming` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct DeviceTiming; }
+// Forward declaration of `ValidationPolicy` to properly resolve imports.
+namespace margelo::nitro::externalscanner { enum class ValidationPolicy; }
+// Forward declaration of `DedupScope` to properly resolve imports.
+namespace margelo::nitro::externalscanner { enum class DedupScope; }
+// Forward declaration of `ScanRoute` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct ScanRoute; }
+// Forward declaration of `FsyncPolicy` to properly resolve imports.
+namespace margelo::nitro::externalscanner { enum class FsyncPolicy; }
+// Forward declaration of `StageLatency` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct StageLatency; }
+// Forward declaration of `ScannerStats` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct ScannerStats; }
+// Forward declaration of `ScanOverflowPolicy` to properly resolve imports.
+namespace margelo::nitro::externalscanner { enum class ScanOverflowPolicy; }
+// Forward declaration of `RuleAction` to properly resolve imports.
+namespace margelo::nitro::externalscanner { enum class RuleAction; }
+// Forward declaration of `DeviceRule` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct DeviceRule; }
+// Forward declaration of `KeyboardLayout` to properly resolve imports.
+namespace margelo::nitro::externalscanner { enum class KeyboardLayout; }
+// Forward declaration of `EvdevInputOptions` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct EvdevInputOptions; }
+// Forward declaration of `SerialFraming` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct SerialFraming; }
+// Forward declaration of `ScanFormat` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct ScanFormat; }
 
 #include "DeviceInfo.hpp"
 #include <vector>
@@ -24,6 +52,20 @@ namespace margelo::nitro::externalscanner { struct ScanResult; }
 #include "ScanResult.hpp"
 #include <string>
 #include <optional>
+#include "DeviceTiming.hpp"
+#include "ValidationPolicy.hpp"
+#include "DedupScope.hpp"
+#include "ScanRoute.hpp"
+#include "FsyncPolicy.hpp"
+#include "StageLatency.hpp"
+#include "ScannerStats.hpp"
+#include "ScanOverflowPolicy.hpp"
+#include "RuleAction.hpp"
+#include "DeviceRule.hpp"
+#include "KeyboardLayout.hpp"
+#include "EvdevInputOptions.hpp"
+#include "SerialFraming.hpp"
+#include "ScanFormat.hpp"
 
 namespace margelo::nitro::externalscanner {
 
@@ -60,10 +102,41 @@ namespace margelo::nitro::externalscanner {
       virtual std::vector<DeviceInfo> getConnectedDevices() = 0;
       virtual void onScannerConnectionChanged(const std::function<void(bool /* isConnected */)>& callback) = 0;
       virtual void startScanning(const std::function<void(const ScanResult& /* result */)>& onScan, const std::optional<std::function<void(const std::string& /* char */, double /* keyCode */)>>& onChar) = 0;
+      virtual void startScanningBatched(const std::function<void(const std::vector<ScanResult>& /* results */)>& onScans, double maxLatencyMs) = 0;
       virtual void stopScanning() = 0;
       virtual bool isScanning() = 0;
       virtual void setScanTimeout(double timeout) = 0;
       virtual void setMinScanLength(double length) = 0;
+      virtual void setThreadedProcessing(bool enabled) = 0;
+      virtual void setTraceEnabled(bool enabled) = 0;
+      virtual std::string dumpTrace() = 0;
+      virtual void setAdaptiveTimeout(bool enabled) = 0;
+      virtual std::vector<DeviceTiming> getLearnedTimeouts() = 0;
+      virtual void setGs1Parsing(bool enabled) = 0;
+      virtual void setValidationPolicy(ValidationPolicy policy) = 0;
+      virtual void setDuplicateFilter(double windowMs, DedupScope scope) = 0;
+      virtual double getSuppressedDuplicateCount() = 0;
+      virtual bool loadCatalog(const std::string& path) = 0;
+      virtual void unloadCatalog() = 0;
+      virtual std::optional<std::string> lookupCatalog(const std::string& code) = 0;
+      virtual bool setScanRoutes(const std::vector<ScanRoute>& routes, bool dropUnmatched) = 0;
+      virtual bool openJournal(const std::string& directory, FsyncPolicy fsyncPolicy, double syncIntervalMs) = 0;
+      virtual void closeJournal() = 0;
+      virtual std::vector<ScanResult> readJournal(double afterSequence, double limit) = 0;
+      virtual void acknowledgeScans(double sequence) = 0;
+      virtual ScannerStats getStats() = 0;
+      virtual void resetStats() = 0;
+      virtual bool startKeyTrace(const std::string& path) = 0;
+      virtual void stopKeyTrace() = 0;
+      virtual void setMaxScanLength(double length, ScanOverflowPolicy overflow) = 0;
+      virtual double getDeviceGeneration() = 0;
+      virtual bool setDeviceRules(const std::vector<DeviceRule>& rules) = 0;
+      virtual void setKeyboardLayout(KeyboardLayout layout) = 0;
+      virtual double startEvdevInput(const EvdevInputOptions& options) = 0;
+      virtual void stopEvdevInput() = 0;
+      virtual double openSerialInput(const std::string& path, const SerialFraming& framing, double baudRate) = 0;
+      virtual void closeSerialInput(double deviceId) = 0;
+      virtual bool setScanFormat(const ScanFormat& format) = 0;
 
     protected:
       // Hybrid Setup
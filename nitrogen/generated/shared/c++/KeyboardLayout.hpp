@@ -0,0 +1,84 @@
+///
+/// KeyboardLayout.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/NitroHash.hpp>)
+#include <NitroModules/NitroHash.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * An enum which can be represented as a JavaScript union (KeyboardLayout).
+   */
+  enum class KeyboardLayout {
+    PLATFORM      SWIFT_NAME(platform) = 0,
+    US      SWIFT_NAME(us) = 1,
+    DE      SWIFT_NAME(de) = 2,
+    FR      SWIFT_NAME(fr) = 3,
+  } CLOSED_ENUM;
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ KeyboardLayout <> JS KeyboardLayout (union)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::KeyboardLayout> final {
+    static inline margelo::nitro::externalscanner::KeyboardLayout fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, arg);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("platform"): return margelo::nitro::externalscanner::KeyboardLayout::PLATFORM;
+        case hashString("us"): return margelo::nitro::externalscanner::KeyboardLayout::US;
+        case hashString("de"): return margelo::nitro::externalscanner::KeyboardLayout::DE;
+        case hashString("fr"): return margelo::nitro::externalscanner::KeyboardLayout::FR;
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert \"" + unionValue + "\" to enum KeyboardLayout - invalid value!");
+      }
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, margelo::nitro::externalscanner::KeyboardLayout arg) {
+      switch (arg) {
+        case margelo::nitro::externalscanner::KeyboardLayout::PLATFORM: return JSIConverter<std::string>::toJSI(runtime, "platform");
+        case margelo::nitro::externalscanner::KeyboardLayout::US: return JSIConverter<std::string>::toJSI(runtime, "us");
+        case margelo::nitro::externalscanner::KeyboardLayout::DE: return JSIConverter<std::string>::toJSI(runtime, "de");
+        case margelo::nitro::externalscanner::KeyboardLayout::FR: return JSIConverter<std::string>::toJSI(runtime, "fr");
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert KeyboardLayout to JS - invalid value: "
+                                    + std::to_string(static_cast<int>(arg)) + "!");
+      }
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isString()) {
+        return false;
+      }
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, value);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("platform"):
+        case hashString("us"):
+        case hashString("de"):
+        case hashString("fr"):
+          return true;
+        default:
+          return false;
+      }
+    }
+  };
+
+} // namespace margelo::nitro
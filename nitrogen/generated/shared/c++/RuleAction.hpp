@@ -0,0 +1,76 @@
+///
+/// RuleAction.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/NitroHash.hpp>)
+#include <NitroModules/NitroHash.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * An enum which can be represented as a JavaScript union (RuleAction).
+   */
+  enum class RuleAction {
+    ACCEPT      SWIFT_NAME(accept) = 0,
+    REJECT      SWIFT_NAME(reject) = 1,
+  } CLOSED_ENUM;
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ RuleAction <> JS RuleAction (union)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::RuleAction> final {
+    static inline margelo::nitro::externalscanner::RuleAction fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, arg);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("accept"): return margelo::nitro::externalscanner::RuleAction::ACCEPT;
+        case hashString("reject"): return margelo::nitro::externalscanner::RuleAction::REJECT;
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert \"" + unionValue + "\" to enum RuleAction - invalid value!");
+      }
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, margelo::nitro::externalscanner::RuleAction arg) {
+      switch (arg) {
+        case margelo::nitro::externalscanner::RuleAction::ACCEPT: return JSIConverter<std::string>::toJSI(runtime, "accept");
+        case margelo::nitro::externalscanner::RuleAction::REJECT: return JSIConverter<std::string>::toJSI(runtime, "reject");
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert RuleAction to JS - invalid value: "
+                                    + std::to_string(static_cast<int>(arg)) + "!");
+      }
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isString()) {
+        return false;
+      }
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, value);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("accept"):
+        case hashString("reject"):
+          return true;
+        default:
+          return false;
+      }
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,88 @@
+///
+/// ScanFormat.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <string>
+#include <optional>
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (ScanFormat).
+   */
+  struct ScanFormat {
+  public:
+    std::optional<std::string> prefix     SWIFT_PRIVATE;
+    std::optional<std::string> suffix     SWIFT_PRIVATE;
+    std::optional<bool> aimIdentifiers     SWIFT_PRIVATE;
+    std::optional<std::string> separators     SWIFT_PRIVATE;
+
+  public:
+    ScanFormat() = default;
+    explicit ScanFormat(std::optional<std::string> prefix, std::optional<std::string> suffix, std::optional<bool> aimIdentifiers, std::optional<std::string> separators): prefix(prefix), suffix(suffix), aimIdentifiers(aimIdentifiers), separators(separators) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ ScanFormat <> JS ScanFormat (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::ScanFormat> final {
+    static inline margelo::nitro::externalscanner::ScanFormat fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::ScanFormat(
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "prefix")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "suffix")),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "aimIdentifiers")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "separators"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::ScanFormat& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "prefix", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.prefix));
+      obj.setProperty(runtime, "suffix", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.suffix));
+      obj.setProperty(runtime, "aimIdentifiers", JSIConverter<std::optional<bool>>::toJSI(runtime, arg.aimIdentifiers));
+      obj.setProperty(runtime, "separators", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.separators));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "prefix"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "suffix"))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, "aimIdentifiers"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "separators"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
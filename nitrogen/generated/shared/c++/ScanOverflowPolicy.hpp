@@ -0,0 +1,80 @@
+///
+/// ScanOverflowPolicy.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/NitroHash.hpp>)
+#include <NitroModules/NitroHash.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * An enum which can be represented as a JavaScript union (ScanOverflowPolicy).
+   */
+  enum class ScanOverflowPolicy {
+    TRUNCATE      SWIFT_NAME(truncate) = 0,
+    SPLIT      SWIFT_NAME(split) = 1,
+    DISCARD      SWIFT_NAME(discard) = 2,
+  } CLOSED_ENUM;
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ ScanOverflowPolicy <> JS ScanOverflowPolicy (union)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::ScanOverflowPolicy> final {
+    static inline margelo::nitro::externalscanner::ScanOverflowPolicy fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, arg);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("truncate"): return margelo::nitro::externalscanner::ScanOverflowPolicy::TRUNCATE;
+        case hashString("split"): return margelo::nitro::externalscanner::ScanOverflowPolicy::SPLIT;
+        case hashString("discard"): return margelo::nitro::externalscanner::ScanOverflowPolicy::DISCARD;
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert \"" + unionValue + "\" to enum ScanOverflowPolicy - invalid value!");
+      }
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, margelo::nitro::externalscanner::ScanOverflowPolicy arg) {
+      switch (arg) {
+        case margelo::nitro::externalscanner::ScanOverflowPolicy::TRUNCATE: return JSIConverter<std::string>::toJSI(runtime, "truncate");
+        case margelo::nitro::externalscanner::ScanOverflowPolicy::SPLIT: return JSIConverter<std::string>::toJSI(runtime, "split");
+        case margelo::nitro::externalscanner::ScanOverflowPolicy::DISCARD: return JSIConverter<std::string>::toJSI(runtime, "discard");
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert ScanOverflowPolicy to JS - invalid value: "
+                                    + std::to_string(static_cast<int>(arg)) + "!");
+      }
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isString()) {
+        return false;
+      }
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, value);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("truncate"):
+        case hashString("split"):
+        case hashString("discard"):
+          return true;
+        default:
+          return false;
+      }
+    }
+  };
+
+} // namespace margelo::nitro
@@ -23,9 +23,13 @@
 #error NitroModules cannot be found! Are you sure you installed NitroModules properly?
 #endif
 
-
+// Forward declaration of `Gs1Element` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct Gs1Element; }
 
 #include <string>
+#include "Gs1Element.hpp"
+#include <vector>
+#include <optional>
 
 namespace margelo::nitro::externalscanner {
 
@@ -36,10 +40,18 @@ namespace margelo::nitro::externalscanner {
   public:
     std::string code     SWIFT_PRIVATE;
     double timestamp     SWIFT_PRIVATE;
+    double deviceId     SWIFT_PRIVATE;
+    std::optional<std::vector<Gs1Element>> elements     SWIFT_PRIVATE;
+    std::optional<bool> valid     SWIFT_PRIVATE;
+    std::optional<std::string> symbologyGuess     SWIFT_PRIVATE;
+    std::optional<std::string> symbology     SWIFT_PRIVATE;
+    std::optional<std::string> catalogRecord     SWIFT_PRIVATE;
+    std::optional<std::string> route     SWIFT_PRIVATE;
+    std::optional<double> sequence     SWIFT_PRIVATE;
 
   public:
     ScanResult() = default;
-    explicit ScanResult(std::string code, double timestamp): code(code), timestamp(timestamp) {}
+    explicit ScanResult(std::string code, double timestamp, double deviceId, std::optional<std::vector<Gs1Element>> elements, std::optional<bool> valid, std::optional<std::string> symbologyGuess, std::optional<std::string> symbology, std::optional<std::string> catalogRecord, std::optional<std::string> route, std::optional<double> sequence): code(code), timestamp(timestamp), deviceId(deviceId), elements(elements), valid(valid), symbologyGuess(symbologyGuess), symbology(symbology), catalogRecord(catalogRecord), route(route), sequence(sequence) {}
   };
 
 } // namespace margelo::nitro::externalscanner
@@ -53,13 +65,29 @@ namespace margelo::nitro {
       jsi::Object obj = arg.asObject(runtime);
       return margelo::nitro::externalscanner::ScanResult(
         JSIConverter<std::string>::fromJSI(runtime, obj.getProperty(runtime, "code")),
-        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "timestamp"))
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "timestamp")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "deviceId")),
+        JSIConverter<std::optional<std::vector<margelo::nitro::externalscanner::Gs1Element>>>::fromJSI(runtime, obj.getProperty(runtime, "elements")),
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "valid")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "symbologyGuess")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "symbology")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "catalogRecord")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "route")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "sequence"))
       );
     }
     static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::ScanResult& arg) {
       jsi::Object obj(runtime);
       obj.setProperty(runtime, "code", JSIConverter<std::string>::toJSI(runtime, arg.code));
       obj.setProperty(runtime, "timestamp", JSIConverter<double>::toJSI(runtime, arg.timestamp));
+      obj.setProperty(runtime, "deviceId", JSIConverter<double>::toJSI(runtime, arg.deviceId));
+      obj.setProperty(runtime, "elements", JSIConverter<std::optional<std::vector<margelo::nitro::externalscanner::Gs1Element>>>::toJSI(runtime, arg.elements));
+      obj.setProperty(runtime, "valid", JSIConverter<std::optional<bool>>::toJSI(runtime, arg.valid));
+      obj.setProperty(runtime, "symbologyGuess", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.symbologyGuess));
+      obj.setProperty(runtime, "symbology", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.symbology));
+      obj.setProperty(runtime, "catalogRecord", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.catalogRecord));
+      obj.setProperty(runtime, "route", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.route));
+      obj.setProperty(runtime, "sequence", JSIConverter<std::optional<double>>::toJSI(runtime, arg.sequence));
       return obj;
     }
     static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
@@ -72,6 +100,14 @@ namespace margelo::nitro {
       }
       if (!JSIConverter<std::string>::canConvert(runtime, obj.getProperty(runtime, "code"))) return false;
       if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "timestamp"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "deviceId"))) return false;
+      if (!JSIConverter<std::optional<std::vector<margelo::nitro::externalscanner::Gs1Element>>>::canConvert(runtime, obj.getProperty(runtime, "elements"))) return false;
+      if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, "valid"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "symbologyGuess"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "symbology"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "catalogRecord"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "route"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "sequence"))) return false;
       return true;
     }
   };
@@ -0,0 +1,92 @@
+///
+/// ScanRoute.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <string>
+#include <optional>
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (ScanRoute).
+   */
+  struct ScanRoute {
+  public:
+    std::string id     SWIFT_PRIVATE;
+    std::optional<std::string> prefix     SWIFT_PRIVATE;
+    std::optional<std::string> pattern     SWIFT_PRIVATE;
+    std::optional<double> minLength     SWIFT_PRIVATE;
+    std::optional<double> maxLength     SWIFT_PRIVATE;
+
+  public:
+    ScanRoute() = default;
+    explicit ScanRoute(std::string id, std::optional<std::string> prefix, std::optional<std::string> pattern, std::optional<double> minLength, std::optional<double> maxLength): id(id), prefix(prefix), pattern(pattern), minLength(minLength), maxLength(maxLength) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ ScanRoute <> JS ScanRoute (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::ScanRoute> final {
+    static inline margelo::nitro::externalscanner::ScanRoute fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::ScanRoute(
+        JSIConverter<std::string>::fromJSI(runtime, obj.getProperty(runtime, "id")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "prefix")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "pattern")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "minLength")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "maxLength"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::ScanRoute& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "id", JSIConverter<std::string>::toJSI(runtime, arg.id));
+      obj.setProperty(runtime, "prefix", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.prefix));
+      obj.setProperty(runtime, "pattern", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.pattern));
+      obj.setProperty(runtime, "minLength", JSIConverter<std::optional<double>>::toJSI(runtime, arg.minLength));
+      obj.setProperty(runtime, "maxLength", JSIConverter<std::optional<double>>::toJSI(runtime, arg.maxLength));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<std::string>::canConvert(runtime, obj.getProperty(runtime, "id"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "prefix"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "pattern"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "minLength"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "maxLength"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,128 @@
+///
+/// ScannerStats.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+// Forward declaration of `StageLatency` to properly resolve imports.
+namespace margelo::nitro::externalscanner { struct StageLatency; }
+
+#include "StageLatency.hpp"
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (ScannerStats).
+   */
+  struct ScannerStats {
+  public:
+    double keysReceived     SWIFT_PRIVATE;
+    double keysIgnored     SWIFT_PRIVATE;
+    double keysDropped     SWIFT_PRIVATE;
+    double scansEmitted     SWIFT_PRIVATE;
+    double scansTooShort     SWIFT_PRIVATE;
+    double scansTimedOut     SWIFT_PRIVATE;
+    double scansInvalid     SWIFT_PRIVATE;
+    double scansDuplicate     SWIFT_PRIVATE;
+    double scansUnrouted     SWIFT_PRIVATE;
+    double scansOverflowed     SWIFT_PRIVATE;
+    StageLatency keyIngest     SWIFT_PRIVATE;
+    StageLatency assembly     SWIFT_PRIVATE;
+    StageLatency dispatch     SWIFT_PRIVATE;
+    StageLatency callback     SWIFT_PRIVATE;
+
+  public:
+    ScannerStats() = default;
+    explicit ScannerStats(double keysReceived, double keysIgnored, double keysDropped, double scansEmitted, double scansTooShort, double scansTimedOut, double scansInvalid, double scansDuplicate, double scansUnrouted, double scansOverflowed, StageLatency keyIngest, StageLatency assembly, StageLatency dispatch, StageLatency callback): keysReceived(keysReceived), keysIgnored(keysIgnored), keysDropped(keysDropped), scansEmitted(scansEmitted), scansTooShort(scansTooShort), scansTimedOut(scansTimedOut), scansInvalid(scansInvalid), scansDuplicate(scansDuplicate), scansUnrouted(scansUnrouted), scansOverflowed(scansOverflowed), keyIngest(keyIngest), assembly(assembly), dispatch(dispatch), callback(callback) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ ScannerStats <> JS ScannerStats (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::ScannerStats> final {
+    static inline margelo::nitro::externalscanner::ScannerStats fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::ScannerStats(
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "keysReceived")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "keysIgnored")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "keysDropped")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "scansEmitted")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "scansTooShort")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "scansTimedOut")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "scansInvalid")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "scansDuplicate")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "scansUnrouted")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "scansOverflowed")),
+        JSIConverter<margelo::nitro::externalscanner::StageLatency>::fromJSI(runtime, obj.getProperty(runtime, "keyIngest")),
+        JSIConverter<margelo::nitro::externalscanner::StageLatency>::fromJSI(runtime, obj.getProperty(runtime, "assembly")),
+        JSIConverter<margelo::nitro::externalscanner::StageLatency>::fromJSI(runtime, obj.getProperty(runtime, "dispatch")),
+        JSIConverter<margelo::nitro::externalscanner::StageLatency>::fromJSI(runtime, obj.getProperty(runtime, "callback"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::ScannerStats& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "keysReceived", JSIConverter<double>::toJSI(runtime, arg.keysReceived));
+      obj.setProperty(runtime, "keysIgnored", JSIConverter<double>::toJSI(runtime, arg.keysIgnored));
+      obj.setProperty(runtime, "keysDropped", JSIConverter<double>::toJSI(runtime, arg.keysDropped));
+      obj.setProperty(runtime, "scansEmitted", JSIConverter<double>::toJSI(runtime, arg.scansEmitted));
+      obj.setProperty(runtime, "scansTooShort", JSIConverter<double>::toJSI(runtime, arg.scansTooShort));
+      obj.setProperty(runtime, "scansTimedOut", JSIConverter<double>::toJSI(runtime, arg.scansTimedOut));
+      obj.setProperty(runtime, "scansInvalid", JSIConverter<double>::toJSI(runtime, arg.scansInvalid));
+      obj.setProperty(runtime, "scansDuplicate", JSIConverter<double>::toJSI(runtime, arg.scansDuplicate));
+      obj.setProperty(runtime, "scansUnrouted", JSIConverter<double>::toJSI(runtime, arg.scansUnrouted));
+      obj.setProperty(runtime, "scansOverflowed", JSIConverter<double>::toJSI(runtime, arg.scansOverflowed));
+      obj.setProperty(runtime, "keyIngest", JSIConverter<margelo::nitro::externalscanner::StageLatency>::toJSI(runtime, arg.keyIngest));
+      obj.setProperty(runtime, "assembly", JSIConverter<margelo::nitro::externalscanner::StageLatency>::toJSI(runtime, arg.assembly));
+      obj.setProperty(runtime, "dispatch", JSIConverter<margelo::nitro::externalscanner::StageLatency>::toJSI(runtime, arg.dispatch));
+      obj.setProperty(runtime, "callback", JSIConverter<margelo::nitro::externalscanner::StageLatency>::toJSI(runtime, arg.callback));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "keysReceived"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "keysIgnored"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "keysDropped"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "scansEmitted"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "scansTooShort"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "scansTimedOut"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "scansInvalid"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "scansDuplicate"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "scansUnrouted"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "scansOverflowed"))) return false;
+      if (!JSIConverter<margelo::nitro::externalscanner::StageLatency>::canConvert(runtime, obj.getProperty(runtime, "keyIngest"))) return false;
+      if (!JSIConverter<margelo::nitro::externalscanner::StageLatency>::canConvert(runtime, obj.getProperty(runtime, "assembly"))) return false;
+      if (!JSIConverter<margelo::nitro::externalscanner::StageLatency>::canConvert(runtime, obj.getProperty(runtime, "dispatch"))) return false;
+      if (!JSIConverter<margelo::nitro::externalscanner::StageLatency>::canConvert(runtime, obj.getProperty(runtime, "callback"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,88 @@
+///
+/// SerialFraming.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <string>
+#include <optional>
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (SerialFraming).
+   */
+  struct SerialFraming {
+  public:
+    std::optional<std::string> terminators     SWIFT_PRIVATE;
+    std::optional<std::string> prefix     SWIFT_PRIVATE;
+    std::optional<std::string> suffix     SWIFT_PRIVATE;
+    std::optional<double> lengthHeaderBytes     SWIFT_PRIVATE;
+
+  public:
+    SerialFraming() = default;
+    explicit SerialFraming(std::optional<std::string> terminators, std::optional<std::string> prefix, std::optional<std::string> suffix, std::optional<double> lengthHeaderBytes): terminators(terminators), prefix(prefix), suffix(suffix), lengthHeaderBytes(lengthHeaderBytes) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ SerialFraming <> JS SerialFraming (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::SerialFraming> final {
+    static inline margelo::nitro::externalscanner::SerialFraming fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::SerialFraming(
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "terminators")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "prefix")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "suffix")),
+        JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "lengthHeaderBytes"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::SerialFraming& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "terminators", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.terminators));
+      obj.setProperty(runtime, "prefix", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.prefix));
+      obj.setProperty(runtime, "suffix", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.suffix));
+      obj.setProperty(runtime, "lengthHeaderBytes", JSIConverter<std::optional<double>>::toJSI(runtime, arg.lengthHeaderBytes));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "terminators"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "prefix"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "suffix"))) return false;
+      if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "lengthHeaderBytes"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,99 @@
+///
+/// StageLatency.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIHelpers.hpp>)
+#include <NitroModules/JSIHelpers.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * A struct which can be represented as a JavaScript object (StageLatency).
+   */
+  struct StageLatency {
+  public:
+    double count     SWIFT_PRIVATE;
+    double meanUs     SWIFT_PRIVATE;
+    double p50Us     SWIFT_PRIVATE;
+    double p90Us     SWIFT_PRIVATE;
+    double p99Us     SWIFT_PRIVATE;
+    double p999Us     SWIFT_PRIVATE;
+    double maxUs     SWIFT_PRIVATE;
+
+  public:
+    StageLatency() = default;
+    explicit StageLatency(double count, double meanUs, double p50Us, double p90Us, double p99Us, double p999Us, double maxUs): count(count), meanUs(meanUs), p50Us(p50Us), p90Us(p90Us), p99Us(p99Us), p999Us(p999Us), maxUs(maxUs) {}
+  };
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ StageLatency <> JS StageLatency (object)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::StageLatency> final {
+    static inline margelo::nitro::externalscanner::StageLatency fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::externalscanner::StageLatency(
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "count")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "meanUs")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "p50Us")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "p90Us")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "p99Us")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "p999Us")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "maxUs"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::externalscanner::StageLatency& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "count", JSIConverter<double>::toJSI(runtime, arg.count));
+      obj.setProperty(runtime, "meanUs", JSIConverter<double>::toJSI(runtime, arg.meanUs));
+      obj.setProperty(runtime, "p50Us", JSIConverter<double>::toJSI(runtime, arg.p50Us));
+      obj.setProperty(runtime, "p90Us", JSIConverter<double>::toJSI(runtime, arg.p90Us));
+      obj.setProperty(runtime, "p99Us", JSIConverter<double>::toJSI(runtime, arg.p99Us));
+      obj.setProperty(runtime, "p999Us", JSIConverter<double>::toJSI(runtime, arg.p999Us));
+      obj.setProperty(runtime, "maxUs", JSIConverter<double>::toJSI(runtime, arg.maxUs));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!nitro::isPlainObject(runtime, obj)) {
+        return false;
+      }
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "count"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "meanUs"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "p50Us"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "p90Us"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "p99Us"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "p999Us"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "maxUs"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
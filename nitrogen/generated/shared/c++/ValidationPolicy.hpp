@@ -0,0 +1,80 @@
+///
+/// ValidationPolicy.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/NitroHash.hpp>)
+#include <NitroModules/NitroHash.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+namespace margelo::nitro::externalscanner {
+
+  /**
+   * An enum which can be represented as a JavaScript union (ValidationPolicy).
+   */
+  enum class ValidationPolicy {
+    OFF      SWIFT_NAME(off) = 0,
+    ANNOTATE      SWIFT_NAME(annotate) = 1,
+    REJECT      SWIFT_NAME(reject) = 2,
+  } CLOSED_ENUM;
+
+} // namespace margelo::nitro::externalscanner
+
+namespace margelo::nitro {
+
+  // C++ ValidationPolicy <> JS ValidationPolicy (union)
+  template <>
+  struct JSIConverter<margelo::nitro::externalscanner::ValidationPolicy> final {
+    static inline margelo::nitro::externalscanner::ValidationPolicy fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, arg);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("off"): return margelo::nitro::externalscanner::ValidationPolicy::OFF;
+        case hashString("annotate"): return margelo::nitro::externalscanner::ValidationPolicy::ANNOTATE;
+        case hashString("reject"): return margelo::nitro::externalscanner::ValidationPolicy::REJECT;
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert \"" + unionValue + "\" to enum ValidationPolicy - invalid value!");
+      }
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, margelo::nitro::externalscanner::ValidationPolicy arg) {
+      switch (arg) {
+        case margelo::nitro::externalscanner::ValidationPolicy::OFF: return JSIConverter<std::string>::toJSI(runtime, "off");
+        case margelo::nitro::externalscanner::ValidationPolicy::ANNOTATE: return JSIConverter<std::string>::toJSI(runtime, "annotate");
+        case margelo::nitro::externalscanner::ValidationPolicy::REJECT: return JSIConverter<std::string>::toJSI(runtime, "reject");
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert ValidationPolicy to JS - invalid value: "
+                                    + std::to_string(static_cast<int>(arg)) + "!");
+      }
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isString()) {
+        return false;
+      }
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, value);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("off"):
+        case hashString("annotate"):
+        case hashString("reject"):
+          return true;
+        default:
+          return false;
+      }
+    }
+  };
+
+} // namespace margelo::nitro
@@ -0,0 +1,87 @@
+#!/usr/bin/env node
+/**
+ * Builds a product catalog file for loadCatalog().
+ *
+ * Usage: node scripts/build-catalog.js <input.tsv> <output.catalog>
+ *
+ * Each input line is `<code>\t<record>`; the record is stored as-is (e.g. a
+ * JSON object) and returned for scans of that code. The layout matches
+ * cpp/ProductCatalog.hpp.
+ */
+const fs = require('fs')
+
+const FNV_OFFSET = 14695981039346656037n
+const FNV_PRIME = 1099511628211n
+const MASK = (1n << 64n) - 1n
+
+function hashKey(bytes) {
+  let hash = FNV_OFFSET
+  for (const byte of bytes) {
+    hash ^= BigInt(byte)
+    hash = (hash * FNV_PRIME) & MASK
+  }
+  return hash
+}
+
+function build(inputPath, outputPath) {
+  // Later duplicates of a code replace earlier ones
+  const records = new Map()
+  for (const line of fs.readFileSync(inputPath, 'utf8').split('\n')) {
+    const tab = line.indexOf('\t')
+    if (tab <= 0) continue
+    records.set(line.slice(0, tab), line.slice(tab + 1).replace(/\r$/, ''))
+  }
+
+  const entries = []
+  const chunks = []
+  let blobSize = 0
+  for (const [code, record] of records) {
+    const key = Buffer.from(code, 'utf8')
+    const value = Buffer.from(record, 'utf8')
+    if (key.length > 0xffff) throw new Error(`Code too long: ${code}`)
+    entries.push({
+      hash: hashKey(key),
+      key,
+      keyOffset: blobSize,
+      recordOffset: blobSize + key.length,
+      recordLength: value.length,
+    })
+    chunks.push(key, value)
+    blobSize += key.length + value.length
+  }
+  if (blobSize > 0xffffffff) throw new Error('Catalog blob exceeds 4 GiB')
+  entries.sort((a, b) =>
+    a.hash !== b.hash ? (a.hash < b.hash ? -1 : 1) : Buffer.compare(a.key, b.key)
+  )
+
+  const header = Buffer.alloc(64)
+  header.write('ESCATLG1', 0, 'latin1')
+  header.writeUInt32LE(1, 8) // version
+  header.writeBigUInt64LE(BigInt(entries.length), 16)
+  header.writeBigUInt64LE(64n, 24) // index offset
+  header.writeBigUInt64LE(BigInt(64 + entries.length * 24), 32) // blob offset
+  header.writeBigUInt64LE(BigInt(blobSize), 40)
+
+  const index = Buffer.alloc(entries.length * 24)
+  entries.forEach((entry, i) => {
+    const offset = i * 24
+    index.writeBigUInt64LE(entry.hash, offset)
+    index.writeUInt32LE(entry.keyOffset, offset + 8)
+    index.writeUInt32LE(entry.recordOffset, offset + 12)
+    index.writeUInt16LE(entry.key.length, offset + 16)
+    index.writeUInt32LE(entry.recordLength, offset + 20)
+  })
+
+  const tempPath = `${outputPath}.tmp`
+  const fd = fs.openSync(tempPath, 'w')
+  for (const part of [header, index, ...chunks]) fs.writeSync(fd, part)
+  fs.closeSync(fd)
+  fs.renameSync(tempPath, outputPath)
+  console.log(`Wrote ${entries.length} entries to ${outputPath}`)
+}
+
+if (process.argv.length !== 4) {
+  console.error('Usage: build-catalog.js <input.tsv> <output.catalog>')
+  process.exit(1)
+}
+build(process.argv[2], process.argv[3])
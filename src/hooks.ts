@@ -2,7 +2,9 @@ import { useEffect, useState, useCallback, useRef } from 'react'
 import {
   hasExternalScanner,
   getConnectedDevices,
+  getDeviceGeneration,
   startScanning,
+  startScanningBatched,
   stopScanning,
   onScannerConnectionChanged,
   setScanTimeout,
@@ -17,6 +19,12 @@ export interface UseExternalScannerOptions {
   scanTimeout?: number
   /** Minimum scan length (default: 3) */
   minScanLength?: number
+  /**
+   * Deliver scans in native batches flushed at most every N ms, so bursts
+   * cause one JS call and one re-render (default: undefined = per scan).
+   * `onChar` is not called in batched mode.
+   */
+  batchLatencyMs?: number
   /** Callback when a barcode is scanned */
   onScan?: (result: ScanResult) => void
   /** Callback for each character received */
@@ -74,6 +82,7 @@ export function useExternalScanner(
     autoStart = true,
     scanTimeout = 50,
     minScanLength = 3,
+    batchLatencyMs,
     onScan,
     onChar,
     onConnectionChange,
@@ -90,7 +99,13 @@ export function useExternalScanner(
   onScanRef.current = onScan
   onCharRef.current = onChar
 
+  // Generation of the device list in `devices`; -1 forces the first refresh
+  const deviceGenerationRef = useRef(-1)
+
   const refreshDevices = useCallback(() => {
+    const generation = getDeviceGeneration()
+    if (generation !== 0 && generation === deviceGenerationRef.current) return
+    deviceGenerationRef.current = generation
     setDevices(getConnectedDevices())
     setIsConnected(hasExternalScanner())
   }, [])
@@ -104,17 +119,34 @@ export function useExternalScanner(
     onCharRef.current?.(char, keyCode)
   }, [])
 
+  const handleScans = useCallback((results: ScanResult[]) => {
+    // One state update per batch instead of one per scan
+    const last = results[results.length - 1]
+    if (last) setLastScan(last)
+    for (const result of results) {
+      onScanRef.current?.(result)
+    }
+  }, [])
+
+  const beginScanning = useCallback(() => {
+    setScanTimeout(scanTimeout)
+    setMinScanLength(minScanLength)
+    if (batchLatencyMs != null) {
+      startScanningBatched(handleScans, batchLatencyMs)
+    } else {
+      startScanning(handleScan, handleChar)
+    }
+  }, [scanTimeout, minScanLength, batchLatencyMs, handleScan, handleChar, handleScans])
+
   // Use ref to track scanning state to avoid stale closures
   const scanningRef = useRef(false)
 
   const start = useCallback(() => {
     if (scanningRef.current) return
-    setScanTimeout(scanTimeout)
-    setMinScanLength(minScanLength)
-    startScanning(handleScan, handleChar)
+    beginScanning()
     scanningRef.current = true
     setScanning(true)
-  }, [scanTimeout, minScanLength, handleScan, handleChar])
+  }, [beginScanning])
 
   const stop = useCallback(() => {
     if (!scanningRef.current) return
@@ -135,10 +167,7 @@ export function useExternalScanner(
   // Auto-start scanning
   useEffect(() => {
     if (autoStart) {
-      // Direct call to native to avoid any stale closure issues
-      setScanTimeout(scanTimeout)
-      setMinScanLength(minScanLength)
-      startScanning(handleScan, handleChar)
+      beginScanning()
       scanningRef.current = true
       setScanning(true)
     }
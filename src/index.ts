@@ -1,8 +1,46 @@
 import { NitroModules } from 'react-native-nitro-modules'
-import type { ExternalScanner, DeviceInfo, ScanResult } from './specs/ExternalScanner.nitro'
+import type {
+  ExternalScanner,
+  DedupScope,
+  DeviceInfo,
+  DeviceRule,
+  DeviceTiming,
+  EvdevInputOptions,
+  FsyncPolicy,
+  Gs1Element,
+  KeyboardLayout,
+  RuleAction,
+  ScanResult,
+  ScanFormat,
+  ScanOverflowPolicy,
+  ScanRoute,
+  ScannerStats,
+  SerialFraming,
+  StageLatency,
+  ValidationPolicy,
+} from './specs/ExternalScanner.nitro'
 
 // Export types
-export type { DeviceInfo, ScanResult, ExternalScanner }
+export type {
+  DedupScope,
+  DeviceInfo,
+  DeviceRule,
+  DeviceTiming,
+  EvdevInputOptions,
+  FsyncPolicy,
+  Gs1Element,
+  KeyboardLayout,
+  RuleAction,
+  ScanResult,
+  ScanFormat,
+  ScanOverflowPolicy,
+  ScanRoute,
+  ScannerStats,
+  SerialFraming,
+  StageLatency,
+  ValidationPolicy,
+  ExternalScanner,
+}
 
 // Get the HybridObject instance
 const ExternalScannerModule = NitroModules.createHybridObject<ExternalScanner>('ExternalScanner')
@@ -33,6 +71,21 @@ export function startScanning(
   ExternalScannerModule.startScanning(onScan, onChar)
 }
 
+/**
+ * Start listening for barcode scans, delivered in batches
+ * Completed scans are queued natively and flushed as one array every
+ * `maxLatencyMs` (or earlier once 32 scans are queued), turning N JS calls
+ * and renders into one - useful for RFID and presentation-mode scanners.
+ * @param onScans - Callback with all scans completed since the last call
+ * @param maxLatencyMs - Longest time a completed scan waits (default: 16ms)
+ */
+export function startScanningBatched(
+  onScans: (results: ScanResult[]) => void,
+  maxLatencyMs: number = 16
+): void {
+  ExternalScannerModule.startScanningBatched(onScans, maxLatencyMs)
+}
+
 /**
  * Stop listening for barcode scans
  */
@@ -70,6 +123,319 @@ export function setMinScanLength(length: number): void {
   ExternalScannerModule.setMinScanLength(length)
 }
 
+/**
+ * Enable or disable threaded scan processing
+ * When enabled (default), key events are assembled on the native input loop
+ * thread instead of the platform input thread.
+ * @param enabled - false to process keys synchronously on the input thread
+ */
+export function setThreadedProcessing(enabled: boolean): void {
+  ExternalScannerModule.setThreadedProcessing(enabled)
+}
+
+/**
+ * Enable or disable the native trace buffer
+ * Trace records are fixed-size binary entries written to a lock-free ring,
+ * cheap enough to leave on in production while chasing a field issue.
+ */
+export function setTraceEnabled(enabled: boolean): void {
+  ExternalScannerModule.setTraceEnabled(enabled)
+}
+
+/**
+ * Dump the native trace buffer as text, oldest record first
+ */
+export function dumpTrace(): string {
+  return ExternalScannerModule.dumpTrace()
+}
+
+/**
+ * Enable or disable adaptive per-device timeouts
+ * When enabled, each device's timeout becomes the 99th percentile of its
+ * inter-key gaps plus a margin (clamped to 10-300ms), so bursty Bluetooth
+ * scanners are not split and fast USB scanners complete sooner.
+ * `setScanTimeout` stays the fallback until a device has enough samples.
+ */
+export function setAdaptiveTimeout(enabled: boolean): void {
+  ExternalScannerModule.setAdaptiveTimeout(enabled)
+}
+
+/**
+ * Get the inter-key statistics and timeout learned for each device
+ */
+export function getLearnedTimeouts(): DeviceTiming[] {
+  return ExternalScannerModule.getLearnedTimeouts()
+}
+
+/**
+ * Enable or disable native GS1 parsing
+ * When enabled, scans that form a valid GS1 element string (GS1-128,
+ * GS1 DataMatrix/QR) carry an `elements` array with each Application
+ * Identifier, its value and the decoded number or date. Without a GS1 AIM
+ * identifier or leading FNC1, only data that starts with an SSCC or GTIN
+ * (AI 00, 01 or 02) with a valid check digit is taken as GS1.
+ */
+export function setGs1Parsing(enabled: boolean): void {
+  ExternalScannerModule.setGs1Parsing(enabled)
+}
+
+/**
+ * Set how scans are checked against their check digit
+ * Scans with an AIM identifier (see ScanFormat.aimIdentifiers) are checked
+ * if their symbology is EAN/UPC. Other numeric codes with the length of
+ * EAN-8/13, UPC-A/E, GTIN-14, SSCC, ISBN-10 or ISSN are validated by guess,
+ * which also matches numeric Code 39 or ITF codes of those lengths; enable
+ * AIM identifiers before using `reject` with such codes. `annotate` sets
+ * `valid` and `symbologyGuess` on each result; `reject` also drops invalid
+ * scans before they reach JS. Other codes always pass through unchanged.
+ */
+export function setValidationPolicy(policy: ValidationPolicy): void {
+  ExternalScannerModule.setValidationPolicy(policy)
+}
+
+/**
+ * Suppress duplicate scans natively
+ * A code read again less than `windowMs` after its previous read is dropped
+ * before it reaches JS (the window restarts on every read, so a code held in
+ * front of a presentation scanner is reported once). Pass 0 to disable.
+ * @param scope 'device' (default) matches per scanner, 'global' across all
+ */
+export function setDuplicateFilter(windowMs: number, scope: DedupScope = 'device'): void {
+  ExternalScannerModule.setDuplicateFilter(windowMs, scope)
+}
+
+/**
+ * Get the number of duplicate scans suppressed so far
+ */
+export function getSuppressedDuplicateCount(): number {
+  return ExternalScannerModule.getSuppressedDuplicateCount()
+}
+
+/**
+ * Load a product catalog built with `scripts/build-catalog.js`
+ * The file is memory-mapped read-only, so loading is instant regardless of
+ * size. While loaded, scans found in it carry their record as
+ * `catalogRecord`. Loading another catalog replaces the current one.
+ * @returns false if the file is missing or not a valid catalog
+ */
+export function loadCatalog(path: string): boolean {
+  return ExternalScannerModule.loadCatalog(path)
+}
+
+/**
+ * Unload the product catalog
+ */
+export function unloadCatalog(): void {
+  ExternalScannerModule.unloadCatalog()
+}
+
+/**
+ * Look up a code in the loaded product catalog
+ * @returns The stored record, or undefined if the code (or a catalog) is missing
+ */
+export function lookupCatalog(code: string): string | undefined {
+  return ExternalScannerModule.lookupCatalog(code)
+}
+
+/**
+ * Route scans by shape natively
+ * The rules are compiled into a single state machine, so each scan is matched
+ * in one pass over its characters. Matching scans carry the rule id as
+ * `route`; the first matching rule wins.
+ * @param dropUnmatched Drop scans that match no rule before they reach JS
+ * @returns false if a pattern is invalid (the previous rules stay active)
+ */
+export function setScanRoutes(routes: ScanRoute[], dropUnmatched = false): boolean {
+  return ExternalScannerModule.setScanRoutes(routes, dropUnmatched)
+}
+
+/**
+ * Build an onScan callback that dispatches on `result.route`
+ * @example
+ * startScanning(routeScans({ location: openLocation, tote: openTote }))
+ */
+export function routeScans(
+  handlers: Record<string, (result: ScanResult) => void>,
+  fallback?: (result: ScanResult) => void
+): (result: ScanResult) => void {
+  return (result) => {
+    const handler = result.route != null ? handlers[result.route] : undefined
+    if (handler) {
+      handler(result)
+    } else {
+      fallback?.(result)
+    }
+  }
+}
+
+/**
+ * Open the crash-safe scan journal
+ * Every scan is appended to a memory-mapped log in `directory` before it is
+ * dispatched and carries its `sequence`, so scans not yet persisted by JS
+ * survive a reload or the app being killed. After a restart, replay them with
+ * `readJournal()` and call `acknowledgeScans()` once they are stored.
+ * @param fsyncPolicy When appended scans are flushed to storage (default: 'interval')
+ * @param syncIntervalMs Group-commit interval for 'interval' (default: 100ms)
+ * @returns false if the directory cannot be created or holds a broken journal
+ */
+export function openJournal(
+  directory: string,
+  fsyncPolicy: FsyncPolicy = 'interval',
+  syncIntervalMs: number = 100
+): boolean {
+  return ExternalScannerModule.openJournal(directory, fsyncPolicy, syncIntervalMs)
+}
+
+/**
+ * Flush and close the scan journal
+ */
+export function closeJournal(): void {
+  ExternalScannerModule.closeJournal()
+}
+
+/**
+ * Read unacknowledged journaled scans, oldest first
+ * Replayed scans are re-parsed and looked up in the catalog, but not routed
+ * or validated again.
+ * @param afterSequence Only return scans after this sequence (default: 0)
+ * @param limit Maximum number of scans to return (default: 100)
+ */
+export function readJournal(afterSequence: number = 0, limit: number = 100): ScanResult[] {
+  return ExternalScannerModule.readJournal(afterSequence, limit)
+}
+
+/**
+ * Acknowledge journaled scans up to and including `sequence`
+ * They are no longer returned by `readJournal()`, and log segments holding
+ * only acknowledged scans are deleted.
+ */
+export function acknowledgeScans(sequence: number): void {
+  ExternalScannerModule.acknowledgeScans(sequence)
+}
+
+/**
+ * Get scan pipeline counters and per-stage latency percentiles
+ * Counters cover keys received, ignored and dropped, and scans emitted or
+ * filtered (too short, timed out, invalid, duplicate, unrouted). Latencies
+ * are kept natively in lock-free histograms for the key ingest, assembly,
+ * dispatch and callback stages.
+ */
+export function getStats(): ScannerStats {
+  return ExternalScannerModule.getStats()
+}
+
+/**
+ * Reset all pipeline counters and latency histograms
+ * (including the suppressed duplicate count)
+ */
+export function resetStats(): void {
+  ExternalScannerModule.resetStats()
+}
+
+/**
+ * Record raw key events to a compact binary trace file
+ * Every key event reaching the scanner (timestamp, key code, action,
+ * characters, device) is captured, so field problems such as split or
+ * merged scans can be replayed deterministically offline (see
+ * cpp/KeyTraceReplayer.hpp). Starting again replaces the current recording.
+ * @returns false if the file cannot be created
+ */
+export function startKeyTrace(path: string): boolean {
+  return ExternalScannerModule.startKeyTrace(path)
+}
+
+/**
+ * Stop recording and close the key trace file
+ */
+export function stopKeyTrace(): void {
+  ExternalScannerModule.stopKeyTrace()
+}
+
+/**
+ * Counter that changes whenever the connected device list changes, so
+ * callers can skip re-querying `getConnectedDevices()`
+ */
+export function getDeviceGeneration(): number {
+  return ExternalScannerModule.getDeviceGeneration()
+}
+
+/**
+ * Limit scans to `length` characters and choose what happens to longer ones
+ */
+export function setMaxScanLength(length: number, overflow: ScanOverflowPolicy = 'discard'): void {
+  ExternalScannerModule.setMaxScanLength(length, overflow)
+}
+
+/**
+ * Override scanner detection with vendor/product id and name rules
+ * Rules are compiled natively and swapped in without stopping the scan.
+ * Devices no rule matches fall back to the built-in detection.
+ * @returns false if a rule is invalid (the previous rules stay active)
+ */
+export function setDeviceRules(rules: DeviceRule[]): boolean {
+  return ExternalScannerModule.setDeviceRules(rules)
+}
+
+/**
+ * Set the keyboard layout the scanners are programmed for
+ * Keycodes are translated natively with the layout's tables, tracking
+ * Shift/AltGr/Caps Lock, so symbols and accented characters come out right
+ * even if the device's own keyboard layout differs. By default ('platform')
+ * the characters the platform supplies are kept.
+ */
+export function setKeyboardLayout(layout: KeyboardLayout): void {
+  ExternalScannerModule.setKeyboardLayout(layout)
+}
+
+/**
+ * Read scanners directly from /dev/input (rooted Android and Linux only)
+ * Keys arrive without the Activity in between, with kernel timestamps, and
+ * also while the app is not focused. Scanners plugged in later are opened
+ * as well.
+ * @returns Number of devices opened, or -1 if evdev input is unavailable
+ */
+export function startEvdevInput(options: EvdevInputOptions = {}): number {
+  return ExternalScannerModule.startEvdevInput(options)
+}
+
+/**
+ * Close the devices opened by startEvdevInput()
+ */
+export function stopEvdevInput(): void {
+  ExternalScannerModule.stopEvdevInput()
+}
+
+/**
+ * Read a scanner in serial mode (USB CDC-ACM, RS-232) or behind a
+ * serial-to-TCP bridge (Android and Linux)
+ * The bytes are split into scans natively per `framing` and delivered to
+ * the scan callback like keyboard scans.
+ * @param path - tty path (e.g. '/dev/ttyACM0') or 'tcp://address:port'
+ * @param baudRate - Line speed for ttys (default: keep the current one)
+ * @returns Device id of the stream's scans, or -1 on failure
+ */
+export function openSerialInput(path: string, framing: SerialFraming = {}, baudRate: number = 0): number {
+  return ExternalScannerModule.openSerialInput(path, framing, baudRate)
+}
+
+/**
+ * Close a stream opened by openSerialInput()
+ */
+export function closeSerialInput(deviceId: number): void {
+  ExternalScannerModule.closeSerialInput(deviceId)
+}
+
+/**
+ * Strip a scanner's prefix/suffix and AIM symbology identifiers from
+ * completed scans, and split scans holding several codes
+ * Each code is delivered as its own scan; with `aimIdentifiers` it carries
+ * the decoded `symbology`. Pass `{}` to take scans as they are again.
+ * @returns false if the format is invalid (e.g. a separator inside the prefix)
+ */
+export function setScanFormat(format: ScanFormat): boolean {
+  return ExternalScannerModule.setScanFormat(format)
+}
+
 // Export the raw module for advanced use cases
 export { ExternalScannerModule }
 
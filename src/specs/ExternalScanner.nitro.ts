@@ -11,12 +11,216 @@ export interface DeviceInfo {
   isExternal: boolean
 }
 
+/**
+ * Inter-key timing learned for one input device
+ */
+export interface DeviceTiming {
+  deviceId: number
+  /** Timeout adaptive mode uses for this device (ms) */
+  timeoutMs: number
+  /** Number of inter-key intervals in the (decaying) histogram */
+  sampleCount: number
+  p50IntervalMs: number
+  p99IntervalMs: number
+}
+
+/**
+ * What to do with scans whose check digit does not match:
+ * - `off`: no validation
+ * - `annotate`: set `valid` and `symbologyGuess` on the result
+ * - `reject`: annotate, and drop scans that fail validation
+ */
+export type ValidationPolicy = 'off' | 'annotate' | 'reject'
+
+/**
+ * Whether duplicate scans are matched per input device or across all devices
+ */
+export type DedupScope = 'device' | 'global'
+
+/**
+ * What happens to a scan longer than the maximum scan length:
+ * - `truncate`: deliver the first `length` characters
+ * - `split`: deliver it in chunks of `length` characters
+ * - `discard`: drop the whole scan
+ */
+export type ScanOverflowPolicy = 'truncate' | 'split' | 'discard'
+
+/**
+ * When the scan journal flushes appended scans to storage:
+ * - `never`: leave it to the OS (survives the app dying, not power loss)
+ * - `interval`: once per sync interval after the first unsynced scan
+ * - `always`: after every scan
+ */
+export type FsyncPolicy = 'never' | 'interval' | 'always'
+
+/**
+ * Keyboard layout the scanner is configured for:
+ * - `platform`: keep the characters the platform supplies (default)
+ * - `us`: US English
+ * - `de`: German QWERTZ
+ * - `fr`: French AZERTY
+ */
+export type KeyboardLayout = 'platform' | 'us' | 'de' | 'fr'
+
+/**
+ * Whether a matching device rule marks the device as a scanner
+ */
+export type RuleAction = 'accept' | 'reject'
+
+/**
+ * Scanner detection rule. A rule matches a device when all of its set
+ * conditions match (a rule without conditions matches every device).
+ * The highest priority wins; on a tie `reject` beats `accept`.
+ */
+export interface DeviceRule {
+  /** USB vendor id */
+  vendorId?: number
+  /** Product id range (inclusive, requires vendorId); one bound alone matches that id */
+  productIdMin?: number
+  productIdMax?: number
+  /** Case-insensitive substring of the device name; '^' / '$' anchor it */
+  namePattern?: string
+  action: RuleAction
+  /** Default 0 */
+  priority?: number
+}
+
+/**
+ * Which /dev/input nodes startEvdevInput() reads. Without vendorId, devices
+ * are picked by the same detection as on the platform (see DeviceRule).
+ */
+export interface EvdevInputOptions {
+  /** USB vendor id to read from */
+  vendorId?: number
+  /** Product id (requires vendorId) */
+  productId?: number
+  /** Take the devices exclusively (EVIOCGRAB), default false */
+  grab?: boolean
+  /** Default '/dev/input' */
+  directory?: string
+}
+
+/**
+ * How openSerialInput() splits the byte stream into scans
+ */
+export interface SerialFraming {
+  /** Any of these characters ends a scan; default '\r\n' unless suffix or lengthHeaderBytes is set */
+  terminators?: string
+  /** A scan starts after it (e.g. '\x02'); bytes before it are dropped */
+  prefix?: string
+  /** Ends a scan (e.g. '\x03') and is not part of the code */
+  suffix?: string
+  /** 1, 2 or 4: every scan starts with a big-endian length of this many bytes */
+  lengthHeaderBytes?: number
+}
+
+/**
+ * What completed scans carry besides the code, stripped before delivery
+ */
+export interface ScanFormat {
+  /** Precedes each code (e.g. '\x02'); codes without it are taken as they are */
+  prefix?: string
+  /** Follows each code (e.g. '\x03') */
+  suffix?: string
+  /** Each code starts with an AIM symbology identifier (e.g. ']E0'), decoded into `symbology` */
+  aimIdentifiers?: boolean
+  /** Any of these characters separates several codes in one scan (e.g. '\t') */
+  separators?: string
+}
+
+/**
+ * One GS1 Application Identifier element of a scan
+ */
+export interface Gs1Element {
+  /** Application Identifier, e.g. "01" or "3103" */
+  ai: string
+  /** Raw data of the element */
+  value: string
+  /** Decoded value for count, measure and amount AIs (decimal point applied) */
+  numericValue?: number
+  /** ISO date (YYYY-MM-DD) for date AIs */
+  date?: string
+}
+
+/**
+ * Routing rule for completed scans. A scan matches when it starts with
+ * `prefix`, the rest matches `pattern` completely, and its length is within
+ * [minLength, maxLength]. Omitted parts match anything.
+ */
+export interface ScanRoute {
+  id: string
+  prefix?: string
+  /** Simple regex: literals, ., [classes], \d \w \s, groups, |, * + ? {n,m} */
+  pattern?: string
+  minLength?: number
+  maxLength?: number
+}
+
+/**
+ * Latency distribution of one scan pipeline stage (microseconds)
+ */
+export interface StageLatency {
+  count: number
+  meanUs: number
+  p50Us: number
+  p90Us: number
+  p99Us: number
+  p999Us: number
+  maxUs: number
+}
+
+/**
+ * Scan pipeline counters and per-stage latencies since the last reset
+ */
+export interface ScannerStats {
+  /** Key-downs received while scanning */
+  keysReceived: number
+  /** Key-downs received while not scanning */
+  keysIgnored: number
+  /** Keys lost because the key ring or device table was full */
+  keysDropped: number
+  scansEmitted: number
+  /** Scans shorter than the minimum scan length */
+  scansTooShort: number
+  /** Scans completed by the inter-key timeout rather than Enter */
+  scansTimedOut: number
+  scansInvalid: number
+  scansDuplicate: number
+  scansUnrouted: number
+  /** Scans longer than the maximum scan length */
+  scansOverflowed: number
+  /** Key event timestamp until the assembler picks the key up */
+  keyIngest: StageLatency
+  /** Scan completion until the result is ready to dispatch */
+  assembly: StageLatency
+  /** Result ready until its callback starts (includes batching delay) */
+  dispatch: StageLatency
+  /** Time spent in the onScan/onScans callback */
+  callback: StageLatency
+}
+
 /**
  * Result of a barcode scan
  */
 export interface ScanResult {
   code: string
   timestamp: number
+  /** Input device the scan came from */
+  deviceId: number
+  /** GS1 Application Identifier elements (when GS1 parsing is enabled) */
+  elements?: Gs1Element[]
+  /** Whether the check digit matched (when validation is enabled) */
+  valid?: boolean
+  /** Symbology inferred from the code's shape, e.g. "EAN-13" */
+  symbologyGuess?: string
+  /** Symbology named by the scan's AIM identifier (see ScanFormat), e.g. "GS1-128" */
+  symbology?: string
+  /** Catalog record for the code (when a catalog is loaded and has it) */
+  catalogRecord?: string
+  /** id of the first ScanRoute the code matched */
+  route?: string
+  /** Journal sequence number (when the journal is open) */
+  sequence?: number
 }
 
 /**
@@ -52,6 +256,16 @@ export interface ExternalScanner extends HybridObject<{
     onChar?: (char: string, keyCode: number) => void
   ): void
 
+  /**
+   * Start listening for barcode scans, delivering them in batches
+   * @param onScans - Callback with all scans completed since the last call
+   * @param maxLatencyMs - Longest time a completed scan waits to be delivered
+   */
+  startScanningBatched(
+    onScans: (results: ScanResult[]) => void,
+    maxLatencyMs: number
+  ): void
+
   /**
    * Stop listening for barcode scans
    */
@@ -71,4 +285,169 @@ export interface ExternalScanner extends HybridObject<{
    * Set minimum scan length
    */
   setMinScanLength(length: number): void
+
+  /**
+   * Enable/disable threaded processing. When enabled (default) key events are
+   * pushed into a lock-free ring and assembled on the native input loop
+   * thread, so slow callbacks never stall the platform input thread.
+   */
+  setThreadedProcessing(enabled: boolean): void
+
+  /**
+   * Enable/disable the in-memory binary trace of the scan pipeline
+   */
+  setTraceEnabled(enabled: boolean): void
+
+  /**
+   * Dump the trace buffer (oldest record first) as text
+   */
+  dumpTrace(): string
+
+  /**
+   * Learn each device's inter-key timeout from its keystroke timing
+   */
+  setAdaptiveTimeout(enabled: boolean): void
+
+  /**
+   * Get the timing statistics and timeout learned per device
+   */
+  getLearnedTimeouts(): DeviceTiming[]
+
+  /**
+   * Parse GS1 element strings natively and attach them as `elements`
+   */
+  setGs1Parsing(enabled: boolean): void
+
+  /**
+   * Validate check digits of numeric codes (EAN/UPC, GTIN-14, SSCC, ISBN, ISSN)
+   */
+  setValidationPolicy(policy: ValidationPolicy): void
+
+  /**
+   * Drop scans of a code read again within windowMs of its last read (0 = off)
+   */
+  setDuplicateFilter(windowMs: number, scope: DedupScope): void
+
+  /**
+   * Number of duplicate scans suppressed so far
+   */
+  getSuppressedDuplicateCount(): number
+
+  /**
+   * Memory-map a product catalog file; returns false if it is not valid
+   */
+  loadCatalog(path: string): boolean
+
+  /**
+   * Unmap the product catalog
+   */
+  unloadCatalog(): void
+
+  /**
+   * Look up a code in the product catalog
+   */
+  lookupCatalog(code: string): string | undefined
+
+  /**
+   * Compile routing rules (first match wins); an empty list removes them.
+   * Returns false if a pattern is invalid.
+   */
+  setScanRoutes(routes: ScanRoute[], dropUnmatched: boolean): boolean
+
+  /**
+   * Open (or recover) the scan journal in directory; returns false on failure
+   */
+  openJournal(directory: string, fsyncPolicy: FsyncPolicy, syncIntervalMs: number): boolean
+
+  /**
+   * Flush and close the scan journal
+   */
+  closeJournal(): void
+
+  /**
+   * Unacknowledged journaled scans after afterSequence, oldest first
+   */
+  readJournal(afterSequence: number, limit: number): ScanResult[]
+
+  /**
+   * Mark journaled scans up to and including sequence as processed
+   */
+  acknowledgeScans(sequence: number): void
+
+  /**
+   * Get the scan pipeline counters and stage latencies
+   */
+  getStats(): ScannerStats
+
+  /**
+   * Reset all counters and latency histograms
+   */
+  resetStats(): void
+
+  /**
+   * Record every raw key event to a binary trace file; returns false on failure
+   */
+  startKeyTrace(path: string): boolean
+
+  /**
+   * Stop recording and close the key trace file
+   */
+  stopKeyTrace(): void
+
+  /**
+   * Limit scans to `length` characters (at most 4096, the default).
+   * Overlong scans are handled per `overflow` (default: 'discard').
+   */
+  setMaxScanLength(length: number, overflow: ScanOverflowPolicy): void
+
+  /**
+   * Counter that changes whenever the connected device list changes
+   * (0 until the platform reported its first list)
+   */
+  getDeviceGeneration(): number
+
+  /**
+   * Replace the scanner detection rules (empty = built-in detection only).
+   * Takes effect immediately, also while scanning; returns false if a rule
+   * is invalid (the previous rules stay active).
+   */
+  setDeviceRules(rules: DeviceRule[]): boolean
+
+  /**
+   * Keyboard layout used to translate keycodes into characters (default:
+   * 'platform', which keeps the platform's characters and only translates
+   * keys that arrive without any, with the US tables).
+   * Must match the layout the scanner is programmed for.
+   */
+  setKeyboardLayout(layout: KeyboardLayout): void
+
+  /**
+   * Read scanners directly from Linux evdev nodes (needs read access to
+   * /dev/input, e.g. on rooted kiosk devices). Returns the number of devices
+   * opened, or -1 if evdev input is unavailable.
+   */
+  startEvdevInput(options: EvdevInputOptions): number
+
+  /**
+   * Close the evdev devices opened by startEvdevInput()
+   */
+  stopEvdevInput(): void
+
+  /**
+   * Read a scanner in serial mode: a tty (raw mode at baudRate, 0 = keep)
+   * or a serial-to-TCP bridge at 'tcp://address:port'. Returns the device
+   * id its scans carry, or -1 on failure.
+   */
+  openSerialInput(path: string, framing: SerialFraming, baudRate: number): number
+
+  /**
+   * Close a stream opened by openSerialInput()
+   */
+  closeSerialInput(deviceId: number): void
+
+  /**
+   * Set how to strip and split completed scans; an empty format takes each
+   * scan as it is. Returns false if the format is invalid.
+   */
+  setScanFormat(format: ScanFormat): boolean
 }